@@ -237,4 +237,133 @@ BOOST_AUTO_TEST_CASE(Kernel_KMeans_multiple_gauss)
 	}
 }
 
+// the accelerated iterations must give the same clustering as plain Lloyd iterations.
+// Few clusters use Hamerly's bounds, many clusters Elkan's bounds.
+BOOST_AUTO_TEST_CASE(KMeans_Bounds_Match_Lloyd)
+{
+	const std::size_t numPoints = 2000;
+	const std::size_t numDimensions = 4;
+	std::vector<RealVector> data(numPoints, RealVector(numDimensions));
+	for (std::size_t i=0; i<numPoints; i++){
+		for (std::size_t j=0; j <numDimensions; j++){
+			data[i](j) = random::gauss(random::globalRng(),0,1);
+		}
+	}
+	Data<RealVector> dataset = createDataFromRange(data,100);
+
+	std::size_t numClusters[] = {1, 5, 30};
+	for(std::size_t k: numClusters){
+		Centroids centroids;
+		centroids.initFromData(dataset, k);
+		std::vector<RealVector> centers(elements(centroids.centroids()).begin(),elements(centroids.centroids()).end());
+		std::size_t iterations = kMeans(dataset, k, centroids, 25);
+
+		//plain Lloyd iterations
+		std::vector<std::size_t> assignment(numPoints);
+		for(std::size_t iter = 0; iter != iterations + 1; ++iter){
+			for(std::size_t i = 0; i != numPoints; ++i){
+				std::size_t best = 0;
+				for(std::size_t j = 1; j != k; ++j){
+					if(distanceSqr(data[i],centers[j]) < distanceSqr(data[i],centers[best]))
+						best = j;
+				}
+				assignment[i] = best;
+			}
+			if(iter == iterations) break;
+			std::vector<RealVector> sums(k,RealVector(numDimensions,0.0));
+			std::vector<std::size_t> sizes(k,0);
+			for(std::size_t i = 0; i != numPoints; ++i){
+				sums[assignment[i]] += data[i];
+				++sizes[assignment[i]];
+			}
+			for(std::size_t j = 0; j != k; ++j){
+				BOOST_REQUIRE(sizes[j] > 0);
+				centers[j] = sums[j] / double(sizes[j]);
+			}
+		}
+
+		auto result = elements(centroids.centroids());
+		BOOST_REQUIRE_EQUAL(result.size(), k);
+		for(std::size_t j = 0; j != k; ++j){
+			BOOST_CHECK_SMALL(distanceSqr(result[j],centers[j]), 1.e-20);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(KMeans_PlusPlus_Seeding)
+{
+	// three tight clusters far apart, every seeding should pick one point of each
+	std::vector<RealVector> data(300,RealVector(2));
+	for (std::size_t i=0; i<300; i++){
+		data[i](0) = 1000.0 * (i % 3) + random::uni(random::globalRng(),0,1);
+		data[i](1) = random::uni(random::globalRng(),0,1);
+	}
+	Data<RealVector> dataset = createDataFromRange(data,32);
+	for(std::size_t trial = 0; trial != 100; ++trial){
+		Centroids centroids;
+		centroids.initFromData(dataset, 3);
+		auto centers = elements(centroids.centroids());
+		BOOST_REQUIRE_EQUAL(centers.size(), 3u);
+		std::vector<int> seen(3,0);
+		for(std::size_t j = 0; j != 3; ++j){
+			//the centroids are data points
+			bool found = false;
+			for(std::size_t i = 0; i != data.size(); ++i)
+				found |= distanceSqr(data[i],centers[j]) == 0.0;
+			BOOST_CHECK(found);
+			seen[std::size_t(centers[j](0) / 1000.0 + 0.5)] = 1;
+		}
+		BOOST_CHECK_EQUAL(seen[0] + seen[1] + seen[2], 3);
+	}
+
+	// with duplicate points all requested centroids are still created
+	Data<RealVector> constant = createDataFromRange(std::vector<RealVector>(10,RealVector(2,1.0)));
+	Centroids centroids;
+	centroids.initFromData(constant, 4);
+	BOOST_CHECK_EQUAL(centroids.numberOfClusters(), 4u);
+}
+
+BOOST_AUTO_TEST_CASE(KMeans_MiniBatch_Generator)
+{
+	// three clusters, the points are only available through a generator
+	std::vector<RealVector> means(3,RealVector(2));
+	means[0](0) = 0.0; means[0](1) = 0.0;
+	means[1](0) = 10.0; means[1](1) = 0.0;
+	means[2](0) = 0.0; means[2](1) = 10.0;
+	auto sampleBatch = [&]{
+		RealMatrix batch(50,2);
+		for(std::size_t i = 0; i != 50; ++i){
+			std::size_t c = random::discrete(random::globalRng(), std::size_t(0), std::size_t(2));
+			for(std::size_t j = 0; j != 2; ++j)
+				batch(i,j) = means[c](j) + random::gauss(random::globalRng(),0,1);
+		}
+		return batch;
+	};
+	Generator<RealVector> gen(sampleBatch, 2);
+
+	// start from centroids close to the true means, but permuted
+	std::vector<RealVector> start(3,RealVector(2));
+	start[0](0) = 1.0; start[0](1) = 9.0;
+	start[1](0) = 1.0; start[1](1) = 1.0;
+	start[2](0) = 9.0; start[2](1) = 1.0;
+	Centroids centroids(createDataFromRange(start));
+	std::size_t numPoints = kMeans(gen, 3, centroids, 400);
+	BOOST_CHECK_EQUAL(numPoints, 400 * 50u);
+	auto centers = elements(centroids.centroids());
+	BOOST_REQUIRE_EQUAL(centers.size(), 3u);
+	BOOST_CHECK_SMALL(distanceSqr(centers[0], means[2]), 0.01);
+	BOOST_CHECK_SMALL(distanceSqr(centers[1], means[0]), 0.01);
+	BOOST_CHECK_SMALL(distanceSqr(centers[2], means[1]), 0.01);
+
+	// seeded from the generator and filling an RBF layer
+	RBFLayer layer(2, 3);
+	kMeans(gen, layer, 400);
+	for(std::size_t c = 0; c != 3; ++c){
+		double closest = std::numeric_limits<double>::max();
+		for(std::size_t j = 0; j != 3; ++j)
+			closest = std::min(closest, distanceSqr(row(layer.centers(), j), means[c]));
+		BOOST_CHECK_SMALL(closest, 0.01);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
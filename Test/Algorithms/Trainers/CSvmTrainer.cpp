@@ -274,6 +274,36 @@ BOOST_AUTO_TEST_CASE( CSVM_TRAINER_WARM_START_NO_OFFSET )
 	BOOST_CHECK_LE(trainer.solutionProperties().iterations, iter);
 }
 
+BOOST_AUTO_TEST_CASE( CSVM_TRAINER_PATH )
+{
+	Chessboard problem;
+	ClassificationDataset dataset = problem.generateDataset(200);
+	GaussianRbfKernel<> kernel(0.5);
+	std::vector<double> Cs = {0.1, 0.3, 1.0, 3.0, 10.0, 10.0};
+	
+	for(bool offset: {true, false}){
+		CSvmTrainer<RealVector, double> trainer(&kernel, 1.0, offset);
+		trainer.stoppingCondition().minAccuracy = 1e-8;
+		std::vector<KernelClassifier<RealVector> > path;
+		trainer.trainPath(path, dataset, Cs);
+		BOOST_REQUIRE_EQUAL(path.size(), Cs.size());
+		BOOST_CHECK_EQUAL(trainer.C(), Cs.back());
+		
+		for(std::size_t i = 0; i != Cs.size(); ++i){
+			KernelClassifier<RealVector> svm;
+			CSvmTrainer<RealVector, double> single(&kernel, Cs[i], offset);
+			single.stoppingCondition().minAccuracy = 1e-8;
+			single.train(svm, dataset);
+			
+			auto pathOutput = elements(path[i].decisionFunction()(dataset.inputs()));
+			auto singleOutput = elements(svm.decisionFunction()(dataset.inputs()));
+			for(std::size_t j = 0; j != dataset.numberOfElements(); ++j){
+				BOOST_CHECK_SMALL(pathOutput[j](0) - singleOutput[j](0), 1.e-5);
+			}
+		}
+	}
+}
+
 template<class Model1, class Model2, class Dataset>
 void checkSVMSolutionsEqual(
 	Model1 const& model1, Model2 const& model2, 
@@ -60,4 +60,28 @@ BOOST_AUTO_TEST_CASE( LinearRegression_TEST ){
 	BOOST_CHECK_SMALL(error, 2e-4);
 }
 
+//training on the contiguous arenas gives the same model as training on the batches of the dataset
+BOOST_AUTO_TEST_CASE( LinearRegression_Contiguous ){
+	RegressionDataset data(1000, {{3}, {2}}, 64);
+	for(auto element: elements(data)){
+		for(std::size_t j = 0; j != 3; ++j)
+			element.input(j) = random::gauss(random::globalRng(), 0.0, 1.0);
+		element.label(0) = 2 * element.input(0) - element.input(2) + 1 + 0.1 * random::gauss(random::globalRng(), 0.0, 1.0);
+		element.label(1) = element.input(1) + 0.1 * random::gauss(random::globalRng(), 0.0, 1.0);
+	}
+	ContiguousLabeledData<RealVector, RealVector> contiguous(data);
+	LinearRegression trainer(0.1);
+	LinearModel<> model;
+	LinearModel<> contiguousModel;
+	trainer.train(model, data);
+	trainer.train(contiguousModel, contiguous);
+	BOOST_CHECK_SMALL(max(abs(model.parameterVector() - contiguousModel.parameterVector())), 1.e-10);
+
+	//subsets are views of the arenas
+	std::vector<std::size_t> indices = {7, 2, 11, 5};
+	trainer.train(model, data.indexedSubset(indices));
+	trainer.train(contiguousModel, contiguous.indexedSubset(indices));
+	BOOST_CHECK_SMALL(max(abs(model.parameterVector() - contiguousModel.parameterVector())), 1.e-10);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
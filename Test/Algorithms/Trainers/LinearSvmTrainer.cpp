@@ -244,4 +244,80 @@ BOOST_AUTO_TEST_CASE( MCSVM_TRAINER_TEST )
 	}
 }
 
+// The solvers use a compressed row storage for sparse inputs.
+// Training on the same data stored sparse and dense must give
+// the same machines.
+BOOST_AUTO_TEST_CASE( SPARSE_DENSE_EQUIVALENCE_TEST )
+{
+	size_t classes = 4;
+	size_t dim = 30;
+	size_t ell = 300;
+	double C = 1.0;
+
+	random::globalRng().seed(17);
+	vector<CompressedRealVector> sparseInput(ell, CompressedRealVector(dim));
+	vector<RealVector> denseInput(ell, RealVector(dim, 0.0));
+	vector<unsigned int> target(ell);
+	for (size_t i=0; i<ell; i++)
+	{
+		unsigned int label = (unsigned int)random::discrete(random::globalRng(), std::size_t(0), classes - 1);
+		for (unsigned int d=0; d<dim; d++)
+		{
+			if (d % classes != label && !random::coinToss(random::globalRng(), 0.2)) continue;
+			double value = 0.5 * random::gauss(random::globalRng()) + ((d % classes == label) ? 1.0 : 0.0);
+			sparseInput[i].set_element(sparseInput[i].end(), d, value);
+			denseInput[i](d) = value;
+		}
+		target[i] = label;
+	}
+	LabeledData<CompressedRealVector, unsigned int> sparseData = createLabeledDataFromRange(sparseInput, target, 64);
+	LabeledData<RealVector, unsigned int> denseData = createLabeledDataFromRange(denseInput, target, 64);
+
+	McSvm machines[3] = {McSvm::WW, McSvm::CS, McSvm::OVA};
+	for (size_t m=0; m<3; m++)
+	{
+		LinearCSvmTrainer<CompressedRealVector> sparseTrainer(C, false);
+		LinearCSvmTrainer<RealVector> denseTrainer(C, false);
+		sparseTrainer.setMcSvmType(machines[m]);
+		denseTrainer.setMcSvmType(machines[m]);
+		sparseTrainer.stoppingCondition().minAccuracy = MAX_KKT_VIOLATION;
+		denseTrainer.stoppingCondition().minAccuracy = MAX_KKT_VIOLATION;
+
+		LinearClassifier<CompressedRealVector> sparseModel;
+		LinearClassifier<RealVector> denseModel;
+		random::globalRng().seed(m);
+		sparseTrainer.train(sparseModel, sparseData);
+		random::globalRng().seed(m);
+		denseTrainer.train(denseModel, denseData);
+
+		RealMatrix const& w_sparse = sparseModel.decisionFunction().matrix();
+		RealMatrix const& w_dense = denseModel.decisionFunction().matrix();
+		BOOST_REQUIRE_EQUAL(w_sparse.size1(), w_dense.size1());
+		BOOST_REQUIRE_EQUAL(w_sparse.size2(), w_dense.size2());
+		BOOST_CHECK_SMALL(norm_frobenius(w_sparse - w_dense), 1.e-4 * norm_frobenius(w_dense));
+		BOOST_CHECK_EQUAL(sparseTrainer.solutionProperties().iterations, denseTrainer.solutionProperties().iterations);
+	}
+
+	// binary problem
+	vector<unsigned int> binaryTarget(ell);
+	for (size_t i=0; i<ell; i++) binaryTarget[i] = target[i] % 2;
+	LabeledData<CompressedRealVector, unsigned int> sparseBinary = createLabeledDataFromRange(sparseInput, binaryTarget, 64);
+	LabeledData<RealVector, unsigned int> denseBinary = createLabeledDataFromRange(denseInput, binaryTarget, 64);
+	LinearCSvmTrainer<CompressedRealVector> sparseTrainer(C, true);
+	LinearCSvmTrainer<RealVector> denseTrainer(C, true);
+	sparseTrainer.stoppingCondition().minAccuracy = MAX_KKT_VIOLATION;
+	denseTrainer.stoppingCondition().minAccuracy = MAX_KKT_VIOLATION;
+	LinearClassifier<CompressedRealVector> sparseModel;
+	LinearClassifier<RealVector> denseModel;
+	random::globalRng().seed(3);
+	sparseTrainer.train(sparseModel, sparseBinary);
+	random::globalRng().seed(3);
+	denseTrainer.train(denseModel, denseBinary);
+
+	RealVector w_sparse = row(sparseModel.decisionFunction().matrix(), 0);
+	RealVector w_dense = row(denseModel.decisionFunction().matrix(), 0);
+	BOOST_CHECK_SMALL(norm_2(w_sparse - w_dense), 1.e-4 * norm_2(w_dense));
+	BOOST_CHECK_SMALL(sparseModel.decisionFunction().offset()(0) - denseModel.decisionFunction().offset()(0), 1.e-4);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,112 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       test case for the parallel one-versus-one SVM trainer
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#define BOOST_TEST_MODULE ALGORITHMS_TRAINERS_ONEVERSUSONESVMTRAINER
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Algorithms/Trainers/OneVersusOneSvmTrainer.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
+#include <shark/Data/DataDistribution.h>
+
+using namespace shark;
+
+// five overlapping classes on a line
+class Problem : public LabeledDataDistribution<RealVector, unsigned int>
+{
+public:
+	Problem():LabeledDataDistribution<RealVector, unsigned int>({1,5}){}
+	void draw(reference point)const{
+		point.label = random::discrete(random::globalRng(), 0, 4);
+		point.input(0) = random::gauss(random::globalRng()) + 3.0 * point.label;
+	}
+};
+
+BOOST_AUTO_TEST_SUITE (Algorithms_Trainers_OneVersusOneSvmTrainer)
+
+BOOST_AUTO_TEST_CASE( OneVersusOneSvmTrainer_Pairwise )
+{
+	random::globalRng().seed(42);
+	unsigned int classes = 5;
+	Problem problem;
+	ClassificationDataset dataset = problem.generateDataset(200, 16);
+	ClassificationDataset test = problem.generateDataset(100);
+	GaussianRbfKernel<> kernel(0.5);
+	double C = 10.0;
+
+	// reference: sequential training of all binary machines
+	ClassificationDataset sorted = dataset;
+	repartitionByClass(sorted);
+	std::vector<KernelClassifier<RealVector> > reference(classes * (classes - 1) / 2);
+	unsigned long long referenceAccesses = 0;
+	for (unsigned int c = 1, p = 0; c != classes; c++){
+		for (unsigned int e = 0; e != c; e++, p++){
+			CSvmTrainer<RealVector> trainer(&kernel, C, true);
+			trainer.stoppingCondition().minAccuracy = 1e-8;
+			trainer.train(reference[p], binarySubProblem(sorted, e, c));
+			referenceAccesses += trainer.accessCount();
+		}
+	}
+
+	for (std::size_t cache = 0; cache != 2; ++cache){
+		OneVersusOneSvmTrainer<RealVector> trainer(&kernel, C, true);
+		trainer.stoppingCondition().minAccuracy = 1e-8;
+		// in the second run the Gram matrix does not fit into the cache, but every binary problem does
+		if (cache == 1) trainer.setCacheSize(30000);
+		OneVersusOneClassifier<RealVector> ovo;
+		trainer.train(ovo, dataset);
+		BOOST_REQUIRE_EQUAL(ovo.numberOfClasses(), classes);
+		if (cache == 0){
+			// kernel values shared between the binary problems are computed only once
+			BOOST_CHECK_LT(trainer.accessCount(), referenceAccesses);
+		}
+		else{
+			BOOST_CHECK_EQUAL(trainer.accessCount(), referenceAccesses);
+		}
+
+		// every binary machine must agree with the sequentially trained one
+		for (unsigned int c = 1, p = 0; c != classes; c++){
+			for (unsigned int e = 0; e != c; e++, p++){
+				KernelClassifier<RealVector> const& svm = dynamic_cast<KernelClassifier<RealVector> const&>(ovo.binary(c, e));
+				RealMatrix out = svm.decisionFunction()(test.inputs()[0]);
+				RealMatrix ref = reference[p].decisionFunction()(test.inputs()[0]);
+				BOOST_REQUIRE_EQUAL(out.size1(), ref.size1());
+				for (std::size_t i = 0; i != out.size1(); ++i)
+					BOOST_CHECK_SMALL(out(i, 0) - ref(i, 0), 1e-5);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -36,13 +36,18 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <algorithm>
+#include <sstream>
 
 #include <shark/LinAlg/Base.h>
 #include <shark/Models/Kernels/LinearKernel.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
 #include <shark/Models/Trees/KDTree.h>
 #include <shark/Models/Trees/LCTree.h>
 #include <shark/Models/Trees/KHCTree.h>
+#include <shark/Models/Trees/PackedTree.h>
 #include <shark/Algorithms/NearestNeighbors/TreeNearestNeighbors.h>
+#include <shark/Algorithms/NearestNeighbors/DualTreeNearestNeighbors.h>
+#include <shark/Algorithms/NearestNeighbors/SimpleNearestNeighbors.h>
 #include <shark/Core/Random.h>
 #include <shark/Core/Timer.h>
 
@@ -201,4 +206,176 @@ BOOST_AUTO_TEST_CASE(IterativeNearestNeighborQueries)
 	}
 }
 
+//batch queries of the tree based algorithms must return the same distances as the brute force search
+BOOST_AUTO_TEST_CASE(BatchNearestNeighborQueries)
+{
+	random::globalRng().seed(42);
+	std::size_t ell = 5000;
+	std::size_t numQueries = 1000;
+	std::size_t k = 7;
+	std::vector<RealVector> inputs(ell, RealVector(3));
+	std::vector<unsigned int> labels(ell);
+	for(std::size_t i = 0; i != ell; ++i){
+		for(std::size_t d = 0; d != 3; ++d)
+			inputs[i](d) = random::gauss(random::globalRng());
+		labels[i] = (unsigned int)i;
+	}
+	//duplicate points
+	for(std::size_t i = 0; i != 10; ++i)
+		inputs[i] = inputs[10];
+	RealMatrix queries(numQueries, 3);
+	for(std::size_t i = 0; i != numQueries; ++i){
+		for(std::size_t d = 0; d != 3; ++d)
+			queries(i, d) = random::gauss(random::globalRng());
+	}
+	//some queries are reference points
+	for(std::size_t i = 0; i != 20; ++i)
+		noalias(row(queries, i)) = inputs[i];
+	LabeledData<RealVector, unsigned int> dataset = createLabeledDataFromRange(inputs, labels, 100);
+
+	LinearKernel<RealVector> kernel;
+	SimpleNearestNeighbors<RealVector, unsigned int> bruteForce(dataset, &kernel);
+	std::vector<KeyValuePair<double, unsigned int> > reference = bruteForce.getNeighbors(queries, k);
+
+	KDTree<RealVector> kdtree(dataset.inputs());
+	TreeNearestNeighbors<RealVector, unsigned int> iterative(dataset, &kdtree);
+	KDTree<RealVector> kdtreeBuckets(dataset.inputs(), TreeConstruction(0, 8));
+	LCTree<RealVector> lctree(dataset.inputs(), TreeConstruction(0, 16));
+	DualTreeNearestNeighbors<unsigned int> dualKD(dataset, &kdtreeBuckets, 4);
+	DualTreeNearestNeighbors<unsigned int> dualLC(dataset, &lctree);
+
+	std::vector<std::vector<KeyValuePair<double, unsigned int> > > results;
+	results.push_back(iterative.getNeighbors(queries, k));
+	results.push_back(dualKD.getNeighbors(queries, k));
+	results.push_back(dualLC.getNeighbors(queries, k));
+	for(auto const& result: results){
+		BOOST_REQUIRE_EQUAL(result.size(), reference.size());
+		for(std::size_t i = 0; i != numQueries * k; ++i){
+			BOOST_CHECK_SMALL(result[i].key - std::sqrt(reference[i].key), 1.e-10);
+			//the distance stored must belong to the label returned
+			double dist = distance(inputs[result[i].value], row(queries, i / k));
+			BOOST_CHECK_SMALL(result[i].key - dist, 1.e-10);
+		}
+	}
+}
+
+//the packed tree must store the points of every node contiguously and within the bounding box of the node
+void testPackedTree(PackedTree const& packed, BinaryTree<RealVector> const& tree, std::vector<RealVector> const& data){
+	BOOST_REQUIRE_EQUAL(packed.size(), data.size());
+	BOOST_CHECK_EQUAL(packed.numberOfNodes(), tree.nodes());
+	//the rows are a permutation of the points
+	std::vector<std::size_t> indices(data.size());
+	for(std::size_t i = 0; i != data.size(); ++i){
+		indices[i] = packed.pointIndex(i);
+		BOOST_CHECK_SMALL(distanceSqr(row(packed.points(), i), data[indices[i]]), 1.e-20);
+	}
+	std::sort(indices.begin(), indices.end());
+	for(std::size_t i = 0; i != data.size(); ++i){
+		BOOST_CHECK_EQUAL(indices[i], i);
+	}
+	//traverse both trees together
+	std::vector<std::pair<std::size_t, BinaryTree<RealVector> const*> > stack(1, std::make_pair(std::size_t(0), &tree));
+	while(!stack.empty()){
+		std::size_t node = stack.back().first;
+		BinaryTree<RealVector> const* treeNode = stack.back().second;
+		stack.pop_back();
+		BOOST_REQUIRE_EQUAL(packed.size(node), treeNode->size());
+		for(std::size_t i = packed.node(node).begin; i != packed.node(node).end; ++i){
+			for(std::size_t d = 0; d != packed.dimension(); ++d){
+				BOOST_CHECK_LE(packed.lowerCorners()(node, d), packed.points()(i, d));
+				BOOST_CHECK_GE(packed.upperCorners()(node, d), packed.points()(i, d));
+			}
+			BOOST_CHECK_EQUAL(packed.squaredDistanceLowerBound(node, RealVector(row(packed.points(), i))), 0.0);
+		}
+		BOOST_REQUIRE_EQUAL(packed.isLeaf(node), treeNode->isLeaf());
+		if(!packed.isLeaf(node)){
+			BOOST_CHECK_EQUAL(packed.node(packed.left(node)).begin, packed.node(node).begin);
+			BOOST_CHECK_EQUAL(packed.node(packed.left(node)).end, packed.node(packed.right(node)).begin);
+			BOOST_CHECK_EQUAL(packed.node(packed.right(node)).end, packed.node(node).end);
+			stack.push_back(std::make_pair(packed.left(node), treeNode->left()));
+			stack.push_back(std::make_pair(packed.right(node), treeNode->right()));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(PackedTreeLayout)
+{
+	random::globalRng().seed(42);
+	std::vector<RealVector> data(2000, RealVector(3));
+	for(std::size_t i = 0; i != data.size(); ++i){
+		for(std::size_t d = 0; d != 3; ++d)
+			data[i](d) = random::gauss(random::globalRng());
+	}
+	Data<RealVector> dataset = createDataFromRange(data, 128);
+	DataView<Data<RealVector> > view(dataset);
+	KDTree<RealVector> kdtree(dataset);
+	KDTree<RealVector> kdtreeBuckets(dataset, TreeConstruction(0, 10));
+	LCTree<RealVector> lctree(dataset);
+	LinearKernel<RealVector> kernel;
+	KHCTree<DataView<Data<RealVector> > > khctree(view, &kernel);
+	testPackedTree(PackedTree(&kdtree, dataset), kdtree, data);
+	testPackedTree(PackedTree(&kdtreeBuckets, dataset), kdtreeBuckets, data);
+	testPackedTree(PackedTree(&lctree, dataset), lctree, data);
+	testPackedTree(PackedTree(&khctree, dataset), khctree, data);
+
+	//serialization
+	PackedTree packed(&kdtreeBuckets, dataset);
+	std::ostringstream outputStream;
+	{
+		TextOutArchive oa(outputStream);
+		oa << packed;
+	}
+	PackedTree deserialized;
+	std::istringstream inputStream(outputStream.str());
+	TextInArchive ia(inputStream);
+	ia >> deserialized;
+	testPackedTree(deserialized, kdtreeBuckets, data);
+	BOOST_CHECK_EQUAL(max(abs(deserialized.lowerCorners() - packed.lowerCorners())), 0.0);
+	BOOST_CHECK_EQUAL(max(abs(deserialized.upperCorners() - packed.upperCorners())), 0.0);
+}
+
+//the brute force search must find the same distances as sorting all distances
+BOOST_AUTO_TEST_CASE(BruteForceNearestNeighborQueries)
+{
+	random::globalRng().seed(42);
+	std::size_t ell = 1000;
+	std::size_t dim = 20;
+	std::size_t numQueries = 150;
+	std::vector<RealVector> inputs(ell, RealVector(dim));
+	std::vector<unsigned int> labels(ell);
+	for(std::size_t i = 0; i != ell; ++i){
+		for(std::size_t d = 0; d != dim; ++d)
+			inputs[i](d) = random::uni(random::globalRng(), -1, 1);
+		labels[i] = (unsigned int)i;
+	}
+	RealMatrix queries(numQueries, dim);
+	for(std::size_t i = 0; i != numQueries; ++i){
+		for(std::size_t d = 0; d != dim; ++d)
+			queries(i, d) = random::uni(random::globalRng(), -1, 1);
+	}
+	LabeledData<RealVector, unsigned int> dataset = createLabeledDataFromRange(inputs, labels, 77);
+	
+	LinearKernel<RealVector> linear;
+	GaussianRbfKernel<RealVector> gaussian(0.3);
+	std::vector<AbstractKernelFunction<RealVector> const*> metrics{&linear, &gaussian};
+	for(auto metric: metrics){
+		SimpleNearestNeighbors<RealVector, unsigned int> algorithm(dataset, metric);
+		for(std::size_t k: {1, 5, 40}){
+			std::vector<KeyValuePair<double, unsigned int> > result = algorithm.getNeighbors(queries, k);
+			BOOST_REQUIRE_EQUAL(result.size(), numQueries * k);
+			for(std::size_t q = 0; q != numQueries; ++q){
+				std::vector<double> distances(ell);
+				for(std::size_t i = 0; i != ell; ++i)
+					distances[i] = metric->featureDistanceSqr(inputs[i], row(queries, q));
+				std::sort(distances.begin(), distances.end());
+				for(std::size_t i = 0; i != k; ++i){
+					BOOST_CHECK_SMALL(result[q * k + i].key - distances[i], 1.e-10);
+					double dist = metric->featureDistanceSqr(inputs[result[q * k + i].value], row(queries, q));
+					BOOST_CHECK_SMALL(result[q * k + i].key - dist, 1.e-10);
+				}
+			}
+		}
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,224 @@
+#define BOOST_TEST_MODULE Data_BinaryData
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Data/BinaryData.h>
+#include <shark/Core/Random.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace shark;
+
+namespace{
+//random dataset with a few nonzeros per point and batches of different sizes
+LabeledData<RealVector, unsigned int> createDataset(std::size_t numPoints, std::size_t dim){
+	LabeledData<RealVector, unsigned int> data(numPoints, {dim, 5}, 7);
+	for(auto element: elements(data)){
+		element.input.clear();
+		for(std::size_t k = 0; k != 3; ++k){
+			element.input(random::discrete(random::globalRng(), std::size_t(0), dim - 1)) = random::gauss(random::globalRng(), 0, 1);
+		}
+		element.label = random::discrete(random::globalRng(), 0u, 4u);
+	}
+	return data;
+}
+
+template<class Batch1, class Batch2>
+void checkBatchEqual(Batch1 const& batch1, Batch2 const& batch2){
+	BOOST_REQUIRE_EQUAL(batch1.size1(), batch2.size1());
+	BOOST_REQUIRE_EQUAL(batch1.size2(), batch2.size2());
+	for(std::size_t i = 0; i != batch1.size1(); ++i){
+		for(std::size_t j = 0; j != batch1.size2(); ++j){
+			BOOST_CHECK_EQUAL(batch1(i, j), batch2(i, j));
+		}
+	}
+}
+}
+
+BOOST_AUTO_TEST_SUITE (Data_BinaryData)
+
+BOOST_AUTO_TEST_CASE( BinaryData_Dense_Roundtrip )
+{
+	LabeledData<RealVector, unsigned int> data = createDataset(100, 10);
+	exportBinaryData(data, "./Test/test_output/dense_classification.bin");
+
+	//views of the mapped file
+	BinaryDataFile file("./Test/test_output/dense_classification.bin");
+	BOOST_CHECK_EQUAL(file.inputFormat(), BinaryDataFile::DenseInputs);
+	BOOST_CHECK_EQUAL(file.labelFormat(), BinaryDataFile::ClassLabels);
+	BOOST_CHECK_EQUAL(file.inputShape(), Shape({10}));
+	BOOST_CHECK_EQUAL(file.labelShape(), Shape({5}));
+	BOOST_CHECK_EQUAL(file.numberOfElements(), 100);
+	BOOST_REQUIRE_EQUAL(file.numberOfBatches(), data.size());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		checkBatchEqual(file.denseInputs(b), data.inputs()[b]);
+		BOOST_REQUIRE_EQUAL(file.classLabels(b).size(), data.labels()[b].size());
+		for(std::size_t i = 0; i != file.batchSize(b); ++i)
+			BOOST_CHECK_EQUAL(file.classLabels(b)(i), data.labels()[b](i));
+		//payloads are aligned
+		BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(&file.denseInputs(b)(0,0)) % 64, 0);
+	}
+	BOOST_CHECK_THROW(file.sparseInputs(0), shark::Exception);
+	BOOST_CHECK_THROW(file.denseLabels(0), shark::Exception);
+
+	//copy into a dataset
+	LabeledData<RealVector, unsigned int> loaded;
+	importBinaryData(loaded, "./Test/test_output/dense_classification.bin");
+	BOOST_CHECK_EQUAL(loaded.shape().input, data.shape().input);
+	BOOST_CHECK_EQUAL(loaded.shape().label, data.shape().label);
+	BOOST_REQUIRE_EQUAL(loaded.size(), data.size());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		checkBatchEqual(loaded.inputs()[b], data.inputs()[b]);
+		BOOST_REQUIRE_EQUAL(loaded.labels()[b].size(), data.labels()[b].size());
+		for(std::size_t i = 0; i != data.labels()[b].size(); ++i)
+			BOOST_CHECK_EQUAL(loaded.labels()[b](i), data.labels()[b](i));
+	}
+
+	//the stored format must match the dataset
+	LabeledData<RealVector, RealVector> regression;
+	BOOST_CHECK_THROW(importBinaryData(regression, "./Test/test_output/dense_classification.bin"), shark::Exception);
+	Data<RealVector> unlabeled;
+	BOOST_CHECK_THROW(importBinaryData(unlabeled, "./Test/test_output/dense_classification.bin"), shark::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( BinaryData_Sparse_Roundtrip )
+{
+	LabeledData<RealVector, unsigned int> dense = createDataset(100, 50);
+	LabeledData<CompressedRealVector, RealVector> data(100, {50, 2}, 7);
+	for(std::size_t b = 0; b != data.size(); ++b){
+		RealMatrix const& inputs = dense.inputs()[b];
+		CompressedRealMatrix& batch = data.inputs()[b];
+		for(std::size_t i = 0; i != inputs.size1(); ++i){
+			auto pos = batch.major_end(i);
+			for(std::size_t j = 0; j != inputs.size2(); ++j){
+				if(inputs(i, j) != 0.0)
+					pos = batch.set_element(pos, j, inputs(i, j));
+			}
+		}
+		data.labels()[b] = blas::normal(random::globalRng(), data.labels()[b].size1(), 2, 0.0, 1.0, blas::cpu_tag());
+	}
+	exportBinaryData(data, "./Test/test_output/sparse_regression.bin");
+
+	BinaryDataFile file("./Test/test_output/sparse_regression.bin");
+	BOOST_CHECK_EQUAL(file.inputFormat(), BinaryDataFile::SparseInputs);
+	BOOST_CHECK_EQUAL(file.labelFormat(), BinaryDataFile::DenseLabels);
+	BOOST_CHECK_EQUAL(file.labelShape(), Shape({2}));
+	for(std::size_t b = 0; b != data.size(); ++b){
+		//rebuild the dense batch from the compressed rows
+		BinaryDataFile::SparseBatch storage = file.sparseInputs(b);
+		RealMatrix inputs(file.batchSize(b), 50, 0.0);
+		for(std::size_t i = 0; i != inputs.size1(); ++i){
+			for(std::size_t k = storage.major_indices_begin[i]; k != storage.major_indices_end[i]; ++k)
+				inputs(i, storage.indices[k]) = storage.values[k];
+		}
+		checkBatchEqual(inputs, dense.inputs()[b]);
+		checkBatchEqual(file.denseLabels(b), data.labels()[b]);
+	}
+
+	LabeledData<CompressedRealVector, RealVector> loaded;
+	importBinaryData(loaded, "./Test/test_output/sparse_regression.bin");
+	BOOST_REQUIRE_EQUAL(loaded.size(), data.size());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		checkBatchEqual(RealMatrix(loaded.inputs()[b]), dense.inputs()[b]);
+		checkBatchEqual(loaded.labels()[b], data.labels()[b]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( BinaryData_Unlabeled_Shape )
+{
+	Data<RealVector> data(20, {2, 3, 4}, 6);
+	for(auto& batch: data){
+		batch = blas::normal(random::globalRng(), batch.size1(), batch.size2(), 0.0, 1.0, blas::cpu_tag());
+	}
+	exportBinaryData(data, "./Test/test_output/unlabeled.bin");
+	Data<RealVector> loaded;
+	importBinaryData(loaded, "./Test/test_output/unlabeled.bin");
+	BOOST_CHECK_EQUAL(loaded.shape(), Shape({2, 3, 4}));
+	BOOST_REQUIRE_EQUAL(loaded.size(), data.size());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		checkBatchEqual(loaded[b], data[b]);
+	}
+
+	//truncated files are rejected
+	{
+		std::ifstream in("./Test/test_output/unlabeled.bin", std::ios::binary);
+		std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		std::ofstream out("./Test/test_output/truncated.bin", std::ios::binary);
+		out.write(contents.data(), contents.size() - 8);
+	}
+	BOOST_CHECK_THROW(BinaryDataFile("./Test/test_output/truncated.bin"), shark::Exception);
+}
+
+
+//the format is given by the type of the dataset, also if it has no batches
+BOOST_AUTO_TEST_CASE( BinaryData_Empty_Sparse )
+{
+	Data<CompressedRealVector> data;
+	exportBinaryData(data, "./Test/test_output/empty_sparse.bin");
+	BinaryDataFile file("./Test/test_output/empty_sparse.bin");
+	BOOST_CHECK_EQUAL(file.inputFormat(), BinaryDataFile::SparseInputs);
+	BOOST_CHECK_EQUAL(file.numberOfBatches(), 0);
+
+	Data<CompressedRealVector> loaded;
+	importBinaryData(loaded, "./Test/test_output/empty_sparse.bin");
+	BOOST_CHECK_EQUAL(loaded.size(), 0);
+	BOOST_CHECK_EQUAL(loaded.numberOfElements(), 0);
+	Data<RealVector> dense;
+	BOOST_CHECK_THROW(importBinaryData(dense, "./Test/test_output/empty_sparse.bin"), shark::Exception);
+}
+
+//corrupted compressed rows are rejected when the file is opened
+BOOST_AUTO_TEST_CASE( BinaryData_Corrupted_Sparse )
+{
+	Data<CompressedRealVector> data(3, {10}, 3);
+	for(std::size_t i = 0; i != 3; ++i){
+		data[0].set_element(data[0].major_end(i), 5 + i, 1.0 + i);
+	}
+	exportBinaryData(data, "./Test/test_output/sparse.bin");
+	std::string contents;
+	{
+		std::ifstream in("./Test/test_output/sparse.bin", std::ios::binary);
+		contents.assign((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	}
+	//row offsets followed by the column indices
+	std::uint64_t const storage[7] = {0, 1, 2, 3, 5, 6, 7};
+	std::size_t pos = contents.find(std::string(reinterpret_cast<char const*>(storage), sizeof(storage)));
+	BOOST_REQUIRE(pos != std::string::npos);
+	
+	typedef std::pair<std::size_t, std::uint64_t> Change;
+	auto writeChanged = [&](std::vector<Change> const& changes){
+		std::string changed = contents;
+		for(Change const& change: changes)
+			std::memcpy(&changed[pos + change.first * sizeof(std::uint64_t)], &change.second, sizeof(std::uint64_t));
+		std::ofstream out("./Test/test_output/corrupted.bin", std::ios::binary);
+		out.write(changed.data(), changed.size());
+	};
+	Data<CompressedRealVector> loaded;
+	//column index outside of the input dimension
+	writeChanged({Change(6, 10)});
+	BOOST_CHECK_THROW(BinaryDataFile("./Test/test_output/corrupted.bin"), shark::Exception);
+	BOOST_CHECK_THROW(importBinaryData(loaded, "./Test/test_output/corrupted.bin"), shark::Exception);
+	//decreasing row offsets
+	writeChanged({Change(1, 3)});
+	BOOST_CHECK_THROW(BinaryDataFile("./Test/test_output/corrupted.bin"), shark::Exception);
+	//last row offset is not the number of nonzeros
+	writeChanged({Change(3, 2)});
+	BOOST_CHECK_THROW(BinaryDataFile("./Test/test_output/corrupted.bin"), shark::Exception);
+	//column indices of a row are not increasing
+	writeChanged({Change(1, 0), Change(4, 6), Change(5, 5)});
+	BOOST_CHECK_THROW(BinaryDataFile("./Test/test_output/corrupted.bin"), shark::Exception);
+	
+	//moving the first nonzero into the second row is valid
+	writeChanged({Change(1, 0)});
+	importBinaryData(loaded, "./Test/test_output/corrupted.bin");
+	RealMatrix inputs = loaded[0];
+	BOOST_CHECK_EQUAL(norm_1(row(inputs, 0)), 0.0);
+	BOOST_CHECK_EQUAL(inputs(1, 5), 1.0);
+	BOOST_CHECK_EQUAL(inputs(1, 6), 2.0);
+	BOOST_CHECK_EQUAL(inputs(2, 7), 3.0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
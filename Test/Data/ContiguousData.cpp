@@ -0,0 +1,164 @@
+#define BOOST_TEST_MODULE Data_ContiguousData
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Data/ContiguousData.h>
+#include <shark/Core/Random.h>
+
+using namespace shark;
+
+BOOST_AUTO_TEST_SUITE (Data_ContiguousData)
+
+//all batches are ranges of rows of one arena and the elements are its rows in order
+BOOST_AUTO_TEST_CASE( ContiguousData_Arena )
+{
+	ContiguousData<RealVector> data(103, {4}, 10);
+	BOOST_REQUIRE_EQUAL(data.size(), 11);
+	BOOST_CHECK_EQUAL(data.numberOfElements(), 103);
+	BOOST_CHECK_EQUAL(data.storage().size1(), 103);
+	BOOST_CHECK_EQUAL(data.storage().size2(), 4);
+	std::size_t start = 0;
+	for(std::size_t b = 0; b != data.size(); ++b){
+		auto batch = data[b];
+		BOOST_CHECK_EQUAL(batch.size2(), 4);
+		for(std::size_t i = 0; i != batch.size1(); ++i){
+			for(std::size_t j = 0; j != 4; ++j)
+				batch(i, j) = double(10 * (start + i) + j);
+		}
+		//the batch references the arena
+		BOOST_CHECK_EQUAL(&batch(0, 0), &data.storage()(start, 0));
+		start += batch.size1();
+	}
+	std::size_t i = 0;
+	for(auto element: elements(data)){
+		BOOST_REQUIRE_EQUAL(element.size(), 4);
+		for(std::size_t j = 0; j != 4; ++j)
+			BOOST_CHECK_EQUAL(element(j), double(10 * i + j));
+		++i;
+	}
+	BOOST_CHECK_EQUAL(i, 103);
+}
+
+//conversion from and to Data keeps the partitioning and the elements
+BOOST_AUTO_TEST_CASE( ContiguousData_Data_Roundtrip )
+{
+	Data<RealVector> data(std::vector<std::size_t>({5, 1, 0, 7, 3}), {3});
+	for(auto& batch: data)
+		batch = blas::normal(random::globalRng(), batch.size1(), 3, 0.0, 1.0, blas::cpu_tag());
+	ContiguousData<RealVector> contiguous(data);
+	BOOST_CHECK(contiguous.getPartitioning() == data.getPartitioning());
+	BOOST_CHECK_EQUAL(contiguous.shape(), data.shape());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		BOOST_REQUIRE_EQUAL(contiguous[b].size1(), data[b].size1());
+		for(std::size_t i = 0; i != data[b].size1(); ++i)
+			for(std::size_t j = 0; j != 3; ++j)
+				BOOST_CHECK_EQUAL(contiguous[b](i, j), data[b](i, j));
+	}
+	Data<RealVector> copy = contiguous.toData();
+	BOOST_CHECK(copy.getPartitioning() == data.getPartitioning());
+	for(std::size_t b = 0; b != data.size(); ++b)
+		BOOST_CHECK_EQUAL(max(abs(copy[b] - data[b])), 0.0);
+
+	//class labels are stored in a single vector
+	Data<unsigned int> labels(20, {3}, 6);
+	for(std::size_t b = 0; b != labels.size(); ++b)
+		for(std::size_t i = 0; i != labels[b].size(); ++i)
+			labels[b](i) = (unsigned int)(b + i) % 3;
+	ContiguousData<unsigned int> contiguousLabels(labels);
+	BOOST_CHECK_EQUAL(contiguousLabels.storage().size(), 20);
+	std::size_t i = 0;
+	for(auto label: elements(contiguousLabels)){
+		BOOST_CHECK_EQUAL(label, elements(labels)[i]);
+		++i;
+	}
+}
+
+//subsets share the arena and store only the position of their batches
+BOOST_AUTO_TEST_CASE( ContiguousData_Subset )
+{
+	ContiguousData<unsigned int> data(30, {30}, 4);
+	BOOST_REQUIRE_EQUAL(data.size(), 8);
+	for(std::size_t i = 0; i != 30; ++i)
+		data.element(i) = (unsigned int)i;
+	BOOST_CHECK(data.isIndependent());
+
+	ContiguousData<unsigned int> subset = data.indexedSubset({6, 1, 3});
+	BOOST_CHECK(!data.isIndependent());
+	BOOST_CHECK(!subset.isIndependent());
+	BOOST_CHECK_EQUAL(&subset.storage(), &data.storage());
+	BOOST_REQUIRE_EQUAL(subset.numberOfElements(), 11);
+	//batches of sizes 4,4,4,4,4,4,3,3
+	unsigned int expected[] = {24, 25, 26, 4, 5, 6, 7, 12, 13, 14, 15};
+	std::size_t i = 0;
+	for(auto element: elements(subset)){
+		BOOST_CHECK_EQUAL(element, expected[i]);
+		++i;
+	}
+	//changes are visible in all datasets sharing the arena
+	subset.element(3) = 100;
+	BOOST_CHECK_EQUAL(data.element(4), 100);
+
+	//an independent subset is compacted into its own arena
+	subset.makeIndependent();
+	BOOST_CHECK(subset.isIndependent());
+	BOOST_CHECK(data.isIndependent());
+	BOOST_CHECK_EQUAL(subset.storage().size(), 11);
+	subset.element(3) = 4;
+	BOOST_CHECK_EQUAL(data.element(4), 100);
+	for(std::size_t i = 0; i != 11; ++i)
+		BOOST_CHECK_EQUAL(subset.storage()(i), expected[i]);
+}
+
+//labeled data keeps inputs and labels of an element together in two arenas
+BOOST_AUTO_TEST_CASE( ContiguousLabeledData_Elements )
+{
+	LabeledData<RealVector, unsigned int> data(25, {{2}, {5}}, 4);
+	std::size_t n = 0;
+	for(auto element: elements(data)){
+		element.input(0) = double(n);
+		element.input(1) = -double(n);
+		element.label = (unsigned int)(n % 5);
+		++n;
+	}
+	ContiguousLabeledData<RealVector, unsigned int> contiguous(data);
+	BOOST_CHECK(contiguous.getPartitioning() == data.getPartitioning());
+	BOOST_CHECK_EQUAL(contiguous.shape().input, Shape({2}));
+	BOOST_CHECK_EQUAL(contiguous.shape().label, Shape({5}));
+	BOOST_CHECK_EQUAL(inputDimension(contiguous), 2);
+	BOOST_CHECK_EQUAL(contiguous.inputs().storage().size1(), 25);
+	BOOST_CHECK_EQUAL(contiguous.labels().storage().size(), 25);
+	for(std::size_t b = 0; b != data.size(); ++b){
+		auto batch = contiguous[b];
+		BOOST_REQUIRE_EQUAL(batch.input.size1(), batch.label.size());
+		BOOST_CHECK_EQUAL(max(abs(batch.input - data[b].input)), 0.0);
+	}
+	std::size_t i = 0;
+	for(auto element: elements(contiguous)){
+		BOOST_CHECK_EQUAL(element.input(0), double(i));
+		BOOST_CHECK_EQUAL(element.label, i % 5);
+		++i;
+	}
+	BOOST_CHECK_EQUAL(i, 25);
+
+	//subsets share both arenas
+	ContiguousLabeledData<RealVector, unsigned int> subset = contiguous.indexedSubset({5, 0});
+	BOOST_CHECK(!contiguous.isIndependent());
+	//batches of sizes 4,4,4,4,3,3,3
+	BOOST_REQUIRE_EQUAL(subset.numberOfElements(), 7);
+	BOOST_CHECK_EQUAL(subset.element(0).input(0), 19.0);
+	BOOST_CHECK_EQUAL(subset.element(3).input(0), 0.0);
+	subset.element(0).label = 2;
+	BOOST_CHECK_EQUAL(contiguous.element(19).label, 2);
+	subset.makeIndependent();
+	BOOST_CHECK(subset.isIndependent());
+	BOOST_CHECK(contiguous.isIndependent());
+
+	LabeledData<RealVector, unsigned int> copy = subset.toLabeledData();
+	BOOST_REQUIRE_EQUAL(copy.numberOfElements(), 7);
+	for(std::size_t i = 0; i != 7; ++i){
+		BOOST_CHECK_EQUAL(elements(copy)[i].input(0), subset.element(i).input(0));
+		BOOST_CHECK_EQUAL(elements(copy)[i].label, subset.element(i).label);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,11 @@
 #include <shark/LinAlg/Base.h>
 
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <shark/Core/Random.h>
+#include <clocale>
+#include <cstdio>
+#include <cmath>
+#include <sstream>
 
 using namespace shark;
 
@@ -406,4 +411,265 @@ BOOST_AUTO_TEST_CASE( Data_Csv_Export)
 }
 
 
+// the file is split into chunks of about 1MB that are parsed in parallel. The values
+// must be the same as the ones returned by strtod and errors in any chunk must be reported.
+BOOST_AUTO_TEST_CASE( Data_Csv_Large_Import)
+{
+	std::size_t const numRows = 50000;
+	std::size_t const numColumns = 6;
+	std::vector<double> values(numRows * numColumns);
+	std::string contents = "# a large file\n";
+	char buffer[64];
+	for(std::size_t i = 0; i != numRows; ++i){
+		for(std::size_t j = 0; j != numColumns; ++j){
+			double value = random::gauss(random::globalRng(), 0, 1) * std::pow(10.0, double(int(i % 40) - 20));
+			switch(j){
+				case 0: std::sprintf(buffer, "%.17g", value); break;
+				case 1: std::sprintf(buffer, "%.3f", value); break;
+				case 2: std::sprintf(buffer, "%e", value); break;
+				case 3: std::sprintf(buffer, "%d", int(i) - 20000); break;
+				case 4: std::sprintf(buffer, "%.25g", value); break;
+				default: std::sprintf(buffer, "%.6E", -value);
+			}
+			values[i * numColumns + j] = std::strtod(buffer, nullptr);
+			contents += buffer;
+			contents += (j + 1 == numColumns) ? ((i % 3 == 0)? "\r\n" : "\n") : ", ";
+		}
+	}
+	BOOST_REQUIRE_GT(contents.size(), 2u << 20);
+
+	Data<RealVector> test;
+	csvStringToData(test, contents, ',', '#', 100);
+	BOOST_REQUIRE_EQUAL(test.numberOfElements(), numRows);
+	BOOST_REQUIRE_EQUAL(dataDimension(test), numColumns);
+	std::size_t i = 0;
+	for(auto const& point: elements(test)){
+		for(std::size_t j = 0; j != numColumns; ++j){
+			BOOST_CHECK_EQUAL(point(j), values[i * numColumns + j]);
+		}
+		++i;
+	}
+
+	//a row with a missing column at the end of the file
+	contents += "1,2,3,4,5\n";
+	BOOST_CHECK_THROW(csvStringToData(test, contents, ',', '#', 100), shark::Exception);
+}
+
+// values outside of the fast path of the parser, e.g. with 17 significant digits, do not depend
+// on the decimal point of the locale set by setlocale
+BOOST_AUTO_TEST_CASE( Data_Csv_Import_Long_Numbers)
+{
+	std::string contents =
+		"0.30000000000000004, 1.2345678901234567e-300, 12345678901234567\n"
+		"-9007199254740993, 1e400, inf\n";
+	char const* locales[] = {"de_DE.UTF-8", "de_DE", "fr_FR.UTF-8", "C"};
+	std::string oldLocale = std::setlocale(LC_NUMERIC, nullptr);
+	for(char const* locale: locales){
+		if(!std::setlocale(LC_NUMERIC, locale)) continue;
+		Data<RealVector> test;
+		csvStringToData(test, contents, ',', '#');
+		BOOST_REQUIRE_EQUAL(test.numberOfElements(), 2);
+		RealMatrix const& values = test[0];
+		BOOST_CHECK_EQUAL(values(0, 0), 0.30000000000000004);
+		BOOST_CHECK_EQUAL(values(0, 1), 1.2345678901234567e-300);
+		BOOST_CHECK_EQUAL(values(0, 2), 12345678901234567.0);
+		BOOST_CHECK_EQUAL(values(1, 0), -9007199254740993.0);
+		BOOST_CHECK_EQUAL(values(1, 1), std::numeric_limits<double>::infinity());
+		BOOST_CHECK_EQUAL(values(1, 2), std::numeric_limits<double>::infinity());
+	}
+	std::setlocale(LC_NUMERIC, oldLocale.c_str());
+}
+
+// the generators return the records in the order of the file and start again after the last record
+BOOST_AUTO_TEST_CASE( Data_Csv_Stream)
+{
+	std::string contents =
+		"# title line\n"
+		"1.5,2,3,0\n"
+		"# comment\n"
+		"4,5,,1\r\n"
+		"\n"
+		"7,8e-3,9,2 # trailing comment\n"
+		"10, -11,12,1\n"
+		"13,14,15,0";
+	std::size_t const numRecords = 5;
+
+	//unlabeled data
+	{
+		Data<RealVector> data;
+		csvStringToData(data, contents, ',', '#');
+		std::stringstream stream(contents);
+		Generator<RealVector> gen;
+		streamCSV(gen, stream, ',', '#', 2);
+		BOOST_CHECK_EQUAL(gen.shape(), Shape({4}));
+		std::size_t record = 0;
+		for(std::size_t batch = 0; batch != 6; ++batch){
+			RealMatrix points = gen();
+			BOOST_REQUIRE_EQUAL(points.size1(), (batch % 3 == 2)? 1 : 2);
+			for(std::size_t i = 0; i != points.size1(); ++i, ++record){
+				RealVector expected = elements(data)[record % numRecords];
+				for(std::size_t j = 0; j != 4; ++j){
+					if(std::isnan(expected(j)))
+						BOOST_CHECK(std::isnan(points(i, j)));
+					else
+						BOOST_CHECK_EQUAL(points(i, j), expected(j));
+				}
+			}
+		}
+	}
+	//classification with title line
+	{
+		LabeledData<RealVector, unsigned int> data;
+		csvStringToData(data, contents, LAST_COLUMN, ',', '#');
+		std::stringstream stream(contents);
+		LabeledDataGenerator<RealVector, unsigned int> gen;
+		streamCSV(gen, stream, LAST_COLUMN, 3, ',', '#', 3, 2);
+		BOOST_CHECK_EQUAL(gen.shape().input, Shape({3}));
+		BOOST_CHECK_EQUAL(gen.shape().label, Shape({3}));
+		//the two title lines skip the first record
+		std::size_t record = 0;
+		for(std::size_t batch = 0; batch != 4; ++batch){
+			auto points = gen();
+			BOOST_REQUIRE_EQUAL(points.input.size1(), (batch % 2 == 0)? 3 : 1);
+			for(std::size_t i = 0; i != points.input.size1(); ++i, ++record){
+				auto expected = elements(data)[1 + record % (numRecords - 1)];
+				BOOST_CHECK_EQUAL(points.label(i), expected.label);
+				BOOST_CHECK_EQUAL(points.input(i, 0), expected.input(0));
+			}
+		}
+		//not enough classes
+		std::stringstream stream2(contents);
+		streamCSV(gen, stream2, LAST_COLUMN, 2, ',', '#', 3);
+		BOOST_CHECK_THROW(gen(), shark::Exception);
+	}
+	//regression, read in parallel
+	{
+		LabeledData<RealVector, RealVector> data;
+		csvStringToData(data, contents, FIRST_COLUMN, 2, ',', '#');
+		std::stringstream stream(contents);
+		LabeledDataGenerator<RealVector, RealVector> gen;
+		streamCSV(gen, stream, FIRST_COLUMN, 2, ',', '#', 1, 0, 4);
+		BOOST_CHECK_EQUAL(gen.shape().input, Shape({2}));
+		BOOST_CHECK_EQUAL(gen.shape().label, Shape({2}));
+		//with a cache, the order of the records is not defined but every batch holds one record
+		for(std::size_t batch = 0; batch != 2 * numRecords; ++batch){
+			auto points = gen();
+			BOOST_REQUIRE_EQUAL(points.input.size1(), 1);
+			bool found = false;
+			for(auto const& element: elements(data)){
+				if(element.label(0) == points.label(0, 0) && element.label(1) == points.label(0, 1))
+					found = true;
+			}
+			BOOST_CHECK(found);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Data_Csv_Schema )
+{
+	std::string contents =
+		"# color, size, weight, class\n"
+		"red, 1.5, L, cat\n"
+		"\"blue\", 2.5, M, dog\n"
+		"green, ?, S, cat\n"
+		", 4.5, XL, mouse\n"
+		"red, , L, dog\n";
+	CsvSchema schema({CsvSchema::Categorical, CsvSchema::Numeric, CsvSchema::Ignored, CsvSchema::ClassLabel});
+
+	//float inputs, categories are collected from the file
+	LabeledData<FloatVector, unsigned int> data;
+	csvStringToData(data, contents, schema, ',', '#', 2);
+	BOOST_REQUIRE_EQUAL(data.numberOfElements(), 5);
+	BOOST_CHECK_EQUAL(data.size(), 3);
+	BOOST_REQUIRE_EQUAL(schema.categories(0).size(), 3);
+	BOOST_CHECK_EQUAL(schema.categories(0)[0], "blue");
+	BOOST_CHECK_EQUAL(schema.categories(0)[1], "green");
+	BOOST_CHECK_EQUAL(schema.categories(0)[2], "red");
+	BOOST_CHECK(schema.categories(2).empty());
+	BOOST_REQUIRE_EQUAL(schema.categories(3).size(), 3);
+	BOOST_CHECK_EQUAL(schema.categories(3)[0], "cat");
+	BOOST_CHECK_EQUAL(schema.categories(3)[1], "dog");
+	BOOST_CHECK_EQUAL(schema.categories(3)[2], "mouse");
+	BOOST_CHECK_EQUAL(schema.inputDimension(), 4);
+	BOOST_CHECK_EQUAL(data.shape().input, Shape({4}));
+	BOOST_CHECK_EQUAL(data.shape().label, Shape({3}));
+
+	float nan = std::numeric_limits<float>::quiet_NaN();
+	float inputs[5][4] = {
+		{0, 0, 1, 1.5f},
+		{1, 0, 0, 2.5f},
+		{0, 1, 0, nan},
+		{nan, nan, nan, 4.5f},
+		{0, 0, 1, nan}
+	};
+	unsigned int labels[5] = {0, 1, 0, 2, 1};
+	std::size_t i = 0;
+	for(auto element: elements(data)){
+		for(std::size_t j = 0; j != 4; ++j){
+			if(std::isnan(inputs[i][j]))
+				BOOST_CHECK(std::isnan(element.input(j)));
+			else
+				BOOST_CHECK_EQUAL(element.input(j), inputs[i][j]);
+		}
+		BOOST_CHECK_EQUAL(element.label, labels[i]);
+		++i;
+	}
+
+	//the schema encodes a test file in the same way, unknown categories are missing values
+	LabeledData<RealVector, unsigned int> test;
+	csvStringToData(test, "yellow, 1, S, mouse\nblue, 2, S, cat\n", schema, ',', '#');
+	BOOST_REQUIRE_EQUAL(test.numberOfElements(), 2);
+	BOOST_CHECK_EQUAL(test.shape().label, Shape({3}));
+	BOOST_CHECK(std::isnan(elements(test)[0].input(0)));
+	BOOST_CHECK_EQUAL(elements(test)[0].label, 2);
+	BOOST_CHECK_EQUAL(elements(test)[1].input(0), 1.0);
+	BOOST_CHECK_EQUAL(elements(test)[1].input(3), 2.0);
+	BOOST_CHECK_EQUAL(elements(test)[1].label, 0);
+	//unknown labels and wrong number of columns are errors
+	BOOST_CHECK_THROW(csvStringToData(test, "red, 1, S, bird\n", schema, ',', '#'), shark::Exception);
+	BOOST_CHECK_THROW(csvStringToData(test, "red, 1, S, cat\nred, 1, cat\n", schema, ',', '#'), shark::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( Data_Csv_Schema_Regression )
+{
+	std::string contents =
+		"1.0, 10, a, 0.5\n"
+		"2.0, 2, b, 1.5\n"
+		"3.0, 10, a, 2.5\n";
+	CsvSchema schema(4);
+	schema.setColumnType(1, CsvSchema::Categorical);
+	schema.setColumnType(2, CsvSchema::Categorical);
+	schema.setColumnType(3, CsvSchema::Target);
+	LabeledData<RealVector, RealVector> data;
+	csvStringToData(data, contents, schema);
+	//numeric categories are ordered by value
+	BOOST_REQUIRE_EQUAL(schema.categories(1).size(), 2);
+	BOOST_CHECK_EQUAL(schema.categories(1)[0], "2");
+	BOOST_CHECK_EQUAL(schema.categories(1)[1], "10");
+	BOOST_CHECK_EQUAL(data.shape().input, Shape({5}));
+	BOOST_CHECK_EQUAL(data.shape().label, Shape({1}));
+	BOOST_REQUIRE_EQUAL(data.numberOfElements(), 3);
+	double inputs[3][5] = {
+		{1, 0, 1, 1, 0},
+		{2, 1, 0, 0, 1},
+		{3, 0, 1, 1, 0}
+	};
+	std::size_t i = 0;
+	for(auto element: elements(data)){
+		for(std::size_t j = 0; j != 5; ++j)
+			BOOST_CHECK_EQUAL(element.input(j), inputs[i][j]);
+		BOOST_CHECK_EQUAL(element.label(0), 0.5 + i);
+		++i;
+	}
+	//missing targets are errors
+	BOOST_CHECK_THROW(csvStringToData(data, "1.0, 10, a, ?\n", schema), shark::Exception);
+	//unlabeled data can not have targets
+	Data<RealVector> unlabeled;
+	BOOST_CHECK_THROW(csvStringToData(unlabeled, contents, schema), shark::Exception);
+	schema.setColumnType(3, CsvSchema::Numeric);
+	csvStringToData(unlabeled, contents, schema);
+	BOOST_CHECK_EQUAL(unlabeled.shape(), Shape({6}));
+	BOOST_CHECK_EQUAL(elements(unlabeled)[2](5), 2.5);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -203,5 +203,44 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(DataView_Dataset_Test, SetType,LabeledSetTypes){
 	}
 }
 
+BOOST_AUTO_TEST_CASE(DataView_Partitioning_Test){
+	//regular partitionings as created by the dataset and arbitrary ones
+	std::vector<std::vector<std::size_t> > partitionings = {
+		{11, 11, 11, 10, 10},
+		{10, 10, 10},
+		{11, 11},
+		{3, 7, 1, 12, 5},
+		{10, 10, 4},
+		{5}
+	};
+	for(auto const& partitioning: partitionings){
+		Data<int> set(partitioning, {});
+		int value = 0;
+		for(auto& batch: set){
+			for(std::size_t j = 0; j != batch.size(); ++j, ++value)
+				batch(j) = value;
+		}
+		DataView<Data<int> > view(set);
+		BOOST_REQUIRE_EQUAL(view.size(), std::size_t(value));
+		std::size_t i = 0;
+		for(std::size_t b = 0; b != partitioning.size(); ++b){
+			for(std::size_t j = 0; j != partitioning[b]; ++j, ++i){
+				BOOST_CHECK_EQUAL(view[i], int(i));
+				BOOST_CHECK_EQUAL(view.batch(i), b);
+				BOOST_CHECK_EQUAL(view.positionInBatch(i), j);
+			}
+		}
+
+		//swapping elements does not change the dataset
+		view.swapElements(0, view.size() - 1);
+		BOOST_CHECK_EQUAL(view[0], value - 1);
+		BOOST_CHECK_EQUAL(view[view.size() - 1], 0);
+		BOOST_CHECK_EQUAL(view.index(0), view.size() - 1);
+		for(std::size_t k = 1; k + 1 < view.size(); ++k){
+			BOOST_CHECK_EQUAL(view[k], int(k));
+		}
+		BOOST_CHECK_EQUAL(elements(set)[0], 0);
+	}
+}
 
 BOOST_AUTO_TEST_SUITE_END()
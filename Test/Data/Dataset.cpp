@@ -278,6 +278,31 @@ BOOST_AUTO_TEST_CASE( Set_splitAtElement_MiddleOfBatch_Test )
 }
 
 
+BOOST_AUTO_TEST_CASE( Shuffle_Test )
+{
+	std::vector<unsigned int> inputs(1000);
+	for (unsigned int i=0;i!=1000;++i) {
+		inputs[i] = i;
+	}
+	Data<unsigned int> data = createDataFromRange(inputs,17);
+	Data<unsigned int> shuffled = shuffle(data);
+	BOOST_REQUIRE_EQUAL(shuffled.numberOfElements(),1000);
+	BOOST_REQUIRE_EQUAL(shuffled.size(),data.size());
+	for(std::size_t b = 0; b != data.size(); ++b){
+		BOOST_CHECK_EQUAL(shuffled[b].size(),data[b].size());
+	}
+	//every element appears once and the order changed
+	std::vector<unsigned int> elems(elements(shuffled).begin(),elements(shuffled).end());
+	BOOST_CHECK(elems != inputs);
+	std::sort(elems.begin(),elems.end());
+	BOOST_CHECK(elems == inputs);
+	
+	//the dataset is not changed
+	for(std::size_t i = 0; i != 1000; ++i){
+		BOOST_CHECK_EQUAL(elements(data)[i],i);
+	}
+}
+
 BOOST_AUTO_TEST_CASE( RepartitionByClass_Test )
 {
 	std::vector<UIntVector> inputs(101,UIntVector(3));
@@ -293,4 +293,49 @@ BOOST_AUTO_TEST_CASE( Generator_FilePaths_FileSystem){
 	}
 }
 
+BOOST_AUTO_TEST_CASE( Generator_Epoch_Test){
+	//dataset with irregular batch sizes whose elements are their own index
+	std::vector<std::size_t> partitioning = {7, 3, 11, 5};
+	LabeledData<RealVector, unsigned int> data(partitioning, {2, 30});
+	unsigned int index = 0;
+	for(auto element: elements(data)){
+		element.input(0) = index;
+		element.input(1) = 2.0 * index;
+		element.label = index;
+		++index;
+	}
+	for(std::size_t cacheSize: {std::size_t(0), std::size_t(3)}){
+		Generator<InputLabelPair<RealVector, unsigned int> > gen = epochGenerator(data, cacheSize);
+		BOOST_CHECK_EQUAL(gen.shape().input, data.shape().input);
+		for(std::size_t epoch = 0; epoch != 5; ++epoch){
+			//every epoch returns every batch once
+			std::vector<std::size_t> counts(index, 0);
+			std::vector<std::size_t> sizes;
+			for(std::size_t b = 0; b != partitioning.size(); ++b){
+				auto batch = gen();
+				sizes.push_back(batch.label.size());
+				unsigned int minLabel = index;
+				for(std::size_t i = 0; i != batch.label.size(); ++i){
+					unsigned int label = batch.label(i);
+					BOOST_REQUIRE(label < index);
+					BOOST_CHECK_EQUAL(batch.input(i, 0), label);
+					BOOST_CHECK_EQUAL(batch.input(i, 1), 2.0 * label);
+					++counts[label];
+					minLabel = std::min(minLabel, label);
+				}
+				//the elements of a batch stay together
+				for(std::size_t i = 0; i != batch.label.size(); ++i){
+					BOOST_CHECK_LT(batch.label(i), minLabel + batch.label.size());
+				}
+			}
+			for(std::size_t i = 0; i != index; ++i){
+				BOOST_CHECK_EQUAL(counts[i], 1);
+			}
+			std::sort(sizes.begin(), sizes.end());
+			BOOST_CHECK_EQUAL(sizes[0], 3);
+			BOOST_CHECK_EQUAL(sizes[3], 11);
+		}
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,113 @@
+#define BOOST_TEST_MODULE Data_ImageArchive
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Data/ImageArchive.h>
+#include <shark/Core/Images/ReadImage.h>
+#include <shark/Core/ZipSupport.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace shark;
+
+namespace{
+//the images of the archive in the order of their names, image k stored at pixel (r,c) the value 40*k+10*r+c
+std::vector<std::string> const imageNames = {"cats/0.pgm", "cats/1.png", "dogs/2.PGM", "dogs/3.png", "dogs/4.pgm"};
+}
+
+BOOST_AUTO_TEST_SUITE (Data_ImageArchive)
+
+BOOST_AUTO_TEST_CASE( ImageArchive_Deflated_Files )
+{
+	//readme.txt is deflated and decompressed without libzip
+	ZipReader reader("Test/test_data/images.zip");
+	std::vector<unsigned char> readme = reader.readFile("readme.txt");
+	std::string expected;
+	for(std::size_t i = 0; i != 20; ++i)
+		expected += "test images\n";
+	BOOST_CHECK_EQUAL(std::string(readme.begin(), readme.end()), expected);
+
+	std::vector<unsigned char> image = reader.readFile("dogs/2.PGM");
+	auto decoded = image::readImage<double>(image);
+	BOOST_CHECK_EQUAL(decoded.second, Shape({3, 4, 1}));
+	for(std::size_t r = 0; r != 3; ++r){
+		for(std::size_t c = 0; c != 4; ++c){
+			BOOST_CHECK_CLOSE(decoded.first(r * 4 + c) * 256, 80.0 + 10 * r + c, 1.e-10);
+		}
+	}
+}
+
+//several threads inflate the deflated files of one reader at the same time
+BOOST_AUTO_TEST_CASE( ImageArchive_Concurrent_Reads )
+{
+	ZipReader reader("Test/test_data/images.zip");
+	std::vector<std::vector<unsigned char> > files;
+	for(std::size_t i = 0; i != reader.numFiles(); ++i)
+		files.push_back(reader.readFile(i));
+
+	std::atomic<std::size_t> mismatches(0);
+	std::vector<std::thread> threads;
+	for(std::size_t t = 0; t != 4; ++t){
+		threads.emplace_back([&, t]{
+			for(std::size_t r = 0; r != 50; ++r){
+				for(std::size_t k = 0; k != files.size(); ++k){
+					std::size_t i = (k + t) % files.size();
+					if(reader.readFile(i) != files[i])
+						++mismatches;
+				}
+			}
+		});
+	}
+	for(auto& thread: threads)
+		thread.join();
+	BOOST_CHECK_EQUAL(mismatches, 0);
+}
+
+BOOST_AUTO_TEST_CASE( ImageArchive_Unlabeled )
+{
+	Data<RealVector> images;
+	ArchiveImportStatistics statistics = importImageArchive(images, "Test/test_data/images.zip", 2);
+	BOOST_CHECK_EQUAL(statistics.files, 5);
+	BOOST_CHECK(statistics.bytes > 0);
+	BOOST_CHECK(statistics.seconds >= 0.0);
+	BOOST_CHECK_EQUAL(images.numberOfElements(), 5);
+	BOOST_CHECK_EQUAL(images.size(), 3);
+	BOOST_CHECK_EQUAL(images.shape(), Shape({3, 4, 1}));
+
+	ZipReader reader("Test/test_data/images.zip");
+	std::size_t k = 0;
+	for(auto const& element: elements(images)){
+		auto expected = image::readImage<double>(reader.readFile(imageNames[k]));
+		BOOST_REQUIRE_EQUAL(element.size(), expected.first.size());
+		for(std::size_t i = 0; i != element.size(); ++i)
+			BOOST_CHECK_EQUAL(element(i), expected.first(i));
+		++k;
+	}
+}
+
+BOOST_AUTO_TEST_CASE( ImageArchive_Labeled )
+{
+	LabeledData<RealVector, unsigned int> data;
+	std::vector<std::string> classNames;
+	importImageArchive(data, classNames, "Test/test_data/images.zip");
+	BOOST_REQUIRE_EQUAL(classNames.size(), 2);
+	BOOST_CHECK_EQUAL(classNames[0], "cats");
+	BOOST_CHECK_EQUAL(classNames[1], "dogs");
+	BOOST_CHECK_EQUAL(data.shape().input, Shape({3, 4, 1}));
+	BOOST_CHECK_EQUAL(data.shape().label, Shape({2}));
+
+	unsigned int labels[] = {0, 0, 1, 1, 1};
+	ZipReader reader("Test/test_data/images.zip");
+	std::size_t k = 0;
+	for(auto const& element: elements(data)){
+		BOOST_CHECK_EQUAL(element.label, labels[k]);
+		auto expected = image::readImage<double>(reader.readFile(imageNames[k]));
+		//the first pixel identifies the image
+		BOOST_CHECK_EQUAL(element.input(0), expected.first(0));
+		++k;
+	}
+	BOOST_CHECK_EQUAL(k, 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+#define BOOST_TEST_MODULE Data_Prefetch
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Data/Prefetch.h>
+#include <shark/Core/Random.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace shark;
+
+BOOST_AUTO_TEST_SUITE (Data_Prefetch)
+
+BOOST_AUTO_TEST_CASE( Prefetch_Stages_Order )
+{
+	Data<RealVector> data(95, {3}, 10);
+	for(auto& batch: data){
+		batch = blas::normal(random::globalRng(), batch.size1(), batch.size2(), 0.0, 1.0, blas::cpu_tag());
+	}
+	auto stages = prefetchSource(data)
+		.then("scale", [](RealMatrix batch){return RealMatrix(2 * batch);})
+		.then("shift", [](RealMatrix batch){return RealMatrix(batch + 1);});
+	PrefetchPipeline<RealVector> pipeline(stages, data.shape(), 4);
+	BOOST_CHECK_EQUAL(pipeline.shape(), data.shape());
+
+	//the batches are returned in order and the dataset is repeated
+	for(std::size_t i = 0; i != 25; ++i){
+		RealMatrix batch = pipeline.next();
+		RealMatrix expected = 2 * data[i % data.size()] + 1;
+		BOOST_REQUIRE_EQUAL(batch.size1(), expected.size1());
+		BOOST_CHECK_SMALL(max(abs(batch - expected)), 1.e-12);
+	}
+	BOOST_CHECK_EQUAL(pipeline.batches(), 25);
+	BOOST_CHECK(pipeline.waitSeconds() >= 0.0);
+
+	std::vector<PrefetchStageStatistics> statistics = pipeline.statistics();
+	BOOST_REQUIRE_EQUAL(statistics.size(), 3);
+	BOOST_CHECK_EQUAL(statistics[0].name, "source");
+	BOOST_CHECK_EQUAL(statistics[1].name, "scale");
+	BOOST_CHECK_EQUAL(statistics[2].name, "shift");
+	for(auto const& stage: statistics){
+		BOOST_CHECK(stage.batches >= 25);
+		BOOST_CHECK(stage.batches <= 25 + 4);
+		BOOST_CHECK(stage.seconds >= 0.0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Prefetch_Source_Types )
+{
+	//the source computes the sizes of the batches, the last stage creates them
+	auto stages = PrefetchStages<std::size_t>("size", [](std::size_t i){return i % 3 + 1;})
+		.then("create", [](std::size_t size){return RealMatrix(size, 2, double(size));});
+	auto pipeline = std::make_shared<PrefetchPipeline<RealVector> >(stages, Shape({2}), 2);
+	Generator<RealVector> gen = prefetchGenerator(pipeline);
+	BOOST_CHECK_EQUAL(gen.shape(), Shape({2}));
+	for(std::size_t i = 0; i != 10; ++i){
+		RealMatrix batch = gen();
+		BOOST_CHECK_EQUAL(batch.size1(), i % 3 + 1);
+		BOOST_CHECK_EQUAL(batch(0, 1), double(i % 3 + 1));
+	}
+	BOOST_CHECK_EQUAL(pipeline->batches(), 10);
+
+	//batches of generators
+	Generator<RealVector> constant([]{return RealMatrix(4, 2, 1.0);}, {2});
+	PrefetchPipeline<RealVector> generated(prefetchSource(constant), {2}, 3);
+	for(std::size_t i = 0; i != 5; ++i){
+		BOOST_CHECK_EQUAL(generated.next().size1(), 4);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Prefetch_Backpressure_Exceptions )
+{
+	std::atomic<std::size_t> started(0);
+	auto stages = PrefetchStages<RealMatrix>("source", [&](std::size_t i){
+		++started;
+		SHARK_RUNTIME_CHECK(i != 3, "broken batch");
+		return RealMatrix(1, 1, double(i));
+	});
+	PrefetchPipeline<RealVector> pipeline(stages, {1}, 3);
+	//no more batches than allowed are computed ahead
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	BOOST_CHECK(started <= 3);
+
+	for(std::size_t i = 0; i != 3; ++i){
+		BOOST_CHECK_EQUAL(pipeline.next()(0, 0), double(i));
+	}
+	//the error is reported for the batch in which it occured, the pipeline continues afterwards
+	BOOST_CHECK_THROW(pipeline.next(), shark::Exception);
+	BOOST_CHECK_EQUAL(pipeline.next()(0, 0), 4.0);
+	BOOST_CHECK(started <= 5 + 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 
 #include <shark/Data/SparseData.h>
 
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 
@@ -236,4 +237,135 @@ BOOST_AUTO_TEST_CASE (Set_SparseData)
 	//~ TestExportImport_regression(test_ds_sreg);
 }
 
+// the generators return the records in the order of the file and start again after the last record
+BOOST_AUTO_TEST_CASE (Import_SparseData_Large)
+{
+	//a few megabytes, such that the file is parsed in several chunks
+	std::size_t const numRecords = 5000;
+	std::size_t const dim = 1000;
+	std::vector<std::vector<std::pair<std::size_t, double> > > features(numRecords);
+	std::vector<unsigned int> labels(numRecords);
+	std::string contents;
+	for(std::size_t i = 0; i != numRecords; ++i){
+		labels[i] = (unsigned int)(i % 3) + 1;
+		contents += std::to_string(labels[i]);
+		for(std::size_t index = 1 + i % 7; index <= dim; index += 1 + (i * 7919 + index) % 97){
+			double value = (double(i % 1013) - 500.0) / 64.0 + double(index) * 1.e-3;
+			features[i].push_back(std::make_pair(index - 1, value));
+			char buffer[64];
+			std::snprintf(buffer, sizeof(buffer), " %u:%.17g", (unsigned int)index, value);
+			contents += buffer;
+		}
+		contents += i % 2 ? "\r\n" : "\n";
+	}
+
+	LabeledData<RealVector, unsigned int> dense;
+	LabeledData<CompressedRealVector, unsigned int> sparse;
+	{
+		std::istringstream stream(contents);
+		importSparseData(dense, stream, 0, 256);
+	}
+	{
+		std::istringstream stream(contents);
+		importSparseData(sparse, stream, 0, 256);
+	}
+	BOOST_REQUIRE_EQUAL(dense.numberOfElements(), numRecords);
+	BOOST_REQUIRE_EQUAL(sparse.numberOfElements(), numRecords);
+	BOOST_CHECK_EQUAL(inputDimension(dense), dim);
+	BOOST_CHECK_EQUAL(inputDimension(sparse), dim);
+	BOOST_CHECK_EQUAL(numberOfClasses(dense), 3);
+	for(std::size_t i = 0; i != numRecords; ++i){
+		RealVector x(dim, 0.0);
+		for(auto const& feature: features[i])
+			x(feature.first) = feature.second;
+		RealVector denseInput = elements(dense)[i].input;
+		RealVector sparseInput = elements(sparse)[i].input;
+		BOOST_REQUIRE_EQUAL(norm_inf(denseInput - x), 0.0);
+		BOOST_REQUIRE_EQUAL(norm_inf(sparseInput - x), 0.0);
+		BOOST_REQUIRE_EQUAL(elements(dense)[i].label, labels[i] - 1);
+		BOOST_REQUIRE_EQUAL(elements(sparse)[i].label, labels[i] - 1);
+	}
+
+	//a too small dimension is rejected
+	{
+		std::istringstream stream(contents);
+		BOOST_CHECK_THROW(importSparseData(dense, stream, dim - 1, 256), shark::Exception);
+	}
+	//an error in a later chunk is reported
+	{
+		std::istringstream stream(contents + "1 3:0.5 x:1\n");
+		BOOST_CHECK_THROW(importSparseData(sparse, stream, 0, 256), shark::Exception);
+	}
+}
+
+BOOST_AUTO_TEST_CASE (Stream_SparseData)
+{
+	std::size_t const batchSize = 2;
+	std::size_t const numBatches = 6;//two passes over the file
+	{
+		std::stringstream ss(test_binary_classification);
+		LabeledDataGenerator<RealVector, unsigned int> gen;
+		streamSparseData(gen, ss, VectorSize, 2, batchSize);
+		BOOST_CHECK_EQUAL(gen.shape().input, Shape({VectorSize}));
+		BOOST_CHECK_EQUAL(gen.shape().label, Shape({2}));
+		unsigned int labels[NumLines] = {0, 1, 1, 0, 1};
+		std::size_t record = 0;
+		for(std::size_t b = 0; b != numBatches; ++b){
+			auto batch = gen();
+			BOOST_REQUIRE_EQUAL(batch.input.size1(), (b % 3 == 2)? 1 : 2);
+			for(std::size_t i = 0; i != batch.input.size1(); ++i, ++record){
+				for(std::size_t j = 0; j != VectorSize; ++j)
+					BOOST_CHECK_EQUAL(batch.input(i, j), input_values[record % NumLines][j]);
+				BOOST_CHECK_EQUAL(batch.label(i), labels[record % NumLines]);
+			}
+		}
+	}
+	{
+		std::stringstream ss(test_mc_classification);
+		LabeledDataGenerator<CompressedRealVector, unsigned int> gen;
+		streamSparseData(gen, ss, VectorSize, 4, batchSize);
+		BOOST_CHECK_EQUAL(gen.shape().label, Shape({4}));
+		//the smallest label becomes class 0 like in importSparseData
+		unsigned int labels[NumLines] = {3, 2, 1, 0, 2};
+		std::size_t record = 0;
+		for(std::size_t b = 0; b != numBatches; ++b){
+			auto batch = gen();
+			BOOST_REQUIRE_EQUAL(batch.input.size1(), (b % 3 == 2)? 1 : 2);
+			RealMatrix inputs = batch.input;
+			for(std::size_t i = 0; i != batch.input.size1(); ++i, ++record){
+				for(std::size_t j = 0; j != VectorSize; ++j)
+					BOOST_CHECK_EQUAL(inputs(i, j), input_values[record % NumLines][j]);
+				BOOST_CHECK_EQUAL(batch.label(i), labels[record % NumLines]);
+			}
+		}
+		//the file has more classes than given
+		std::stringstream ss2(test_mc_classification);
+		BOOST_CHECK_THROW(streamSparseData(gen, ss2, VectorSize, 3, batchSize), shark::Exception);
+		//the index of the last record exceeds the dimensionality
+		std::stringstream ss3(test_mc_classification);
+		streamSparseData(gen, ss3, VectorSize - 1, 4, batchSize);
+		gen();
+		gen();
+		BOOST_CHECK_THROW(gen(), shark::Exception);
+	}
+	{
+		std::stringstream ss(test_regression);
+		LabeledDataGenerator<CompressedRealVector, RealVector> gen;
+		streamSparseData(gen, ss, VectorSize, batchSize);
+		BOOST_CHECK_EQUAL(gen.shape().label, Shape({1}));
+		double labels[NumLines] = {7.1, 9.99, -5.0, 1.0, 500.0};
+		std::size_t record = 0;
+		for(std::size_t b = 0; b != numBatches; ++b){
+			auto batch = gen();
+			BOOST_REQUIRE_EQUAL(batch.input.size1(), (b % 3 == 2)? 1 : 2);
+			RealMatrix inputs = batch.input;
+			for(std::size_t i = 0; i != batch.input.size1(); ++i, ++record){
+				for(std::size_t j = 0; j != VectorSize; ++j)
+					BOOST_CHECK_EQUAL(inputs(i, j), input_values[record % NumLines][j]);
+				BOOST_CHECK_EQUAL(batch.label(i, 0), labels[record % NumLines]);
+			}
+		}
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -3,6 +3,7 @@
 #define BOOST_TEST_MODULE Data_Statistics
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
+#include <shark/Core/Random.h>
 
 using namespace shark;
 
@@ -117,5 +118,43 @@ BOOST_AUTO_TEST_CASE( Data_Statistics_meanvar_covariance )
 	}
 }
 
+//batches of very different sizes and a large offset of the mean test the merging of the partial results
+BOOST_AUTO_TEST_CASE( Data_Statistics_meanvar_irregular_batches )
+{
+	std::size_t dim = 5;
+	std::vector<RealVector> points(1000, RealVector(dim));
+	for(auto& point: points){
+		for(std::size_t j = 0; j != dim; ++j)
+			point(j) = 1.e6 + j + random::gauss(random::globalRng(), 0, j + 1);
+	}
+	std::vector<std::size_t> partitioning = {1, 300, 2, 97, 0, 250, 1, 349};
+	Data<RealVector> data = createDataFromRange(points, partitioning);
+
+	//naive two pass computation
+	RealVector meanTest(dim, 0.0);
+	for(auto const& point: points)
+		meanTest += point / 1000.0;
+	RealMatrix covTest(dim, dim, 0.0);
+	for(auto const& point: points)
+		covTest += outer_prod(point - meanTest, point - meanTest) / 1000.0;
+
+	RealVector meanVec = mean(data);
+	RealVector meanVar;
+	RealVector varVec;
+	meanvar(data, meanVar, varVec);
+	RealVector meanCov;
+	RealMatrix covMat;
+	meanvar(data, meanCov, covMat);
+	for(std::size_t i = 0; i != dim; ++i){
+		BOOST_CHECK_CLOSE(meanVec(i), meanTest(i), 1.e-10);
+		BOOST_CHECK_CLOSE(meanVar(i), meanTest(i), 1.e-10);
+		BOOST_CHECK_CLOSE(meanCov(i), meanTest(i), 1.e-10);
+		BOOST_CHECK_CLOSE(varVec(i), covTest(i, i), 1.e-6);
+		for(std::size_t j = 0; j != dim; ++j){
+			BOOST_CHECK_SMALL(covMat(i, j) - covTest(i, j), 1.e-6);
+		}
+	}
+}
+
 
 BOOST_AUTO_TEST_SUITE_END();
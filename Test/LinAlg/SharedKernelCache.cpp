@@ -0,0 +1,165 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Test for the SharedKernelCache class
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+
+
+
+#define BOOST_TEST_MODULE LINALG_SHAREDKERNELCACHE
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/LinAlg/SharedKernelCache.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
+#include <shark/Algorithms/Trainers/CSvmTrainer.h>
+#include <shark/Data/CVDatasetTools.h>
+#include <shark/Data/DataDistribution.h>
+#include <shark/ObjectiveFunctions/CrossValidationError.h>
+#include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
+
+using namespace shark;
+
+BOOST_AUTO_TEST_SUITE (LinAlg_SharedKernelCache)
+
+BOOST_AUTO_TEST_CASE( SharedKernelCache_Folds )
+{
+	Chessboard problem;
+	ClassificationDataset dataset = problem.generateDataset(200, 10);
+	CVFolds<ClassificationDataset> folds = createCVSameSize(dataset, 5, 10);
+	GaussianRbfKernel<> kernel(0.5);
+	SharedKernelCache<RealVector, double> cache(kernel, folds.dataset().inputs());
+	
+	for(std::size_t f = 0; f != folds.size(); ++f){
+		ClassificationDataset training = folds.training(f);
+		KernelMatrix<RealVector, double> km(kernel, training.inputs());
+		SubsetKernelMatrix<RealVector, double> subset(cache, training.inputs());
+		BOOST_REQUIRE_EQUAL(subset.size(), km.size());
+		
+		std::size_t n = km.size();
+		std::vector<double> rowKm(n);
+		std::vector<double> rowSubset(n);
+		for(std::size_t i = 0; i != n; ++i){
+			km.row(i, 0, n, rowKm.data());
+			subset.row(i, 0, n, rowSubset.data());
+			for(std::size_t j = 0; j != n; ++j){
+				BOOST_CHECK_CLOSE(rowSubset[j], rowKm[j], 1.e-12);
+				BOOST_CHECK_CLOSE(subset.entry(i, j), rowKm[j], 1.e-12);
+			}
+		}
+		//check that flipping is handled correctly
+		subset.flipColumnsAndRows(0, n-1);
+		km.flipColumnsAndRows(0, n-1);
+		for(std::size_t j = 0; j != n; ++j){
+			BOOST_CHECK_CLOSE(subset.entry(0, j), km.entry(0, j), 1.e-12);
+		}
+	}
+	//every entry of the full matrix is computed only once
+	BOOST_CHECK_EQUAL(cache.getAccessCount(), 200 * 200);
+	
+	//changing the kernel invalidates the cache
+	kernel.setGamma(1.0);
+	SubsetKernelMatrix<RealVector, double> subset(cache, folds.training(0).inputs());
+	BOOST_CHECK_EQUAL(cache.cachedRows(), 0);
+	KernelMatrix<RealVector, double> km(kernel, folds.training(0).inputs());
+	std::vector<double> row(subset.size());
+	subset.row(3, 0, subset.size(), row.data());
+	for(std::size_t j = 0; j != subset.size(); ++j){
+		BOOST_CHECK_CLOSE(row[j], km.entry(3, j), 1.e-12);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( SharedKernelCache_CSvmTrainer )
+{
+	Chessboard problem;
+	ClassificationDataset dataset = problem.generateDataset(200, 10);
+	CVFolds<ClassificationDataset> folds = createCVSameSize(dataset, 4, 10);
+	GaussianRbfKernel<> kernel(0.5);
+	SharedKernelCache<RealVector, double> cache(kernel, folds.dataset().inputs());
+	
+	CSvmTrainer<RealVector, double> trainer(&kernel, 1.0, true);
+	CSvmTrainer<RealVector, double> cachedTrainer(&kernel, 1.0, true);
+	trainer.stoppingCondition().minAccuracy = 1e-8;
+	cachedTrainer.stoppingCondition().minAccuracy = 1e-8;
+	cachedTrainer.setSharedKernelCache(&cache);
+	
+	unsigned long long accesses = 0;
+	unsigned long long cachedAccesses = 0;
+	for(std::size_t f = 0; f != folds.size(); ++f){
+		ClassificationDataset training = folds.training(f);
+		KernelClassifier<RealVector> svm;
+		KernelClassifier<RealVector> cachedSvm;
+		trainer.train(svm, training);
+		cachedTrainer.train(cachedSvm, training);
+		accesses += trainer.accessCount();
+		cachedAccesses += cachedTrainer.accessCount();
+		
+		auto output = elements(svm.decisionFunction()(dataset.inputs()));
+		auto cachedOutput = elements(cachedSvm.decisionFunction()(dataset.inputs()));
+		for(std::size_t i = 0; i != dataset.numberOfElements(); ++i){
+			BOOST_CHECK_SMALL(output[i](0) - cachedOutput[i](0), 1.e-6);
+		}
+	}
+	BOOST_CHECK_LT(cachedAccesses, accesses);
+}
+
+BOOST_AUTO_TEST_CASE( SharedKernelCache_CrossValidationError )
+{
+	Chessboard problem;
+	ClassificationDataset dataset = problem.generateDataset(200, 10);
+	CVFolds<ClassificationDataset> folds = createCVSameSize(dataset, 4, 10);
+	GaussianRbfKernel<> kernel(0.5);
+	SharedKernelCache<RealVector, double> cache(kernel, folds.dataset().inputs());
+	
+	CSvmTrainer<RealVector, double> trainer(&kernel, 1.0, true);
+	trainer.stoppingCondition().minAccuracy = 1e-8;
+	KernelClassifier<RealVector> svm;
+	ZeroOneLoss<unsigned int> loss;
+	CrossValidationError<KernelClassifier<RealVector>, unsigned int> cvError(folds, &trainer, &svm, &trainer, &loss);
+	RealVector point = trainer.parameterVector();
+	double error = cvError.eval(point);
+	
+	cvError.setSharedKernelCache(&trainer, &cache);
+	double cachedError = cvError.eval(point);
+	BOOST_CHECK_CLOSE(cachedError, error, 1.e-10);
+	//every entry of the full matrix is computed at most once for all folds
+	BOOST_CHECK_LE(cache.getAccessCount(), 200 * 200);
+	BOOST_CHECK_GT(cache.cachedRows(), 0);
+	
+	
+	//the trainer does not keep the cache after the evaluation
+	KernelClassifier<RealVector> other;
+	trainer.train(other, problem.generateDataset(50, 10));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,198 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       unit test for agglomerative trees and hierarchical clustering
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+
+#define BOOST_TEST_MODULE Models_HierarchicalClustering
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <shark/Models/Trees/AgglomerativeTree.h>
+#include <shark/Models/Clustering/HierarchicalClustering.h>
+#include <shark/Core/Random.h>
+#include <algorithm>
+
+using namespace shark;
+
+namespace{
+//merge heights of plain agglomerative clustering, always merging the closest pair
+std::vector<double> greedyHeights(std::vector<RealVector> const& points, AgglomerativeTree::Linkage linkage){
+	std::vector<RealVector> centroids = points;
+	std::vector<double> sizes(points.size(), 1.0);
+	std::vector<double> spreads(points.size(), 0.0);
+	std::vector<double> heights;
+	while(centroids.size() > 1){
+		double best = std::numeric_limits<double>::max();
+		std::size_t bi = 0, bj = 0;
+		for(std::size_t i = 0; i != centroids.size(); ++i){
+			for(std::size_t j = 0; j != i; ++j){
+				double dist = distanceSqr(centroids[i], centroids[j]);
+				if(linkage == AgglomerativeTree::Ward)
+					dist *= sizes[i] * sizes[j] / (sizes[i] + sizes[j]);
+				else
+					dist += spreads[i] + spreads[j];
+				if(dist < best){
+					best = dist;
+					bi = i;
+					bj = j;
+				}
+			}
+		}
+		heights.push_back(best);
+		double total = sizes[bi] + sizes[bj];
+		RealVector centroid = (sizes[bi] * centroids[bi] + sizes[bj] * centroids[bj]) / total;
+		spreads[bi] = (sizes[bi] * (spreads[bi] + distanceSqr(centroids[bi], centroid)) + sizes[bj] * (spreads[bj] + distanceSqr(centroids[bj], centroid))) / total;
+		centroids[bi] = centroid;
+		sizes[bi] = total;
+		centroids.erase(centroids.begin() + bj);
+		sizes.erase(sizes.begin() + bj);
+		spreads.erase(spreads.begin() + bj);
+	}
+	std::sort(heights.begin(), heights.end());
+	return heights;
+}
+
+void collectHeights(BinaryTree<RealVector> const* tree, std::vector<double>& heights){
+	if(!tree->hasChildren()) return;
+	heights.push_back(static_cast<AgglomerativeTree const*>(tree)->height());
+	collectHeights(tree->left(), heights);
+	collectHeights(tree->right(), heights);
+}
+
+void checkBounds(BinaryTree<RealVector> const* tree, std::vector<RealVector> const& points){
+	for(std::size_t i = 0; i != tree->size(); ++i){
+		for(std::size_t j = 0; j != points.size(); ++j){
+			BOOST_CHECK_LE(tree->squaredDistanceLowerBound(points[j]), distanceSqr(points[j], points[tree->index(i)]) + 1.e-12);
+		}
+	}
+	if(tree->hasChildren()){
+		BOOST_CHECK_EQUAL(tree->size(), tree->left()->size() + tree->right()->size());
+		BOOST_CHECK_EQUAL(tree->nodes(), 1 + tree->left()->nodes() + tree->right()->nodes());
+		checkBounds(tree->left(), points);
+		checkBounds(tree->right(), points);
+	}
+}
+}
+
+BOOST_AUTO_TEST_SUITE (Models_HierarchicalClustering)
+
+BOOST_AUTO_TEST_CASE( AgglomerativeTree_Matches_Greedy_Merging ){
+	std::vector<RealVector> points(60, RealVector(3));
+	for(auto& point: points){
+		for(auto& x: point)
+			x = random::gauss(random::globalRng(), 0, 1);
+	}
+	Data<RealVector> data = createDataFromRange(points, 16);
+
+	AgglomerativeTree::Linkage linkages[] = {AgglomerativeTree::Ward, AgglomerativeTree::Average};
+	for(auto linkage: linkages){
+		AgglomerativeTree tree(data, linkage);
+		BOOST_CHECK_EQUAL(tree.size(), points.size());
+		BOOST_CHECK_EQUAL(tree.nodes(), 2 * points.size() - 1);
+
+		//every point appears exactly once
+		std::vector<std::size_t> indices(points.size());
+		for(std::size_t i = 0; i != points.size(); ++i)
+			indices[i] = tree.index(i);
+		std::sort(indices.begin(), indices.end());
+		for(std::size_t i = 0; i != points.size(); ++i)
+			BOOST_CHECK_EQUAL(indices[i], i);
+
+		std::vector<double> heights;
+		collectHeights(&tree, heights);
+		std::sort(heights.begin(), heights.end());
+		std::vector<double> expected = greedyHeights(points, linkage);
+		BOOST_REQUIRE_EQUAL(heights.size(), expected.size());
+		for(std::size_t i = 0; i != heights.size(); ++i)
+			BOOST_CHECK_CLOSE(heights[i], expected[i], 1.e-8);
+
+		checkBounds(&tree, points);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( HierarchicalClustering_Agglomerative_Clusters ){
+	//three well separated blobs of 30 points
+	std::vector<RealVector> points(90, RealVector(2));
+	for(std::size_t i = 0; i != points.size(); ++i){
+		points[i](0) = 100.0 * (i % 3) + random::uni(random::globalRng(), 0, 1);
+		points[i](1) = 50.0 * (i % 3 == 1) + random::uni(random::globalRng(), 0, 1);
+	}
+	Data<RealVector> data = createDataFromRange(points, 32);
+
+	AgglomerativeTree::Linkage linkages[] = {AgglomerativeTree::Ward, AgglomerativeTree::Average};
+	for(auto linkage: linkages){
+		AgglomerativeTree tree(data, linkage, TreeConstruction(0, 30));
+		HierarchicalClustering<RealVector> clustering(&tree);
+		BOOST_REQUIRE_EQUAL(clustering.numberOfClusters(), 3u);
+
+		std::vector<unsigned int> clusterOfBlob(3, 3);
+		for(auto const& batch: data){
+			UIntVector memberships = clustering.hardMembership(batch);
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				std::size_t blob = std::size_t(batch(i, 0) / 100.0);
+				if(clusterOfBlob[blob] == 3)
+					clusterOfBlob[blob] = memberships(i);
+				BOOST_CHECK_EQUAL(memberships(i), clusterOfBlob[blob]);
+			}
+		}
+		std::sort(clusterOfBlob.begin(), clusterOfBlob.end());
+		BOOST_CHECK_EQUAL(clusterOfBlob[0], 0u);
+		BOOST_CHECK_EQUAL(clusterOfBlob[1], 1u);
+		BOOST_CHECK_EQUAL(clusterOfBlob[2], 2u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( AgglomerativeTree_Parallel_Search ){
+	//enough points that the nearest neighbor searches are split into blocks
+	std::vector<RealVector> points(5000, RealVector(2));
+	for(auto& point: points){
+		for(auto& x: point)
+			x = random::uni(random::globalRng(), 0, 1);
+	}
+	Data<RealVector> data = createDataFromRange(points);
+	AgglomerativeTree tree(data, AgglomerativeTree::Ward);
+	BOOST_CHECK_EQUAL(tree.nodes(), 2 * points.size() - 1);
+	//the heights of a Ward hierarchy are monotonic along every path
+	std::vector<BinaryTree<RealVector> const*> stack(1, &tree);
+	while(!stack.empty()){
+		auto node = static_cast<AgglomerativeTree const*>(stack.back());
+		stack.pop_back();
+		if(!node->hasChildren()) continue;
+		for(auto child: {node->left(), node->right()}){
+			BOOST_CHECK_LE(static_cast<AgglomerativeTree const*>(child)->height(), node->height());
+			stack.push_back(child);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -40,6 +40,7 @@
 
 #include <shark/Algorithms/Trainers/RFTrainer.h>
 #include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
+#include <shark/ObjectiveFunctions/Loss/SquaredLoss.h>
 #include <shark/Data/DataDistribution.h>
 
 #include <sstream>
@@ -47,10 +48,18 @@
 
 using namespace shark;
 
+//the parallel code paths are only taken with more than one worker, independent of the machine
+//and of SHARK_NUM_THREADS. The pool must be created before the first test uses it.
+struct ThreadPoolFixture{
+	ThreadPoolFixture(){
+		threading::globalThreadPool(3);
+	}
+};
+BOOST_GLOBAL_FIXTURE(ThreadPoolFixture);
+
 BOOST_AUTO_TEST_SUITE (Models_RFClassifier)
 
 BOOST_AUTO_TEST_CASE( RF_Classifier ) {
-	threading::globalThreadPool(3);
 	random::globalRng().seed(45);
 	PamiToy generator(5,5,0,0.4);
 	auto train = generator.generateDataset(200);
@@ -109,4 +118,310 @@ BOOST_AUTO_TEST_CASE( RF_Classifier ) {
 	}
 }
 
+// With at most as many distinct feature values as bins, the histogram split search
+// checks the same partitions of the bootstrap as the exact search and grows the same trees.
+BOOST_AUTO_TEST_CASE( RF_Histogram_Split_Equivalence ) {
+	random::globalRng().seed(42);
+	PamiToy generator(5,5,0,0.4);
+	auto data = generator.generateDataset(1000);
+	blas::matrix<double, blas::column_major> inputs = createBatch<RealVector>(elements(data.inputs()));
+	UIntVector labels = createBatch<unsigned int>(elements(data.labels()));
+	//few distinct values per feature
+	for(std::size_t i = 0; i != inputs.size1(); ++i){
+		for(std::size_t j = 0; j != inputs.size2(); ++j){
+			inputs(i,j) = std::round(inputs(i,j) * 10) / 10;
+		}
+	}
+	RealVector weights(inputs.size1(), 1.0 / inputs.size1());
+	CART::BinnedData binned(inputs, 256, 1.e-10);
+	for(std::size_t j = 0; j != inputs.size2(); ++j){
+		BOOST_CHECK(binned.numberOfBins(j) < 100);
+	}
+
+	CART::TreeBuilder<unsigned int, CART::ClassificationCriterion> builder;
+	builder.m_min_samples_leaf = 1;
+	builder.m_min_split = 2;
+	builder.m_max_depth = 10000;
+	builder.m_min_impurity_split = 1.e-10;
+	builder.m_epsilon = 1.e-10;
+	builder.m_max_features = 3;
+	for(std::size_t t = 0; t != 10; ++t){
+		//build both trees from the same random state
+		std::mt19937 state = random::globalRng();
+		builder.m_binned = nullptr;
+		CART::Bootstrap<blas::matrix<double, blas::column_major>, UIntVector> exactBootstrap(random::globalRng(), inputs, labels, weights);
+		CARTree<unsigned int> exactTree = builder.buildTree(random::globalRng(), exactBootstrap);
+
+		static_cast<std::mt19937&>(random::globalRng()) = state;
+		builder.m_binned = &binned;
+		CART::Bootstrap<blas::matrix<double, blas::column_major>, UIntVector> histBootstrap(random::globalRng(), inputs, labels, weights);
+		CARTree<unsigned int> histTree = builder.buildTree(random::globalRng(), histBootstrap);
+
+		//thresholds may differ between the values of the data, thus only points of the bootstrap are compared
+		BOOST_REQUIRE_EQUAL(exactTree.numberOfNodes(), histTree.numberOfNodes());
+		for(std::size_t i: exactBootstrap.indices){
+			RealVector x = row(inputs, i);
+			BOOST_CHECK_EQUAL(exactTree.findLeaf(x), histTree.findLeaf(x));
+			BOOST_CHECK_EQUAL(exactTree(x), histTree(x));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE( RF_Classifier_Histogram ) {
+	random::globalRng().seed(45);
+	PamiToy generator(5,5,0,0.4);
+	auto train = generator.generateDataset(1000);
+	auto test = generator.generateDataset(1000);
+	RFTrainer<unsigned int> trainer(false,true);
+	trainer.setNumBins(16);
+	RFClassifier<unsigned int> model;
+	trainer.train(model, train);
+
+	ZeroOneLoss<> loss;
+	double error_train = loss.eval(train.labels(), model(train.inputs()));
+	double error_test = loss.eval(test.labels(), model(test.inputs()));
+	std::cout<<error_test<<" "<<model.OOBerror()<<std::endl;
+	BOOST_CHECK(error_train < 0.01);
+	BOOST_CHECK(error_test < 0.1);
+	BOOST_CHECK(model.OOBerror() < 0.15);
+}
+
+BOOST_AUTO_TEST_CASE( RF_Regression_Histogram ) {
+	random::globalRng().seed(13);
+	std::size_t ell = 1000;
+	std::vector<RealVector> inputs(ell, RealVector(3));
+	std::vector<RealVector> labels(ell, RealVector(1));
+	for(std::size_t i = 0; i != ell; ++i){
+		for(std::size_t j = 0; j != 3; ++j){
+			inputs[i](j) = random::uni(random::globalRng(), -2, 2);
+		}
+		labels[i](0) = std::sin(inputs[i](0)) + 0.5 * inputs[i](1) + 0.1 * random::gauss(random::globalRng());
+	}
+	auto data = createLabeledDataFromRange(inputs, labels);
+	auto train = splitAtElement(data, 500);
+	auto& test = data;
+
+	SquaredLoss<> loss;
+	RFTrainer<RealVector> exactTrainer;
+	RFClassifier<RealVector> exactModel;
+	exactTrainer.train(exactModel, train);
+	double exactError = loss.eval(test.labels(), exactModel(test.inputs()));
+
+	RFTrainer<RealVector> histTrainer;
+	histTrainer.setNumBins(32);
+	RFClassifier<RealVector> histModel;
+	histTrainer.train(histModel, train);
+	double histError = loss.eval(test.labels(), histModel(test.inputs()));
+
+	std::cout<<exactError<<" "<<histError<<std::endl;
+	BOOST_CHECK(histError < 0.05);
+	BOOST_CHECK(histError < 1.2 * exactError);
+}
+
+// The compiled forest must give the same results as evaluating the trees of the ensemble
+BOOST_AUTO_TEST_CASE( RF_Compiled_Evaluation ) {
+	random::globalRng().seed(7);
+	PamiToy generator(5,5,0,0.4);
+	auto train = generator.generateDataset(500);
+	auto test = generator.generateDataset(1000, 100);
+	RFTrainer<unsigned int> trainer;
+	trainer.setNTrees(20);
+	RFClassifier<unsigned int> model;
+	trainer.train(model, train);
+	BOOST_REQUIRE(model.isCompiled());
+
+	typedef RFClassifier<unsigned int>::NodeOrdering NodeOrdering;
+	for(NodeOrdering ordering: {NodeOrdering::DepthFirst, NodeOrdering::BreadthFirst}){
+		model.compile(ordering);
+		for(auto const& batch: test.inputs()){
+			UIntVector compiled = model(batch);
+			RealMatrix votes = model.decisionFunction()(batch);
+			BOOST_REQUIRE_EQUAL(compiled.size(), batch.size1());
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				BOOST_CHECK_EQUAL(compiled(i), arg_max(row(votes, i)));
+				//the trees of the ensemble
+				RealVector treeVotes(2, 0.0);
+				for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+					treeVotes(model.model(m)(RealVector(row(batch, i)))) += 1;
+				}
+				BOOST_CHECK_EQUAL(compiled(i), arg_max(treeVotes));
+			}
+		}
+	}
+	//adding a tree falls back to the ensemble until compiled again
+	model.addModel(model.model(0));
+	BOOST_CHECK(!model.isCompiled());
+	model.compile();
+	BOOST_CHECK(model.isCompiled());
+}
+
+BOOST_AUTO_TEST_CASE( RF_Compiled_Regression ) {
+	random::globalRng().seed(13);
+	std::size_t ell = 500;
+	std::vector<RealVector> inputs(ell, RealVector(3));
+	std::vector<RealVector> labels(ell, RealVector(2));
+	for(std::size_t i = 0; i != ell; ++i){
+		for(std::size_t j = 0; j != 3; ++j){
+			inputs[i](j) = random::uni(random::globalRng(), -2, 2);
+		}
+		labels[i](0) = std::sin(inputs[i](0)) + 0.1 * random::gauss(random::globalRng());
+		labels[i](1) = inputs[i](1) * inputs[i](2);
+	}
+	auto data = createLabeledDataFromRange(inputs, labels, 100);
+	RFTrainer<RealVector> trainer;
+	trainer.setNTrees(20);
+	RFClassifier<RealVector> model;
+	trainer.train(model, data);
+	BOOST_REQUIRE(model.isCompiled());
+	for(auto const& batch: data.inputs()){
+		RealMatrix compiled = model(batch);
+		RealMatrix mean(batch.size1(), 2, 0.0);
+		for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+			noalias(mean) += model.model(m)(batch) / model.numberOfModels();
+		}
+		BOOST_CHECK_SMALL(max(abs(compiled - mean)), 1.e-12);
+	}
+	
+	//weighted trees are pooled like in the Ensemble: sum of the weighted outputs divided by the sum of weights
+	for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+		model.weight(m) = 0.5 + m;
+	}
+	BOOST_REQUIRE(model.isCompiled());
+	for(auto const& batch: data.inputs()){
+		RealMatrix compiled = model(batch);
+		RealMatrix mean(batch.size1(), 2, 0.0);
+		for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+			noalias(mean) += model.weight(m) * model.model(m)(batch);
+		}
+		mean /= model.sumOfWeights();
+		BOOST_CHECK_SMALL(max(abs(compiled - mean)), 1.e-12);
+	}
+}
+
+//the forest only depends on the seed of the global rng, not on the number of threads
+//or whether the features of a node are evaluated in parallel
+BOOST_AUTO_TEST_CASE( RF_Deterministic_Training ) {
+	BOOST_REQUIRE_GT(threading::globalThreadPool().numWorkers(), 1);
+	random::globalRng().seed(11);
+	PamiToy generator(5,5,0,0.4);
+	auto train = generator.generateDataset(2000);
+	auto test = generator.generateDataset(500, 100);
+	
+	RFTrainer<unsigned int> trainer(false, true);
+	trainer.setNTrees(10);
+	RFClassifier<unsigned int> sequential;
+	random::globalRng().seed(42);
+	trainer.train(sequential, train);
+	
+	trainer.setMinParallelSamples(1);
+	RFClassifier<unsigned int> parallel;
+	random::globalRng().seed(42);
+	trainer.train(parallel, train);
+	
+	BOOST_REQUIRE_EQUAL(sequential.numberOfModels(), parallel.numberOfModels());
+	BOOST_CHECK_EQUAL(sequential.OOBerror(), parallel.OOBerror());
+	for(auto const& batch: test.inputs()){
+		RealMatrix votesSequential = sequential.decisionFunction()(batch);
+		RealMatrix votesParallel = parallel.decisionFunction()(batch);
+		BOOST_CHECK_EQUAL(max(abs(votesSequential - votesParallel)), 0.0);
+	}
+	for(std::size_t m = 0; m != sequential.numberOfModels(); ++m){
+		BOOST_CHECK_EQUAL(sequential.model(m).numberOfNodes(), parallel.model(m).numberOfNodes());
+	}
+}
+
+//binary features become constant in deep nodes. Constant features count towards the number of
+//features evaluated per node in both the sequential and the parallel split search
+BOOST_AUTO_TEST_CASE( RF_Deterministic_Training_Constant_Features ) {
+	BOOST_REQUIRE_GT(threading::globalThreadPool().numWorkers(), 1);
+	random::globalRng().seed(13);
+	LabeledData<RealVector, unsigned int> train(1000, {8, 2}, 100);
+	for(auto element: elements(train)){
+		for(std::size_t j = 0; j != 8; ++j)
+			element.input(j) = random::coinToss(random::globalRng());
+		element.label = (element.input(0) + element.input(1) + element.input(2) == 1.0);
+	}
+	
+	RFTrainer<unsigned int> trainer(false, false);
+	trainer.setNTrees(10);
+	trainer.setMTry(2);
+	RFClassifier<unsigned int> sequential;
+	random::globalRng().seed(42);
+	trainer.train(sequential, train);
+	
+	trainer.setMinParallelSamples(1);
+	RFClassifier<unsigned int> parallel;
+	random::globalRng().seed(42);
+	trainer.train(parallel, train);
+	
+	BOOST_REQUIRE_EQUAL(sequential.numberOfModels(), parallel.numberOfModels());
+	for(std::size_t m = 0; m != sequential.numberOfModels(); ++m){
+		BOOST_CHECK_EQUAL(sequential.model(m).numberOfNodes(), parallel.model(m).numberOfNodes());
+	}
+	for(auto const& batch: train.inputs()){
+		RealMatrix votesSequential = sequential.decisionFunction()(batch);
+		RealMatrix votesParallel = parallel.decisionFunction()(batch);
+		BOOST_CHECK_EQUAL(max(abs(votesSequential - votesParallel)), 0.0);
+	}
+}
+
+//the out-of-bag error is compared to the votes of the trees on the single out-of-bag points
+BOOST_AUTO_TEST_CASE( RF_OOB_Statistics ) {
+	random::globalRng().seed(23);
+	PamiToy generator(5,5,0,0.4);
+	auto train = generator.generateDataset(300, 50);
+	
+	std::vector<std::vector<std::size_t> > oobIndices;
+	RFClassifier<unsigned int> model;
+	{
+		RFTrainer<unsigned int> trainer;
+		trainer.setNTrees(30);
+		trainer.train(model, train);
+	}
+	//the statistics work with any subsets of the data
+	for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+		std::vector<std::size_t> indices;
+		for(std::size_t i = 0; i != train.numberOfElements(); ++i){
+			if(random::coinToss(random::globalRng(), 0.4))
+				indices.push_back(i);
+		}
+		oobIndices.push_back(indices);
+	}
+	model.computeOOBerror(oobIndices, train);
+	
+	UIntMatrix isOOB(model.numberOfModels(), train.numberOfElements(), 0);
+	for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+		for(auto index: oobIndices[m])
+			isOOB(m, index) = 1;
+	}
+	double OOBerror = 0;
+	std::size_t elem = 0;
+	for(auto const& point: elements(train)){
+		RealVector votes(2, 0.0);
+		for(std::size_t m = 0; m != model.numberOfModels(); ++m){
+			if(isOOB(m, elem))
+				votes(model.model(m)(RealVector(point.input))) += model.weight(m);
+		}
+		OOBerror += (arg_max(votes) != point.label);
+		++elem;
+	}
+	OOBerror /= train.numberOfElements();
+	BOOST_CHECK_CLOSE(model.OOBerror(), OOBerror, 1.e-10);
+	
+	//the importances only depend on the rng passed
+	random::globalRng().seed(3);
+	model.computeFeatureImportances(oobIndices, train, random::globalRng());
+	RealVector importances = model.featureImportances();
+	random::globalRng().seed(3);
+	model.computeFeatureImportances(oobIndices, train, random::globalRng());
+	BOOST_CHECK_EQUAL(max(abs(importances - model.featureImportances())), 0.0);
+	
+	//features no tree splits on are not important
+	UIntVector count = model.countAttributes();
+	for(std::size_t i = 0; i != count.size(); ++i){
+		if(count(i) == 0)
+			BOOST_CHECK_EQUAL(importances(i), 0.0);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()
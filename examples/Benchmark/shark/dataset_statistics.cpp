@@ -0,0 +1,59 @@
+#include <shark/Data/Statistics.h>
+#include <shark/Algorithms/Trainers/NormalizeComponentsUnitVariance.h>
+#include <shark/Algorithms/Trainers/NormalizeComponentsUnitInterval.h>
+#include <shark/Algorithms/Trainers/NormalizeComponentsWhitening.h>
+#include <shark/Algorithms/Trainers/PCA.h>
+#include <shark/Core/Timer.h>
+#include <cstdlib>
+#include <iostream>
+using namespace shark;
+using namespace std;
+
+//usage: Dataset_Statistics [points] [dimensions]
+//the default of 10^7 points with 100 dimensions needs 8GB of memory
+int main(int argc, char **argv) {
+	std::size_t numPoints = argc > 1? std::atol(argv[1]) : 10000000;
+	std::size_t dim = argc > 2? std::atol(argv[2]) : 100;
+
+	Data<RealVector> data(numPoints, {dim});
+	threading::parallelND({data.size()}, {1}, [&](std::size_t b){
+		data[b] = blas::normal(random::globalRng(), data[b].size1(), dim, 1.0, 2.0, blas::cpu_tag());
+	}, threading::globalThreadPool());
+
+	Timer time;
+	RealVector meanVec = mean(data);
+	cout << "mean: " << time.stop() << endl;
+
+	RealVector var;
+	time.start();
+	meanvar(data, meanVec, var);
+	cout << "meanvar: " << time.stop() << endl;
+
+	RealMatrix cov;
+	time.start();
+	meanvar(data, meanVec, cov);
+	cout << "covariance: " << time.stop() << endl;
+
+	Normalizer<> normalizer;
+	time.start();
+	NormalizeComponentsUnitVariance<> unitVariance(true);
+	unitVariance.train(normalizer, data);
+	cout << "NormalizeComponentsUnitVariance: " << time.stop() << endl;
+
+	time.start();
+	NormalizeComponentsUnitInterval<> unitInterval;
+	unitInterval.train(normalizer, data);
+	cout << "NormalizeComponentsUnitInterval: " << time.stop() << endl;
+
+	LinearModel<> whitening;
+	time.start();
+	NormalizeComponentsWhitening whiteningTrainer;
+	whiteningTrainer.train(whitening, data);
+	cout << "NormalizeComponentsWhitening: " << time.stop() << endl;
+
+	LinearModel<> encoder;
+	time.start();
+	PCA pca(data);
+	pca.encoder(encoder, dim / 2);
+	cout << "PCA: " << time.stop() << endl;
+}
@@ -0,0 +1,40 @@
+#include <shark/Data/SparseData.h>
+#include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
+#include <shark/Algorithms/Trainers/CSvmTrainer.h>
+
+#include <shark/Core/Timer.h>
+#include <iostream>
+#include <string>
+using namespace shark;
+using namespace std;
+
+// trains linear multi-class SVMs on a sparse dataset in libsvm format,
+// e.g. news20.scale from the libsvm dataset collection
+int main(int argc, char **argv) {
+	std::string file = (argc > 1) ? argv[1] : "news20.scale";
+	LabeledData<CompressedRealVector,unsigned int> data_sparse;
+	importSparseData(data_sparse, file, 0, 8192);
+	cout << "examples: " << data_sparse.numberOfElements()
+		<< " features: " << inputDimension(data_sparse)
+		<< " classes: " << numberOfClasses(data_sparse) << endl;
+
+	std::pair<std::string,McSvm> machines[3] = {
+		{"OVA", McSvm::OVA},
+		{"WW", McSvm::WW},
+		{"CS", McSvm::CS}
+	};
+	for(auto const& machine: machines){
+		for(double C = 0.1; C <= 10; C*=10){
+			LinearClassifier<CompressedRealVector> model;
+			LinearCSvmTrainer<CompressedRealVector> trainer(C,false);
+			trainer.setMcSvmType(machine.second);
+
+			Timer time;
+			trainer.train(model, data_sparse);
+			double time_taken = time.stop();
+
+			ZeroOneLoss<unsigned int> loss;
+			cout << machine.first << " " << C << "  " << time_taken << " " << loss(data_sparse.labels(),model(data_sparse.inputs())) << std::endl;
+		}
+	}
+}
@@ -0,0 +1,57 @@
+#include <shark/Data/DataDistribution.h>
+#include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
+#include <shark/Algorithms/Trainers/CSvmTrainer.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
+
+#include <shark/Core/Timer.h>
+#include <iostream>
+using namespace shark;
+using namespace std;
+
+// 20 gaussian clusters in 10 dimensions, one per class
+class Clusters : public LabeledDataDistribution<RealVector, unsigned int>
+{
+public:
+	Clusters(unsigned int classes, std::size_t dim)
+	: LabeledDataDistribution<RealVector, unsigned int>({dim,classes})
+	, m_centers(classes, dim){
+		for(std::size_t c = 0; c != classes; ++c)
+			for(std::size_t i = 0; i != dim; ++i)
+				m_centers(c, i) = random::uni(random::globalRng(), -3.0, 3.0);
+	}
+	void draw(reference point)const{
+		point.label = random::discrete(random::globalRng(), 0u, (unsigned int)m_centers.size1() - 1);
+		for(std::size_t i = 0; i != m_centers.size2(); ++i)
+			point.input(i) = m_centers(point.label, i) + random::gauss(random::globalRng());
+	}
+private:
+	RealMatrix m_centers;
+};
+
+// Times the multi-class SVMs solved by QpMcBoxDecomp and QpMcSimplexDecomp.
+// The decomposition steps run on the global thread pool; run with
+// SHARK_NUM_THREADS=1 to obtain the timings of the serial solvers.
+int main(int argc, char **argv) {
+	std::size_t ell = argc > 1 ? std::atoi(argv[1]) : 2000;
+	Clusters problem(20, 10);
+	LabeledData<RealVector,unsigned int> data = problem.generateDataset(ell);
+
+	std::pair<McSvm, char const*> machines[] = {
+		{McSvm::WW, "WW"}, {McSvm::CS, "CS"}, {McSvm::LLW, "LLW"},
+		{McSvm::ATM, "ATM"}, {McSvm::ATS, "ATS"}, {McSvm::ADM, "ADM"}, {McSvm::MMR, "MMR"}
+	};
+	GaussianRbfKernel<> kernel(0.05);
+	cout << "threads: " << threading::globalThreadPool().numWorkers() << std::endl;
+	for(auto const& machine: machines){
+		KernelClassifier<RealVector> model;
+		CSvmTrainer<RealVector> trainer(&kernel, 1.0, false);
+		trainer.setMcSvmType(machine.first);
+		
+		Timer time;
+		trainer.train(model, data);
+		double time_taken = time.stop();
+		
+		ZeroOneLoss<> loss;
+		cout << machine.second << "  " << time_taken << " " << loss(data.labels(), model(data.inputs())) << std::endl;
+	}
+}
@@ -1,7 +1,8 @@
 #include <shark/Data/SparseData.h>
 #include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
-#include <shark/Models/NearestNeighborClassifier.h>
+#include <shark/Models/NearestNeighborModel.h>
 #include <shark/Algorithms/NearestNeighbors/TreeNearestNeighbors.h>
+#include <shark/Algorithms/NearestNeighbors/DualTreeNearestNeighbors.h>
 #include <shark/Algorithms/NearestNeighbors/SimpleNearestNeighbors.h>
 #include <shark/Models/Trees/KDTree.h>
 #include <shark/Models/Kernels/LinearKernel.h>
@@ -21,7 +22,7 @@ int main(int argc, char **argv) {
 	//~ Timer time;
 	//~ KDTree<RealVector> kdtree(data.inputs());
 	//~ TreeNearestNeighbors<RealVector,unsigned int> algorithmKD(data,&kdtree);
-	//~ NearestNeighborClassifier<RealVector> model(&algorithmKD, 10);
+	//~ NearestNeighborModel<RealVector, unsigned int> model(&algorithmKD, 10);
 	//~ ZeroOneLoss<> loss;
 	//~ double error = loss(data.labels(),model(data.inputs()));
 	//~ double time_taken = time.stop();
@@ -29,11 +30,23 @@ int main(int argc, char **argv) {
 	//~ cout <<  "kdtree: "<< time_taken <<" "<< error<<std::endl;
 	//~ }
 	
+	{
+	Timer time;
+	KDTree<RealVector> kdtree(data.inputs(), TreeConstruction(0, 16));
+	DualTreeNearestNeighbors<unsigned int> dualTreeAlgorithm(data,&kdtree);
+	NearestNeighborModel<RealVector, unsigned int> model(&dualTreeAlgorithm, 10);
+	ZeroOneLoss<> loss;
+	double error = loss(data.labels(),model(data.inputs()));
+	double time_taken = time.stop();
+		
+	cout <<  "dual-tree: "<< time_taken <<" "<< error<<std::endl;
+	}
+	
 	{
 	Timer time;
 	LinearKernel<RealVector> euclideanKernel;
 	SimpleNearestNeighbors<RealVector,unsigned int> simpleAlgorithm(data,&euclideanKernel);
-	NearestNeighborClassifier<RealVector> model(&simpleAlgorithm, 10);
+	NearestNeighborModel<RealVector, unsigned int> model(&simpleAlgorithm, 10);
 	ZeroOneLoss<> loss;
 	double error = loss(data.labels(),model(data.inputs()));
 	double time_taken = time.stop();
@@ -45,7 +58,7 @@ int main(int argc, char **argv) {
 	Timer time;
 	LinearKernel<RealVector> euclideanKernel;
 	SimpleNearestNeighbors<RealVector,unsigned int> simpleAlgorithm(mnist,&euclideanKernel);
-	NearestNeighborClassifier<RealVector> model(&simpleAlgorithm, 10);
+	NearestNeighborModel<RealVector, unsigned int> model(&simpleAlgorithm, 10);
 	ZeroOneLoss<> loss;
 	double error = loss(mnist.labels(),model(mnist.inputs()));
 	double time_taken = time.stop();
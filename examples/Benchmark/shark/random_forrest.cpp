@@ -6,6 +6,7 @@
 #include <shark/Models/Kernels/GaussianRbfKernel.h>
 
 #include <shark/Core/Timer.h>
+#include <cstdlib>
 
 using namespace shark;
 using namespace std;
@@ -18,6 +19,9 @@ int main(int argc, char **argv) {
 
 	RFClassifier<unsigned int> model;
 	RFTrainer<unsigned int> trainer(true,true);
+	//optional: number of histogram bins, 0 uses the exact split search
+	if(argc > 1)
+		trainer.setNumBins(std::atoi(argv[1]));
 		
 	Timer time;
 	trainer.train(model, data);
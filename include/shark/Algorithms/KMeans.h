@@ -38,6 +38,7 @@
 
 #include <shark/Core/DLLSupport.h>
 #include <shark/Data/Dataset.h>
+#include <shark/Data/Generator.h>
 #include <shark/Models/Clustering/Centroids.h>
 #include <shark/Models/RBFLayer.h>
 #include <shark/Models/Kernels/KernelExpansion.h>
@@ -61,8 +62,16 @@ namespace shark{
 /// \par
 /// This implementation starts the search with the given centroids,
 /// in case the provided centroids object (third parameter) contains
-/// a set of k centroids. Otherwise the search starts from the first
-/// k data points.
+/// a set of k centroids. Otherwise the centroids are initialized
+/// by k-means++ seeding, see Centroids::initFromData.
+///
+/// \par
+/// The iterations use the triangle inequality to skip most distance
+/// computations between points and centroids, which gives the same result
+/// as the plain Lloyd iterations. For few clusters one lower bound per point
+/// is kept (Hamerly, 2010), for 20 and more clusters one lower bound per
+/// point and cluster (Elkan, 2003), unless these bounds need too much memory.
+/// The points are assigned and the new centroids are accumulated in parallel.
 ///
 /// \par
 /// Note that the data set needs to include at least k data points
@@ -104,6 +113,53 @@ SHARK_EXPORT_SYMBOL std::size_t kMeans(Data<RealVector> const& data, std::size_t
 ///
 SHARK_EXPORT_SYMBOL std::size_t kMeans(Data<RealVector> const& data, RBFLayer& model, std::size_t maxIterations = 0);
 
+///
+/// \brief Mini-batch k-means for data streams.
+///
+/// \par
+/// The data is drawn batch by batch from a generator, for example
+/// a generator created from a dataset via generator(data), or one reading
+/// from disk. Only a single batch is held in memory at a time, which allows
+/// clustering datasets that do not fit into memory.
+///
+/// \par
+/// Every point of a batch is assigned to its closest centroid, which is then
+/// moved towards the point with learning rate 1/n_i, where n_i is the number
+/// of points assigned to centroid i so far. Thus every centroid is the
+/// mean of all points assigned to it over time.
+/// The assignments of the points of a batch are computed in parallel.
+///
+/// \par
+/// In case the provided centroids object does not contain k centroids,
+/// the centroids are initialized by k-means++ seeding on the first
+/// batches of the generator, which must together contain at least k points.
+///
+/// \par
+/// See Sculley, D. Web-Scale K-Means Clustering.
+/// Proceedings of the 19th International Conference on World Wide Web, 2010.
+///
+/// \param generator      generator of the data to be clustered
+/// \param k              number of clusters
+/// \param centroids      centroids input/output
+/// \param numBatches     number of batches used for updating the centroids
+/// \return               number of points used for updating the centroids
+/// \ingroup clustering
+SHARK_EXPORT_SYMBOL std::size_t kMeans(Generator<RealVector> const& generator, std::size_t k, Centroids& centroids, std::size_t numBatches);
+
+///
+/// \brief Mini-batch k-means for initializing an RBF Layer from a data stream
+///
+/// \par
+/// Alternative frontend to the mini-batch k-means using Centroids. It clusters the data into as many clusters
+/// as the RBFLayer has outputs and copies the result into the centers of the model.
+///
+/// \param generator      generator of the data to be clustered
+/// \param model          RBFLayer input/output
+/// \param numBatches     number of batches used for updating the centers
+/// \return               number of points used for updating the centers
+///
+SHARK_EXPORT_SYMBOL std::size_t kMeans(Generator<RealVector> const& generator, RBFLayer& model, std::size_t numBatches);
+
 ///
 /// \brief The kernel k-means clustering algorithm
 ///
@@ -0,0 +1,216 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Nearest neighbor queries of whole batches by dual-tree traversal.
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_ALGORITHMS_NEARESTNEIGHBORS_DUALTREENEARESTNEIGHBORS_H
+#define SHARK_ALGORITHMS_NEARESTNEIGHBORS_DUALTREENEARESTNEIGHBORS_H
+
+#include <shark/Algorithms/NearestNeighbors/AbstractNearestNeighbors.h>
+#include <shark/Models/Trees/KDTree.h>
+#include <shark/Models/Trees/PackedTree.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <cmath>
+
+namespace shark {
+
+///\brief Nearest neighbors of whole batches of points using dual-tree traversal
+///
+/// Returns the labels and distances of the k nearest neighbors of the points of a batch
+/// with respect to the Euclidean distance.
+///
+/// \par
+/// Instead of searching the neighbors of every point on its own, a KDTree is built
+/// for the points of the batch and both trees are traversed together. Whenever the
+/// bounding box of a node of the reference tree is further away from the bounding box
+/// of a node of the batch tree than the k-th neighbor of every point in that node found
+/// so far, the pair of nodes is skipped. This shares the pruning work between nearby
+/// points, which pays off for large batches in low-dimensional spaces.
+/// The subtrees of the batch tree are processed in parallel.
+///
+/// \par
+/// The reference points can be organized by any BinaryTree using the Euclidean distance,
+/// i.e., trees without kernel, for example a KDTree or LCTree. Leaves may hold more than one
+/// point. The tree is copied into a PackedTree on construction, afterwards it is not needed anymore.
+///
+/// \par
+/// The algorithm follows
+/// Gray, A. G., and Moore, A. W. 'N-Body' problems in statistical learning.
+/// Advances in Neural Information Processing Systems 13, 2001.
+template<class LabelType>
+class DualTreeNearestNeighbors:public AbstractNearestNeighbors<RealVector,LabelType>
+{
+private:
+	typedef AbstractNearestNeighbors<RealVector,LabelType> base_type;
+	typedef KeyValuePair<double,std::size_t> Candidate;
+
+public:
+	typedef LabeledData<RealVector, LabelType> Dataset;
+	typedef BinaryTree<RealVector> Tree;
+	typedef typename base_type::DistancePair DistancePair;
+	typedef typename base_type::BatchInputType BatchInputType;
+
+	/// \brief Constructor.
+	///
+	/// \param dataset          the reference points and their labels
+	/// \param tree             space partitioning tree of the inputs of the dataset, must not use a kernel
+	/// \param queryBucketSize  maximum number of points in the leaves of the trees built for the batches
+	DualTreeNearestNeighbors(Dataset const& dataset, Tree const* tree, std::size_t queryBucketSize = 16)
+	: m_dataset(dataset)
+	, m_labels(dataset.labels())
+	, m_reference(tree, dataset.inputs())
+	, m_queryBucketSize(queryBucketSize)
+	{
+		SHARK_RUNTIME_CHECK(tree->kernel() == NULL, "The tree must use the Euclidean distance");
+		SHARK_RUNTIME_CHECK(tree->size() == dataset.numberOfElements(), "The tree must hold the points of the dataset");
+		this->m_inputShape = dataset.shape().input;
+	}
+
+	///\brief Returns the k nearest neighbors of the points of the batch
+	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k)const{
+		std::size_t numPoints = patterns.size1();
+		SHARK_RUNTIME_CHECK(k <= m_dataset.numberOfElements(), "Not enough points for the requested number of neighbors");
+		std::vector<DistancePair> results(k*numPoints);
+		if(numPoints == 0 || k == 0)
+			return results;
+
+		//organize the queries in a tree
+		Data<RealVector> queryData;
+		queryData.push_back(patterns);
+		KDTree<RealVector> kdtree(queryData, TreeConstruction(0, (unsigned int)m_queryBucketSize));
+		PackedTree queries(&kdtree, queryData);
+
+		//one max-heap of candidates for every row of the query tree
+		std::vector<Candidate> heaps(k * numPoints, Candidate(std::numeric_limits<double>::max(), 0));
+		//distance of the k-th candidate of all points of a query node, maximized over the points
+		std::vector<double> bounds(queries.numberOfNodes(), std::numeric_limits<double>::max());
+
+		//split the query tree in independent subtrees for the threads
+		std::deque<std::size_t> subtrees(1, 0);
+		std::size_t numTasks = 4 * threading::globalThreadPool().numWorkers();
+		while(subtrees.size() < numTasks && !queries.isLeaf(subtrees.front())){
+			std::size_t node = subtrees.front();
+			subtrees.pop_front();
+			subtrees.push_back(queries.left(node));
+			subtrees.push_back(queries.right(node));
+		}
+		auto processSubtree = [&](std::size_t t){
+			traverse(queries, subtrees[t], 0, k, heaps, bounds);
+		};
+		threading::parallelND({subtrees.size()}, {1}, processSubtree, threading::globalThreadPool());
+
+		//sort the candidates of every point and look up the labels
+		for(std::size_t r = 0; r != numPoints; ++r){
+			auto heapStart = heaps.begin() + r * k;
+			std::sort_heap(heapStart, heapStart + k);
+			std::size_t p = queries.pointIndex(r);
+			for(std::size_t i = 0; i != k; ++i){
+				results[p * k + i].key = std::sqrt(heapStart[i].key);
+				results[p * k + i].value = m_labels[m_reference.pointIndex(heapStart[i].value)];
+			}
+		}
+		return results;
+	}
+
+	LabeledData<RealVector,LabelType>const& dataset()const {
+		return m_dataset;
+	}
+
+private:
+	/// \brief Finds the neighbors of the points of query node q among the points of reference node r.
+	void traverse(
+		PackedTree const& queries, std::size_t q, std::size_t r, std::size_t k,
+		std::vector<Candidate>& heaps, std::vector<double>& bounds
+	)const{
+		if(queries.squaredDistanceLowerBound(q, m_reference, r) > bounds[q])
+			return;
+
+		if(queries.isLeaf(q) && m_reference.isLeaf(r)){
+			compareLeaves(queries, q, r, k, heaps, bounds);
+		}else if(queries.isLeaf(q) || (!m_reference.isLeaf(r) && m_reference.size(r) >= queries.size(q))){
+			//descend into the closer child of the reference node first
+			std::size_t first = m_reference.left(r);
+			std::size_t second = m_reference.right(r);
+			if(queries.squaredDistanceLowerBound(q, m_reference, second) < queries.squaredDistanceLowerBound(q, m_reference, first))
+				std::swap(first, second);
+			traverse(queries, q, first, k, heaps, bounds);
+			traverse(queries, q, second, k, heaps, bounds);
+		}else{
+			traverse(queries, queries.left(q), r, k, heaps, bounds);
+			traverse(queries, queries.right(q), r, k, heaps, bounds);
+			bounds[q] = std::max(bounds[queries.left(q)], bounds[queries.right(q)]);
+		}
+	}
+
+	/// \brief Computes the distances between the points of two leaves and updates the candidates.
+	void compareLeaves(
+		PackedTree const& queries, std::size_t q, std::size_t r, std::size_t k,
+		std::vector<Candidate>& heaps, std::vector<double>& bounds
+	)const{
+		PackedTree::Node const& query = queries.node(q);
+		PackedTree::Node const& reference = m_reference.node(r);
+		std::size_t dim = queries.points().size2();
+		double bound = 0.0;
+		for(std::size_t i = query.begin; i != query.end; ++i){
+			double const* x = &queries.points()(i, 0);
+			auto heapStart = heaps.begin() + i * k;
+			auto heapEnd = heapStart + k;
+			for(std::size_t j = reference.begin; j != reference.end; ++j){
+				double const* y = &m_reference.points()(j, 0);
+				double dist = 0.0;
+				for(std::size_t d = 0; d != dim; ++d){
+					dist += (x[d] - y[d]) * (x[d] - y[d]);
+				}
+				if(dist < heapStart->key){
+					//replace the furthest candidate
+					std::pop_heap(heapStart, heapEnd);
+					heapEnd[-1] = Candidate(dist, j);
+					std::push_heap(heapStart, heapEnd);
+				}
+			}
+			bound = std::max(bound, heapStart->key);
+		}
+		bounds[q] = bound;
+	}
+
+	Dataset m_dataset;
+	DataView<Data<LabelType> const> m_labels;
+	PackedTree m_reference;///< packed copy of the reference tree
+	std::size_t m_queryBucketSize;
+};
+
+
+}
+#endif
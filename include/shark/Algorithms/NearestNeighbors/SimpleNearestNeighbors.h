@@ -37,8 +37,12 @@
 
 #include <shark/Algorithms/NearestNeighbors/AbstractNearestNeighbors.h>
 #include <shark/Models/Kernels/AbstractMetric.h>
+#include <shark/Models/Kernels/LinearKernel.h>
+#include <shark/Models/Kernels/GaussianRbfKernel.h>
+#include <shark/Data/DataView.h>
 #include <shark/Core/Threading/Algorithms.h>
 #include <algorithm>
+#include <cmath>
 
 
 namespace shark {
@@ -47,6 +51,14 @@ namespace shark {
 ///
 ///Returns the labels and distances of the k nearest neighbors of a point 
 /// The distance is measured using an arbitrary metric
+///
+/// For dense inputs with the Euclidean metric, given by a LinearKernel, or the metric
+/// of a GaussianRbfKernel, which orders the points in the same way, a specialized
+/// search is used. The queries are split into blocks which are processed in parallel.
+/// For every block, the distances to one batch of the dataset after the other are
+/// computed with a single matrix-matrix product using ||x-y||^2 = ||x||^2 - 2 x^Ty + ||y||^2.
+/// The distances of a query are filtered against the distance of its k-th candidate
+/// found so far and only the few remaining ones are collected and partially sorted.
 template<class InputType, class LabelType>
 class SimpleNearestNeighbors:public AbstractNearestNeighbors<InputType,LabelType>{
 private:
@@ -70,6 +82,10 @@ public:
 
 	///\brief Return the k nearest neighbors of the query point.
 	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k)const{
+		std::vector<DistancePair> results;
+		if(euclideanNeighbors(patterns, k, results))
+			return results;
+		
 		std::size_t numPatterns = batchSize(patterns);
 		std::size_t numBatches = m_dataset.size();
 		std::size_t maxThreads = std::min(threading::globalThreadPool().numWorkers(),numBatches);
@@ -125,7 +141,7 @@ public:
 		threading::parallelND({maxThreads}, {1}, updateHeap,  threading::globalThreadPool());
 		
 		
-		std::vector<DistancePair> results(k*numPatterns);
+		results.resize(k*numPatterns);
 		//finally, we merge all threads in one heap which has the inverse ordering
 		//and create a class histogram over the smallest k neighbors
 		for(std::size_t p = 0; p < numPatterns; ++p){
@@ -154,6 +170,104 @@ public:
 	}
 
 private:
+	/// number of queries processed together by the Euclidean search
+	static const std::size_t queryBlockSize = 64;
+	
+	/// \brief The specialized search for the Euclidean and Gaussian metric, only available for dense inputs.
+	///
+	/// Returns false if the metric is not supported.
+	bool euclideanNeighbors(RealMatrix const& patterns, std::size_t k, std::vector<DistancePair>& results)const{
+		//the Gaussian kernel distance 2-2exp(-gamma d^2) is monotonic in the Euclidean distance d
+		double gamma = 0.0;
+		if(auto gaussian = dynamic_cast<GaussianRbfKernel<RealVector> const*>(mep_metric))
+			gamma = gaussian->gamma();
+		else if(!dynamic_cast<LinearKernel<RealVector> const*>(mep_metric))
+			return false;
+		
+		std::size_t numPatterns = patterns.size1();
+		std::size_t numBatches = m_dataset.size();
+		if(k == 0 || numPatterns == 0)
+			return true;
+		//squared norms of the points and index of the first element of every batch
+		std::vector<RealVector> batchNorms(numBatches);
+		std::vector<std::size_t> batchStart(numBatches + 1, 0);
+		for(std::size_t b = 0; b != numBatches; ++b){
+			batchStart[b + 1] = batchStart[b] + batchSize(m_dataset[b].input);
+		}
+		auto computeNorms = [&](std::size_t b){
+			auto const& batch = m_dataset[b].input;
+			batchNorms[b].resize(batch.size1());
+			for(std::size_t i = 0; i != batch.size1(); ++i)
+				batchNorms[b](i) = norm_sqr(row(batch, i));
+		};
+		threading::parallelND({numBatches}, {1}, computeNorms, threading::globalThreadPool());
+		
+		typedef KeyValuePair<double, std::size_t> Candidate;
+		std::vector<Candidate> neighbors(k * numPatterns, Candidate(std::numeric_limits<double>::max(), 0));
+		std::size_t blockSize = std::min<std::size_t>(queryBlockSize, (numPatterns + threading::globalThreadPool().numWorkers() - 1) / threading::globalThreadPool().numWorkers());
+		blockSize = std::max<std::size_t>(blockSize, 1);
+		std::size_t numBlocks = (numPatterns + blockSize - 1) / blockSize;
+		auto searchBlock = [&](std::size_t block){
+			std::size_t start = block * blockSize;
+			std::size_t end = std::min(start + blockSize, numPatterns);
+			auto queries = rows(patterns, start, end);
+			RealVector queryNorms(end - start);
+			for(std::size_t p = 0; p != end - start; ++p)
+				queryNorms(p) = norm_sqr(row(queries, p));
+			//candidates of every query, points further away than the threshold can not be among the neighbors
+			std::vector<std::vector<Candidate> > candidates(end - start);
+			std::vector<double> thresholds(end - start, std::numeric_limits<double>::max());
+			for(auto& c: candidates)
+				c.reserve(2 * k);
+			RealMatrix products;
+			for(std::size_t b = 0; b != numBatches; ++b){
+				auto const& batch = m_dataset[b].input;
+				products.resize(end - start, batch.size1());
+				noalias(products) = prod(queries, trans(batch));
+				double const* norms = batchNorms[b].raw_storage().values;
+				for(std::size_t p = 0; p != end - start; ++p){
+					double const* product = &products(p, 0);
+					double threshold = thresholds[p];
+					for(std::size_t i = 0; i != batch.size1(); ++i){
+						double dist = queryNorms(p) - 2 * product[i] + norms[i];
+						if(dist < threshold){
+							candidates[p].push_back(Candidate(std::max(dist, 0.0), batchStart[b] + i));
+							//keep the k best candidates once there are enough
+							if(candidates[p].size() == 2 * k){
+								std::nth_element(candidates[p].begin(), candidates[p].begin() + k - 1, candidates[p].end());
+								candidates[p].resize(k);
+								threshold = candidates[p][k - 1].key;
+							}
+						}
+					}
+					thresholds[p] = threshold;
+				}
+			}
+			for(std::size_t p = 0; p != end - start; ++p){
+				std::size_t numNeighbors = std::min(k, candidates[p].size());
+				std::partial_sort(candidates[p].begin(), candidates[p].begin() + numNeighbors, candidates[p].end());
+				std::copy(candidates[p].begin(), candidates[p].begin() + numNeighbors, neighbors.begin() + (start + p) * k);
+			}
+		};
+		threading::parallelND({numBlocks}, {1}, searchBlock, threading::globalThreadPool());
+		
+		DataView<Data<LabelType> const> labels(m_dataset.labels());
+		results.resize(k * numPatterns, DistancePair(std::numeric_limits<double>::max(), LabelType()));
+		for(std::size_t i = 0; i != k * numPatterns; ++i){
+			if(neighbors[i].key == std::numeric_limits<double>::max())
+				continue;
+			double dist = neighbors[i].key;
+			results[i].key = gamma > 0 ? 2.0 - 2.0 * std::exp(-gamma * dist) : dist;
+			results[i].value = labels[neighbors[i].value];
+		}
+		return true;
+	}
+	/// \brief Other inputs always use the general search.
+	template<class Batch>
+	bool euclideanNeighbors(Batch const&, std::size_t, std::vector<DistancePair>&)const{
+		return false;
+	}
+	
 	Dataset m_dataset;                        ///< data set of nearest neighbor points
 	Metric const* mep_metric;                 ///< metric for measuring distances, usually given by a kernel function
 };
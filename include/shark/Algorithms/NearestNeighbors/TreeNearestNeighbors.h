@@ -40,6 +40,7 @@
 #include <shark/Models/Trees/BinaryTree.h>
 #include <shark/Algorithms/NearestNeighbors/AbstractNearestNeighbors.h>
 #include <shark/Data/DataView.h>
+#include <shark/Core/Threading/Algorithms.h>
 namespace shark {
 
 
@@ -426,10 +427,12 @@ public:
 	}
 
 	///\brief returns the k nearest neighbors of the point
+	///
+	/// The queries of the points are independent and are answered in parallel.
 	std::vector<DistancePair> getNeighbors(BatchInputType const& patterns, std::size_t k)const{
 		std::size_t numPoints = batchSize(patterns);
 		std::vector<DistancePair> results(k*numPoints);
-		for(std::size_t p = 0; p != numPoints; ++p){
+		auto answerQuery = [&](std::size_t p){
 			IterativeNNQuery<DataView<Data<InputType> const> > query(mep_tree, m_inputs, row(patterns, p));
 			//find the neighbors using the queries
 			for(std::size_t i = 0; i != k; ++i){
@@ -437,7 +440,8 @@ public:
 				results[i+p*k].key=result.first;
 				results[i+p*k].value= m_labels[result.second]; 
 			}
-		}
+		};
+		threading::parallelND({numPoints}, {16}, answerQuery, threading::globalThreadPool());
 		return results;
 	}
 
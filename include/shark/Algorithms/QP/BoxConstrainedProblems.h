@@ -345,6 +345,19 @@ public:
 		std::swap( m_alphaStatus[i], m_alphaStatus[j]);
 	}
 	
+	/// \brief Scales all box constraints by a constant factor and adapts the solution using a separate scaling
+	void scaleBoxConstraints(double factor, double variableScalingFactor){
+		m_problem.scaleBoxConstraints(factor,variableScalingFactor);
+		for(std::size_t i = 0; i != this->dimensions(); ++i){
+			//don't change deactivated variables
+			if(m_alphaStatus[i] == AlphaDeactivated) continue;
+			m_gradient(i) -= linear(i);
+			m_gradient(i) *= variableScalingFactor;
+			m_gradient(i) += linear(i);
+			updateAlphaStatus(i);
+		}
+	}
+	
 	/// \brief adapts the linear part of the problem and updates the internal data structures accordingly.
 	virtual void setLinear(std::size_t i, double newValue){
 		m_gradient(i) -= linear(i);
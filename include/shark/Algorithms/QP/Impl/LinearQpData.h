@@ -0,0 +1,207 @@
+/*!
+ *
+ *
+ * \brief       Access to the training examples of the linear SVM solvers
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_ALGORITHMS_QP_IMPL_LINEARQPDATA_H
+#define SHARK_ALGORITHMS_QP_IMPL_LINEARQPDATA_H
+
+#include <shark/Data/Dataset.h>
+#include <shark/Data/DataView.h>
+#include <shark/LinAlg/Base.h>
+#include <vector>
+
+namespace shark{ namespace detail{
+
+/// \brief Training examples of the linear SVM solvers QpBoxLinear and QpMcLinear.
+///
+/// The solvers touch a single example per step and only need its label,
+/// its squared norm and the products with the weight vectors. This class
+/// provides these operations by index. The general version accesses the
+/// examples through a DataView on the dataset.
+template<class InputT>
+class LinearQpData{
+public:
+	typedef LabeledData<InputT, unsigned int> DatasetType;
+
+	LinearQpData(DatasetType const& dataset)
+	: m_data(dataset)
+	, m_xSquared(m_data.size()){
+		for(std::size_t i = 0; i != m_data.size(); ++i){
+			m_xSquared(i) = norm_sqr(m_data[i].input);
+		}
+	}
+
+	/// \brief Number of examples.
+	std::size_t size() const{
+		return m_data.size();
+	}
+
+	/// \brief Label of example i.
+	unsigned int label(std::size_t i) const{
+		return m_data[i].label;
+	}
+
+	/// \brief Squared norm of example i.
+	double squaredNorm(std::size_t i) const{
+		return m_xSquared(i);
+	}
+
+	/// \brief Returns <w, x_i>.
+	double inner(RealVector const& w, std::size_t i) const{
+		return inner_prod(w, m_data[i].input);
+	}
+
+	/// \brief Performs w += factor * x_i.
+	void addScaled(RealVector& w, double factor, std::size_t i) const{
+		noalias(w) += factor * m_data[i].input;
+	}
+
+	/// \brief Computes wx(c) = <w_c, x_i> for all rows w_c of w.
+	void prod(RealMatrix const& w, std::size_t i, RealVector& wx) const{
+		noalias(wx) = blas::prod(w, m_data[i].input);
+	}
+
+	/// \brief Performs w_c += mu(c) * x_i for all rows w_c of w.
+	void addScaled(RealMatrix& w, RealVector const& mu, std::size_t i) const{
+		auto x_i = m_data[i].input;
+		for(std::size_t c = 0; c != w.size1(); ++c){
+			noalias(row(w, c)) += mu(c) * x_i;
+		}
+	}
+
+private:
+	DataView<const DatasetType> m_data;  ///< view on training data
+	RealVector m_xSquared;               ///< squared norms of the examples
+};
+
+/// \brief Sparse examples are copied into a single compressed row storage.
+///
+/// The solvers visit the examples in random order, one at a time. Accessing
+/// a row of a compressed_matrix batch through the DataView and the generic
+/// sparse kernels costs more than the few multiplications the step needs,
+/// therefore the nonzeros of all examples are stored consecutively and the
+/// products are computed by plain loops over them.
+template<>
+class LinearQpData<CompressedRealVector>{
+public:
+	typedef LabeledData<CompressedRealVector, unsigned int> DatasetType;
+
+	LinearQpData(DatasetType const& dataset){
+		std::size_t ell = dataset.numberOfElements();
+		std::size_t nnz = 0;
+		for(std::size_t b = 0; b != dataset.size(); ++b){
+			auto const& batch = dataset.inputs()[b];
+			for(std::size_t k = 0; k != batch.size1(); ++k)
+				nnz += batch.major_nnz(k);
+		}
+		m_start.reserve(ell + 1);
+		m_indices.reserve(nnz);
+		m_values.reserve(nnz);
+		m_labels.reserve(ell);
+		m_xSquared.resize(ell);
+		m_start.push_back(0);
+		for(std::size_t b = 0; b != dataset.size(); ++b){
+			auto const& batch = dataset.inputs()[b];
+			auto const& labels = dataset.labels()[b];
+			auto storage = batch.raw_storage();
+			for(std::size_t k = 0; k != batch.size1(); ++k){
+				double norm = 0.0;
+				for(std::size_t pos = storage.major_indices_begin[k]; pos != storage.major_indices_end[k]; ++pos){
+					double v = storage.values[pos];
+					m_indices.push_back(storage.indices[pos]);
+					m_values.push_back(v);
+					norm += v * v;
+				}
+				m_xSquared(m_labels.size()) = norm;
+				m_labels.push_back(labels(k));
+				m_start.push_back(m_indices.size());
+			}
+		}
+	}
+
+	/// \brief Number of examples.
+	std::size_t size() const{
+		return m_labels.size();
+	}
+
+	/// \brief Label of example i.
+	unsigned int label(std::size_t i) const{
+		return m_labels[i];
+	}
+
+	/// \brief Squared norm of example i.
+	double squaredNorm(std::size_t i) const{
+		return m_xSquared(i);
+	}
+
+	/// \brief Returns <w, x_i>.
+	double inner(RealVector const& w, std::size_t i) const{
+		double ret = 0.0;
+		for(std::size_t k = m_start[i]; k != m_start[i + 1]; ++k)
+			ret += w(m_indices[k]) * m_values[k];
+		return ret;
+	}
+
+	/// \brief Performs w += factor * x_i.
+	void addScaled(RealVector& w, double factor, std::size_t i) const{
+		for(std::size_t k = m_start[i]; k != m_start[i + 1]; ++k)
+			w(m_indices[k]) += factor * m_values[k];
+	}
+
+	/// \brief Computes wx(c) = <w_c, x_i> for all rows w_c of w.
+	void prod(RealMatrix const& w, std::size_t i, RealVector& wx) const{
+		for(std::size_t c = 0; c != w.size1(); ++c){
+			double ret = 0.0;
+			for(std::size_t k = m_start[i]; k != m_start[i + 1]; ++k)
+				ret += w(c, m_indices[k]) * m_values[k];
+			wx(c) = ret;
+		}
+	}
+
+	/// \brief Performs w_c += mu(c) * x_i for all rows w_c of w.
+	void addScaled(RealMatrix& w, RealVector const& mu, std::size_t i) const{
+		for(std::size_t c = 0; c != w.size1(); ++c){
+			double factor = mu(c);
+			if(factor == 0.0) continue;
+			for(std::size_t k = m_start[i]; k != m_start[i + 1]; ++k)
+				w(c, m_indices[k]) += factor * m_values[k];
+		}
+	}
+
+private:
+	std::vector<std::size_t> m_start;    ///< position of the first nonzero of every example, plus the end
+	std::vector<std::size_t> m_indices;  ///< feature indices of the nonzeros
+	std::vector<double> m_values;        ///< values of the nonzeros
+	std::vector<unsigned int> m_labels;  ///< labels of the examples
+	RealVector m_xSquared;               ///< squared norms of the examples
+};
+
+}}
+#endif
@@ -0,0 +1,68 @@
+/*!
+ * 
+ *
+ * \brief       Parallel loops over the examples of decomposition solvers
+ * 
+ * 
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ * 
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ * 
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_ALGORITHMS_QP_IMPL_PARALLELBLOCKS_H
+#define SHARK_ALGORITHMS_QP_IMPL_PARALLELBLOCKS_H
+
+#include <shark/Core/Threading/Algorithms.h>
+#include <algorithm> //for std::min
+
+namespace shark{ namespace detail{
+
+/// \brief Number of blocks a loop over n elements is split into by parallelBlocks.
+///
+/// A single decomposition step is cheap, thus the loop is only split if every block
+/// performs a reasonable amount of work. workPerElement is the number of variables
+/// touched per element, e.g. the number of variables of an example.
+inline std::size_t parallelBlockCount(std::size_t n, std::size_t workPerElement){
+	std::size_t const minBlockWork = 4096;
+	std::size_t threads = threading::globalThreadPool().numWorkers();
+	std::size_t blocks = n * std::max<std::size_t>(workPerElement, 1) / minBlockWork;
+	return std::max<std::size_t>(std::min(blocks, threads), 1);
+}
+
+/// \brief Calls f(block, start, end) for the given number of consecutive blocks covering {0,...,n-1}.
+///
+/// With more than one block, the blocks are processed in parallel on the global thread pool.
+template<class Functor>
+void parallelBlocks(std::size_t n, std::size_t blocks, Functor f){
+	if(blocks <= 1){
+		f(0, 0, n);
+		return;
+	}
+	auto task = [&](std::size_t block){
+		f(block, block * n / blocks, (block + 1) * n / blocks);
+	};
+	threading::parallelND({blocks}, {1}, task, threading::globalThreadPool());
+}
+
+}}
+#endif
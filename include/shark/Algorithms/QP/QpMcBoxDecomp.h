@@ -40,6 +40,7 @@
 #include <shark/Algorithms/QP/QpSolver.h>
 #include <shark/Algorithms/QP/QpSparseArray.h>
 #include <shark/Algorithms/QP/Impl/AnalyticProblems.h>
+#include <shark/Algorithms/QP/Impl/ParallelBlocks.h>
 #include <shark/Core/Timer.h>
 #include <shark/Data/Dataset.h>
 
@@ -264,8 +265,7 @@ public:
 			mu_v += m_alpha(v);
 			mu_w += m_alpha(w);
 			
-			gradientUpdate(rv, mu_v, qv);
-			gradientUpdate(rw, mu_w, qw);
+			gradientUpdate(rv, mu_v, qv, rw, mu_w, qw);
 		}
 	}
 	
@@ -336,6 +336,8 @@ public:
 
 		// compute the inactive m_gradient components (quadratic time complexity)
 		subrange(m_gradient, m_activeVar, m_numVariables) = subrange(m_linear, m_activeVar, m_numVariables);
+		std::vector<QpFloatType> q(m_numExamples);
+		std::size_t blocks = detail::parallelBlockCount(m_numExamples, m_cardP);
 		for (std::size_t v = 0; v != m_numVariables; v++)
 		{
 			double mu = m_alpha(v);
@@ -345,32 +347,34 @@ public:
 			unsigned int pv = m_variables[v].p;
 			unsigned int yv = m_examples[iv].y;
 			std::size_t r = m_cardP * yv + pv;
-			std::vector<QpFloatType> q(m_numExamples);
 			m_kernelMatrix.row(iv, 0, m_numExamples, &q[0]);
 
-			for (std::size_t a = 0; a != m_numExamples; a++)
-			{
-				double k = q[a];
-				Example& ex = m_examples[a];
-				typename QpSparseArray<QpFloatType>::Row const& row = m_M.row(m_classes * r + ex.y);
-				QpFloatType def = row.defaultvalue;
-				for (std::size_t b=0; b<row.size; b++)
-				{
-					std::size_t f = ex.var[row.entry[b].index];
-					if (f >= m_activeVar) 
-						m_gradient(f) -= mu * (row.entry[b].value - def) * k;
-				}
-				if (def != 0.0)
+			//every example only updates its own variables
+			detail::parallelBlocks(m_numExamples, blocks, [&](std::size_t, std::size_t start, std::size_t end){
+				for (std::size_t a = start; a != end; a++)
 				{
-					double upd = mu * def * k;
-					for (std::size_t  b=ex.active; b<m_cardP; b++)
+					double k = q[a];
+					Example& ex = m_examples[a];
+					typename QpSparseArray<QpFloatType>::Row const& row = m_M.row(m_classes * r + ex.y);
+					QpFloatType def = row.defaultvalue;
+					for (std::size_t b=0; b<row.size; b++)
 					{
-						std::size_t f = ex.avar[b];
-						SHARK_ASSERT(f >= m_activeVar);
-						m_gradient(f) -= upd;
+						std::size_t f = ex.var[row.entry[b].index];
+						if (f >= m_activeVar) 
+							m_gradient(f) -= mu * (row.entry[b].value - def) * k;
+					}
+					if (def != 0.0)
+					{
+						double upd = mu * def * k;
+						for (std::size_t  b=ex.active; b<m_cardP; b++)
+						{
+							std::size_t f = ex.avar[b];
+							SHARK_ASSERT(f >= m_activeVar);
+							m_gradient(f) -= upd;
+						}
 					}
 				}
-			}
+			});
 		}
 
 		for (std::size_t  i=0; i<m_numExamples; i++) 
@@ -421,42 +425,57 @@ public:
 		double gi = m_gradient(i);
 		QpFloatType* k = m_kernelMatrix.row(ii, 0, m_activeEx);
 		
-		j = i;
-		double bestgain = gi * gi / di;
-		
-		for (std::size_t a=0; a<m_activeEx; a++)
-		{
-			Example const& exa = m_examples[a];
-			unsigned int ya = exa.y;
-			typename QpSparseArray<QpFloatType>::Row const& row = m_M.row(m_classes * (yi * m_cardP + pi) + ya);
-			QpFloatType def = row.defaultvalue;
-			
-			for (std::size_t pf=0, b=0; pf < m_cardP; pf++)
+		//search the examples in blocks, every block finds its best partner for i.
+		//the results are combined in order, thus the first best variable is chosen as in a serial search
+		std::size_t blocks = detail::parallelBlockCount(m_activeEx, m_cardP);
+		std::vector<std::pair<double, std::size_t> > best(blocks, std::make_pair(gi * gi / di, i));
+		detail::parallelBlocks(m_activeEx, blocks, [&](std::size_t block, std::size_t start, std::size_t end){
+			double bestgain = best[block].first;
+			std::size_t bestj = i;
+			for (std::size_t a=start; a<end; a++)
 			{
-				std::size_t f = exa.var[pf];
-				double qif = def * k[a];
-				//check whether we are at an existing element of the sparse row
-				if( b != row.size && pf == row.entry[b].index){
-					qif = row.entry[b].value * k[a];
-					++b;//move to next element
-				}
-				if(f >= m_activeVar || f == i)
-					continue;
-				
-				double af = m_alpha(f);
-				double gf = m_gradient(f);
-				double df = m_variables[f].diagonal;
-				
-				//check whether a step is possible at all.
-				if (!(af > 0.0 && gf < 0.0) && !(af < m_C && gf > 0.0))
-					continue;
+				Example const& exa = m_examples[a];
+				unsigned int ya = exa.y;
+				typename QpSparseArray<QpFloatType>::Row const& row = m_M.row(m_classes * (yi * m_cardP + pi) + ya);
+				QpFloatType def = row.defaultvalue;
 				
-				double gain = detail::maximumGainQuadratic2D(di,df,qif,di,gi,gf);
-				if( gain > bestgain){
-					j = f;
-					bestgain = gain;
+				for (std::size_t pf=0, b=0; pf < m_cardP; pf++)
+				{
+					std::size_t f = exa.var[pf];
+					double qif = def * k[a];
+					//check whether we are at an existing element of the sparse row
+					if( b != row.size && pf == row.entry[b].index){
+						qif = row.entry[b].value * k[a];
+						++b;//move to next element
+					}
+					if(f >= m_activeVar || f == i)
+						continue;
+					
+					double af = m_alpha(f);
+					double gf = m_gradient(f);
+					double df = m_variables[f].diagonal;
+					
+					//check whether a step is possible at all.
+					if (!(af > 0.0 && gf < 0.0) && !(af < m_C && gf > 0.0))
+						continue;
+					
+					double gain = detail::maximumGainQuadratic2D(di,df,qif,di,gi,gf);
+					if( gain > bestgain){
+						bestj = f;
+						bestgain = gain;
+					}
 				}
 			}
+			best[block] = std::make_pair(bestgain, bestj);
+		});
+		
+		j = i;
+		double bestgain = gi * gi / di;
+		for (std::size_t block = 0; block != blocks; ++block){
+			if (best[block].first > bestgain){
+				bestgain = best[block].first;
+				j = best[block].second;
+			}
 		}
 
 		return maxViolation;
@@ -464,9 +483,35 @@ public:
 	
 protected:
 	
+	/// \brief Updates the gradient after the variable of row r of M changed by mu.
+	///
+	/// Every example only updates its own variables, thus the examples are processed in parallel blocks.
 	void gradientUpdate(std::size_t r, double mu, QpFloatType* q)
 	{
-		for ( std::size_t a= 0; a< m_activeEx; a++)
+		detail::parallelBlocks(m_activeEx, detail::parallelBlockCount(m_activeEx, m_cardP),
+			[&](std::size_t, std::size_t start, std::size_t end){
+				gradientUpdate(r, mu, q, start, end);
+			}
+		);
+	}
+	
+	/// \brief Updates the gradient after both variables of an S2DO step changed, using a single parallel pass.
+	void gradientUpdate(
+		std::size_t rv, double mu_v, QpFloatType* qv,
+		std::size_t rw, double mu_w, QpFloatType* qw
+	){
+		detail::parallelBlocks(m_activeEx, detail::parallelBlockCount(m_activeEx, 2 * m_cardP),
+			[&](std::size_t, std::size_t start, std::size_t end){
+				gradientUpdate(rv, mu_v, qv, start, end);
+				gradientUpdate(rw, mu_w, qw, start, end);
+			}
+		);
+	}
+	
+	/// \brief Gradient update restricted to the examples start,...,end-1.
+	void gradientUpdate(std::size_t r, double mu, QpFloatType* q, std::size_t start, std::size_t end)
+	{
+		for ( std::size_t a= start; a< end; a++)
 		{
 			double k = q[a];
 			Example& ex = m_examples[a];
@@ -38,8 +38,8 @@
 
 #include <shark/Core/Timer.h>
 #include <shark/Algorithms/QP/QuadraticProgram.h>
+#include <shark/Algorithms/QP/Impl/LinearQpData.h>
 #include <shark/Data/Dataset.h>
-#include <shark/Data/DataView.h>
 #include <shark/LinAlg/Base.h>
 #include <cmath>
 #include <iostream>
@@ -75,18 +75,12 @@ public:
 			std::size_t strategy = ACF,
 			bool shrinking = false)
 	: m_data(dataset)
-	, m_xSquared(dataset.numberOfElements())
 	, m_dim(dim)
 	, m_classes(classes)
 	, m_strategy(strategy)
 	, m_shrinking(shrinking)
 	{
 		SHARK_ASSERT(m_dim > 0);
-
-		for (std::size_t i=0; i<m_data.size(); i++)
-		{
-			m_xSquared(i) = inner_prod(m_data[i].input, m_data[i].input);
-		}
 	}
 
 	///
@@ -188,13 +182,13 @@ public:
 				// active example
 				double gain = 0.0;
 				const std::size_t i = schedule[j];
-				auto x_i = m_data[i].input;
-				const unsigned int y_i = m_data[i].label;
-				const double q = m_xSquared(i);
+				const unsigned int y_i = m_data.label(i);
+				const double q = m_data.squaredNorm(i);
 				blas::dense_vector_adaptor<double> a = row(alpha, i);
 
 				// compute gradient and KKT violation
-				RealVector wx = prod(w,x_i);
+				RealVector wx(m_classes);
+				m_data.prod(w, i, wx);
 				RealVector g(m_classes);
 				double kkt = calcGradient(g, wx, a, C, y_i);
 
@@ -329,11 +323,10 @@ public:
 	}
 
 protected:
-	// for all c: row(w, c) += mu(c) * x
-	template<class Vector>
-	void add_scaled(RealMatrix& w, RealVector const& mu, Vector const& x)
+	// for all c: row(w, c) += mu(c) * x_index
+	void add_scaled(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		for (std::size_t c=0; c<m_classes; c++) noalias(row(w, c)) += mu(c) * x;
+		m_data.addScaled(w, mu, index);
 	}
 
 	/// \brief Compute the gradient from the inner products of the weight vectors with the current sample.
@@ -367,8 +360,7 @@ protected:
 	/// \return  The function must return the gain of the step, i.e., the improvement of the objective function.
 	virtual double solveSub(double epsilon, RealVector& gradient, double q, double C, unsigned int y, blas::dense_vector_adaptor<double>& alpha, RealVector& mu) = 0;
 
-	DataView<const DatasetType> m_data;               ///< view on training data
-	RealVector m_xSquared;                            ///< diagonal entries of the quadratic matrix
+	detail::LinearQpData<InputT> m_data;              ///< training data, provides the diagonal entries of the quadratic matrix
 	std::size_t m_dim;                                ///< input space dimension
 	std::size_t m_classes;                            ///< number of classes
 	std::size_t m_strategy;                         ///< strategy for coordinate selection
@@ -417,10 +409,10 @@ protected:
 	{
 		double sum_mu = 0.0;
 		for (std::size_t c=0; c<m_classes; c++) sum_mu += mu(c);
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		RealVector step(-0.5 * mu);
 		step(y) = 0.5 * sum_mu;
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -530,7 +522,7 @@ protected:
 		mean_mu /= (double)m_classes;
 		RealVector step(m_classes);
 		for (std::size_t c=0; c<m_classes; c++) step(c) = mean_mu - mu(c);
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -630,13 +622,13 @@ protected:
 	/// \brief Update the weight vectors (primal variables) after a step on the dual variables.
 	virtual void updateWeightVectors(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		double mean = -2.0 * mu(y);
 		for (std::size_t c=0; c<m_classes; c++) mean += mu(c);
 		mean /= (double)m_classes;
 		RealVector step(m_classes);
 		for (std::size_t c=0; c<m_classes; c++) step(c) = ((c == y) ? (mu(c) + mean) : (mean - mu(c)));
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -747,13 +739,13 @@ protected:
 	/// \brief Update the weight vectors (primal variables) after a step on the dual variables.
 	virtual void updateWeightVectors(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		double s = mu(0);
 		double sc = -s / m_classes;
 		double sy = s + sc;
 		RealVector step(m_classes);
 		for (size_t c=0; c<m_classes; c++) step(c) = (c == y) ? sy : sc;
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -861,12 +853,12 @@ protected:
 	/// \brief Update the weight vectors (primal variables) after a step on the dual variables.
 	virtual void updateWeightVectors(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		double sum_mu = 0.0;
 		for (std::size_t c=0; c<m_classes; c++) if (c != y) sum_mu += mu(c);
 		RealVector step(-0.5 * mu);
 		step(y) = 0.5 * sum_mu;
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -1062,7 +1054,7 @@ protected:
 		mean_mu /= (double)m_classes;
 		RealVector step(m_classes);
 		for (size_t c=0; c<m_classes; c++) step(c) = mean_mu - mu(c);
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -1242,13 +1234,13 @@ protected:
 	/// \brief Update the weight vectors (primal variables) after a step on the dual variables.
 	virtual void updateWeightVectors(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		double mean = -2.0 * mu(y);
 		for (std::size_t c=0; c<m_classes; c++) mean += mu(c);
 		mean /= (double)m_classes;
 		RealVector step(m_classes);
 		for (size_t c=0; c<m_classes; c++) step(c) = (c == y) ? (mu(c) + mean) : (mean - mu(c));
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -1431,13 +1423,13 @@ protected:
 	/// \brief Update the weight vectors (primal variables) after a step on the dual variables.
 	virtual void updateWeightVectors(RealMatrix& w, RealVector const& mu, std::size_t index)
 	{
-		unsigned int y = m_data[index].label;
+		unsigned int y = m_data.label(index);
 		double mean = -2.0 * mu(y);
 		for (std::size_t c=0; c<m_classes; c++) mean += mu(c);
 		mean /= (double)m_classes;
 		RealVector step(m_classes);
 		for (std::size_t c=0; c<m_classes; c++) step(c) = ((c == y) ? (mu(c) + mean) : (mean - mu(c)));
-		add_scaled(w, step, m_data[index].input);
+		add_scaled(w, step, index);
 	}
 
 	/// \brief Solve the sub-problem posed by a single training example.
@@ -12,6 +12,7 @@
 #include <shark/LinAlg/KernelMatrix.h>
 #include <shark/LinAlg/PrecomputedMatrix.h>
 #include <shark/LinAlg/RegularizedKernelMatrix.h>
+#include <shark/LinAlg/SharedKernelCache.h>
 #include <shark/Models/Kernels/GaussianRbfKernel.h>
 #include <shark/Data/DataView.h>
 
@@ -104,7 +105,7 @@ public:
 	//! \param offset whether to train the svm with offset term
 	//! \param  unconstrained  when a C-value is given via setParameter, should it be piped through the exp-function before using it in the solver?
 	CSvmTrainer(KernelType* kernel, double C, bool offset, bool unconstrained = false)
-	: base_type(kernel, C, offset, unconstrained), m_computeDerivative(false), m_McSvmType(McSvm::WW) //make  Vapnik happy!
+	: base_type(kernel, C, offset, unconstrained), m_computeDerivative(false), m_McSvmType(McSvm::WW), mep_kernelCache(nullptr) //make  Vapnik happy!
 	{ }
 	
 	//! Constructor
@@ -114,7 +115,7 @@ public:
 	//! \param offset whether to train the svm with offset term
 	//! \param  unconstrained  when a C-value is given via setParameter, should it be piped through the exp-function before using it in the solver?
 	CSvmTrainer(KernelType* kernel, double negativeC, double positiveC, bool offset, bool unconstrained = false)
-	: base_type(kernel,negativeC, positiveC, offset, unconstrained), m_computeDerivative(false), m_McSvmType(McSvm::WW) //make  Vapnik happy!
+	: base_type(kernel,negativeC, positiveC, offset, unconstrained), m_computeDerivative(false), m_McSvmType(McSvm::WW), mep_kernelCache(nullptr) //make  Vapnik happy!
 	{ }
 
 	/// \brief From INameable: return the class name.
@@ -129,6 +130,17 @@ public:
 	void setMcSvmType(McSvm type){
 		m_McSvmType = type;
 	}
+	
+	/// \brief Sets a kernel cache shared between trainings on subsets of a dataset.
+	///
+	/// If a cache is set, binary and one-versus-all SVMs take their kernel values
+	/// from the cache instead of computing them. This requires that the training
+	/// data is a subset of the cached dataset, e.g. a fold of a cross-validation
+	/// created from it, and that the cache was created for the kernel of this
+	/// trainer. Pass nullptr to disable the cache again.
+	void setSharedKernelCache(SharedKernelCache<InputType, QpFloatType>* cache){
+		mep_kernelCache = cache;
+	}
 
 
 	/// \brief Train the C-SVM.
@@ -275,6 +287,66 @@ public:
 
 		if (base_type::sparsify()) f.sparsify();
 	}
+
+	/// \brief Train a binary C-SVM with kernel values taken from the given matrix.
+	///
+	/// The matrix replaces the KernelMatrix of the training inputs and must offer
+	/// its interface, e.g. a SubsetKernelMatrix of a SharedKernelCache or a
+	/// KernelRowStore. The access count of the trainer is the one reported by the matrix.
+	template<class Matrix>
+	void trainWithKernelMatrix(KernelClassifier<InputType>& svm, LabeledData<InputType, unsigned int> const& dataset, Matrix& km){
+		SHARK_RUNTIME_CHECK(numberOfClasses(dataset) == 2, "Kernel matrices can only be supplied for binary problems");
+		SHARK_RUNTIME_CHECK(km.size() == dataset.numberOfElements(), "Kernel matrix does not match the size of the dataset");
+		auto& f = svm.decisionFunction();
+		f.setStructure(base_type::m_kernel, dataset.inputs(), this->m_trainOffset);
+		trainBinary(km, f, dataset);
+		if (base_type::sparsify())
+			f.sparsify();
+	}
+
+	/// \brief Train binary C-SVMs along an increasing sequence of regularization parameters.
+	///
+	/// Solves the C-SVM problem once for every value in Cs, which must be
+	/// positive and sorted in increasing order. The solution for a value of C
+	/// is feasible for every larger C, so each problem is warm-started from
+	/// the alphas and the gradient of the previous one, and the kernel cache
+	/// (or precomputed kernel matrix) is shared along the whole path. This is
+	/// considerably faster than training from scratch for every grid point
+	/// during model selection.
+	///
+	/// The i-th model in svms is the solution for Cs[i]. The solution
+	/// properties and access count of the trainer are those of the full path.
+	/// Afterwards the regularization parameter of the trainer is set to the
+	/// last value of the path.
+	void trainPath(
+		std::vector<KernelClassifier<InputType> >& svms,
+		LabeledData<InputType, unsigned int> const& dataset,
+		std::vector<double> const& Cs
+	){
+		SHARK_RUNTIME_CHECK(numberOfClasses(dataset) == 2, "the C-SVM path is only implemented for binary problems");
+		SHARK_RUNTIME_CHECK(base_type::m_regularizers.size() == 1, "the C-SVM path requires a single regularization parameter");
+		SHARK_RUNTIME_CHECK(!Cs.empty(), "the path must contain at least one value of C");
+		SHARK_RUNTIME_CHECK(Cs[0] > 0, "C must be larger than 0");
+		for(std::size_t i = 1; i != Cs.size(); ++i){
+			SHARK_RUNTIME_CHECK(Cs[i] >= Cs[i-1], "the values of C must be sorted in increasing order");
+		}
+		
+		svms.resize(Cs.size());
+		base_type::m_solutionproperties = QpSolutionProperties();
+		KernelMatrix<InputType, QpFloatType> km(*base_type::m_kernel, dataset.inputs());
+		if (QpConfig::precomputeKernel())
+		{
+			PrecomputedMatrix<KernelMatrix<InputType, QpFloatType> > matrix(&km);
+			optimizePath(matrix, svms, dataset, Cs);
+		}
+		else
+		{
+			CachedMatrix<KernelMatrix<InputType, QpFloatType> > matrix(&km, base_type::m_cacheSize);
+			optimizePath(matrix, svms, dataset, Cs);
+		}
+		base_type::m_accessCount = km.getAccessCount();
+		this->setC(Cs.back());
+	}
 	
 	RealVector const& get_db_dParams()const{
 		return m_db_dParams;
@@ -557,6 +629,7 @@ private:
 			bintrainer.shrinking() = base_type::shrinking();
 			bintrainer.s2do() = base_type::s2do();
 			bintrainer.verbosity() = base_type::verbosity();
+			bintrainer.setSharedKernelCache(mep_kernelCache);
 			bintrainer.train(binsvm, bindata);
 			base_type::m_solutionproperties.iterations += bintrainer.solutionProperties().iterations;
 			base_type::m_solutionproperties.seconds += bintrainer.solutionProperties().seconds;
@@ -571,9 +644,15 @@ private:
 			svm.decisionFunction().sparsify();
 	}
 	
-	//by default the normal unoptimized kernel matrix is used
+	//by default the normal unoptimized kernel matrix is used, or the shared cache if available
 	template<class T, class DatasetTypeT>
 	void trainBinary(KernelExpansion<T>& svm, DatasetTypeT const& dataset){
+		if(mep_kernelCache){
+			SHARK_RUNTIME_CHECK(&mep_kernelCache->kernel() == base_type::m_kernel, "Shared kernel cache uses a different kernel than the trainer");
+			SubsetKernelMatrix<T, QpFloatType> km(*mep_kernelCache, dataset.inputs());
+			trainBinary(km,svm,dataset);
+			return;
+		}
 		KernelMatrix<T, QpFloatType> km(*base_type::m_kernel, dataset.inputs());
 		trainBinary(km,svm,dataset);
 	}
@@ -634,6 +713,45 @@ private:
 		base_type::m_accessCount = km.getAccessCount();
 	}
 	
+	//the rows of a shared kernel cache are used directly, a CachedMatrix would store them a second time
+	template<class T>
+	void trainBinary(SubsetKernelMatrix<T, QpFloatType>& km, KernelExpansion<T>& svm, LabeledData<T, unsigned int> const& dataset){
+		typedef SubsetKernelMatrix<T, QpFloatType> Matrix;
+		if (QpConfig::precomputeKernel())
+		{
+			PrecomputedMatrix<Matrix> matrix(&km);
+			CSVMProblem<PrecomputedMatrix<Matrix> > svmProblem(matrix,dataset.labels(),base_type::m_regularizers);
+			optimize(svm,svmProblem,dataset);
+		}
+		else
+		{
+			CSVMProblem<Matrix> svmProblem(km,dataset.labels(),base_type::m_regularizers);
+			optimize(svm,svmProblem,dataset);
+		}
+		base_type::m_accessCount = km.getAccessCount();
+	}
+	
+	template<class T>
+	void trainBinary(SubsetKernelMatrix<T, QpFloatType>& km, KernelExpansion<T>& svm, WeightedLabeledData<T, unsigned int> const& dataset){
+		typedef SubsetKernelMatrix<T, QpFloatType> Matrix;
+		if (QpConfig::precomputeKernel())
+		{
+			PrecomputedMatrix<Matrix> matrix(&km);
+			GeneralQuadraticProblem<PrecomputedMatrix<Matrix> > svmProblem(
+				matrix, dataset.weightedLabels(),base_type::m_regularizers
+			);
+			optimize(svm,svmProblem,dataset.data());
+		}
+		else
+		{
+			GeneralQuadraticProblem<Matrix> svmProblem(
+				km, dataset.weightedLabels() ,base_type::m_regularizers
+			);
+			optimize(svm,svmProblem,dataset.data());
+		}
+		base_type::m_accessCount = km.getAccessCount();
+	}
+	
 	template<class SVMProblemType>
 	void optimize(KernelExpansion<InputType>& svm, SVMProblemType& svmProblem, LabeledData<InputType, unsigned int> const& dataset){
 		if (this->m_trainOffset)
@@ -681,10 +799,64 @@ private:
 		}
 	}
 	
+	template<class Matrix>
+	void optimizePath(
+		Matrix& matrix, std::vector<KernelClassifier<InputType> >& svms,
+		LabeledData<InputType, unsigned int> const& dataset, std::vector<double> const& Cs
+	){
+		typedef CSVMProblem<Matrix> SVMProblemType;
+		SVMProblemType svmProblem(matrix, dataset.labels(), Cs[0]);
+		if (this->m_trainOffset)
+		{
+			typedef SvmShrinkingProblem<SVMProblemType> ProblemType;
+			ProblemType problem(svmProblem, base_type::m_shrinking);
+			solvePath(problem, svms, dataset, Cs);
+		}
+		else
+		{
+			typedef BoxConstrainedShrinkingProblem<SVMProblemType> ProblemType;
+			ProblemType problem(svmProblem, base_type::m_shrinking);
+			solvePath(problem, svms, dataset, Cs);
+		}
+	}
+	
+	template<class ProblemType>
+	void solvePath(
+		ProblemType& problem, std::vector<KernelClassifier<InputType> >& svms,
+		LabeledData<InputType, unsigned int> const& dataset, std::vector<double> const& Cs
+	){
+		QpSolver< ProblemType > solver(problem);
+		QpSolutionProperties& pathProperties = base_type::m_solutionproperties;
+		for(std::size_t i = 0; i != Cs.size(); ++i){
+			if(i != 0){
+				// The old solution stays feasible when the box grows. Variables at
+				// the old upper bound become free, the gradient stays unchanged.
+				problem.unshrink();
+				problem.scaleBoxConstraints(Cs[i] / Cs[i-1], 1.0);
+			}
+			QpSolutionProperties prop;
+			solver.solve(base_type::stoppingCondition(), &prop);
+			pathProperties.type = prop.type;
+			pathProperties.accuracy = (i == 0) ? prop.accuracy : std::max(pathProperties.accuracy, prop.accuracy);
+			pathProperties.value = prop.value;
+			pathProperties.iterations += prop.iterations;
+			pathProperties.seconds += prop.seconds;
+			
+			auto& f = svms[i].decisionFunction();
+			f.setStructure(base_type::m_kernel, dataset.inputs(), this->m_trainOffset);
+			column(f.alpha(), 0) = problem.getUnpermutedAlpha();
+			if (this->m_trainOffset)
+				f.offset(0) = computeBias(problem, dataset);
+			if (base_type::sparsify())
+				f.sparsify();
+		}
+	}
+	
 	RealVector m_db_dParams; ///< in the rare case that there are only bounded SVs and no free SVs, this will hold the derivative of b w.r.t. the hyperparameters. Derivative w.r.t. C is last.
 
 	bool m_computeDerivative;
 	McSvm m_McSvmType;
+	SharedKernelCache<InputType, QpFloatType>* mep_kernelCache; ///< optional kernel cache shared between subsets of a dataset
 
 	template<class Problem>
 	double computeBias(Problem const& problem, LabeledData<InputType, unsigned int> const& dataset){
@@ -37,9 +37,13 @@
 #define SHARK_ALGORITHMS_TRAINERS_IMPL_CART_H
 
 #include <shark/Core/Random.h>
+#include <shark/Core/Threading/Algorithms.h>
 #include <shark/Core/utility/KeyValuePair.h>
 #include <shark/LinAlg/Base.h>
 #include <shark/Statistics/Distributions/MultiNomialDistribution.h>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 
 namespace shark {namespace CART{
 	
@@ -53,7 +57,8 @@ struct Bootstrap{
 	std::vector<unsigned int> weights; /// number of times the ith point got picked.
 	
 	///\brief Creates a random bootstrap from the provided dataset.
-	Bootstrap(random::rng_type& rng, DataSet const& data, LabelSet const& labels, RealVector const& sample_weights):data(data){
+	template<class Rng>
+	Bootstrap(Rng& rng, DataSet const& data, LabelSet const& labels, RealVector const& sample_weights):data(data){
 		// sample bootstrap indices (with replacement)
 		// we use the sample weights as sample probabilities (they are correctly normalized to 1)
 		MultiNomialDistribution dist(sample_weights);
@@ -122,6 +127,84 @@ private:
 	}
 };
 	
+///\brief Features of a dataset discretized into at most 256 bins each.
+///
+/// The bins of a feature are formed from the sorted values, such that
+/// every bin holds roughly the same number of points. Values closer than
+/// epsilon always share a bin. Between two consecutive bins a threshold is
+/// chosen as in the exact split search, thus a point lies in bin b or below
+/// exactly if its feature value is smaller or equal to threshold(feature, b).
+/// Splits found on the bins are therefore valid splits of the original data.
+class BinnedData{
+public:
+	BinnedData(){}
+
+	///\brief Discretizes the features of data (one point per row) into at most maxBins bins.
+	BinnedData(blas::matrix<double, blas::column_major> const& data, std::size_t maxBins, double epsilon)
+	: m_points(data.size1())
+	, m_bins(data.size1() * data.size2())
+	, m_thresholds(data.size2()){
+		SHARK_RUNTIME_CHECK(maxBins >= 2 && maxBins <= 256, "Number of bins must be between 2 and 256");
+		auto binFeature = [&](std::size_t f){
+			auto const& values = column(data, f);
+			std::vector<double> sorted(values.begin(), values.end());
+			std::sort(sorted.begin(), sorted.end());
+			// positions in the sorted values where a new value starts
+			std::vector<std::size_t> starts;
+			for(std::size_t i = 1; i < sorted.size(); ++i){
+				if(sorted[i] > sorted[i - 1] + epsilon)
+					starts.push_back(i);
+			}
+			// with few values every value gets its own bin, otherwise a bin
+			// is closed as soon as it holds its share of the remaining points
+			std::vector<double>& thresholds = m_thresholds[f];
+			std::size_t binStart = 0;
+			for(std::size_t i: starts){
+				if(thresholds.size() + 1 == maxBins)
+					break;
+				std::size_t binsLeft = maxBins - thresholds.size();
+				if(starts.size() >= maxBins && (i - binStart) * binsLeft < sorted.size() - binStart)
+					continue;
+				double threshold = (sorted[i - 1] + sorted[i]) / 2.0;
+				//check for numerical stability of the threshold
+				if(threshold == sorted[i])
+					threshold = sorted[i - 1];
+				thresholds.push_back(threshold);
+				binStart = i;
+			}
+			std::uint8_t* bins = &m_bins[f * m_points];
+			for(std::size_t i = 0; i != m_points; ++i){
+				bins[i] = std::uint8_t(std::lower_bound(thresholds.begin(), thresholds.end(), values(i)) - thresholds.begin());
+			}
+		};
+		threading::parallelND({data.size2()}, {1}, binFeature, threading::globalThreadPool());
+	}
+
+	///\brief Number of features.
+	std::size_t numberOfFeatures() const{
+		return m_thresholds.size();
+	}
+
+	///\brief Number of bins of a feature.
+	std::size_t numberOfBins(std::size_t feature) const{
+		return m_thresholds[feature].size() + 1;
+	}
+
+	///\brief Bin of the feature of the i-th point.
+	std::size_t bin(std::size_t i, std::size_t feature) const{
+		return m_bins[feature * m_points + i];
+	}
+
+	///\brief Returns the threshold separating bins b and b+1 of a feature.
+	double threshold(std::size_t feature, std::size_t b) const{
+		return m_thresholds[feature][b];
+	}
+private:
+	std::size_t m_points;
+	std::vector<std::uint8_t> m_bins;///< bins of the points, stored feature by feature
+	std::vector<std::vector<double> > m_thresholds;///< thresholds between consecutive bins of each feature
+};
+
 struct MSECriterion{
 	struct CriterionRecord {
 		std::size_t current_pos;
@@ -202,19 +285,44 @@ struct MSECriterion{
 			critRecord.weight_right -= weight;
 		}
 		critRecord.current_pos = new_pos;
-
-		// left and right impurity
-		critRecord.impurity_left = sum(critRecord.sq_sum_left) / critRecord.weight_left;
-		critRecord.impurity_left -= norm_sqr(critRecord.sum_left) / (critRecord.weight_left * critRecord.weight_left);
-		critRecord.impurity_right = sum(critRecord.sq_sum_right) / critRecord.weight_right;
-		critRecord.impurity_right -= norm_sqr(critRecord.sum_right) / (critRecord.weight_right * critRecord.weight_right);
-
-		double weight_all = critRecord.weight_left + critRecord.weight_right;
-		double fraction_left = critRecord.weight_left / weight_all;
-		double fraction_right = critRecord.weight_right / weight_all;
-
-		// improvement
-		critRecord.improvement = critRecord.impurity - fraction_left * critRecord.impurity_left - fraction_right * critRecord.impurity_right;
+		computeImprovement(critRecord);
+	}
+	
+	///\brief Number of statistics of the labels stored per histogram bin.
+	static std::size_t histogramSize(std::size_t labelDim){
+		return 2 * labelDim;
+	}
+	
+	///\brief Adds the label of the i-th point of the bootstrap to the statistics of a histogram bin.
+	static void addToHistogram(double* stats, RealMatrix const& labels, std::size_t i, double weight){
+		std::size_t labelDim = labels.size2();
+		for(std::size_t k = 0; k != labelDim; ++k){
+			double label = labels(i,k);
+			stats[k] += weight * label;
+			stats[labelDim + k] += weight * label * label;
+		}
+	}
+	
+	///\brief Moves the points of a histogram bin with the given weight and statistics to the left side of the split.
+	static void updateCriterion(
+		CriterionRecord& critRecord,
+		double weight,
+		double const* stats
+	) {
+		std::size_t labelDim = critRecord.sum_right.size();
+		if(critRecord.sum_left.empty()){
+			critRecord.sum_left = blas::repeat(0.0, labelDim);
+			critRecord.sq_sum_left = blas::repeat(0.0, labelDim);
+		}
+		for(std::size_t k = 0; k != labelDim; ++k){
+			critRecord.sum_left(k) += stats[k];
+			critRecord.sq_sum_left(k) += stats[labelDim + k];
+			critRecord.sum_right(k) -= stats[k];
+			critRecord.sq_sum_right(k) -= stats[labelDim + k];
+		}
+		critRecord.weight_left += weight;
+		critRecord.weight_right -= weight;
+		computeImprovement(critRecord);
 	}
 	
 	static void split(CriterionRecord critRecord, CriterionRecord& left, CriterionRecord& right){
@@ -238,6 +346,21 @@ struct MSECriterion{
 		right.sum_right = std::move(critRecord.sum_right);
 		right.sq_sum_right = std::move(critRecord.sq_sum_right);
 	}
+private:
+	static void computeImprovement(CriterionRecord& critRecord){
+		// left and right impurity
+		critRecord.impurity_left = sum(critRecord.sq_sum_left) / critRecord.weight_left;
+		critRecord.impurity_left -= norm_sqr(critRecord.sum_left) / (critRecord.weight_left * critRecord.weight_left);
+		critRecord.impurity_right = sum(critRecord.sq_sum_right) / critRecord.weight_right;
+		critRecord.impurity_right -= norm_sqr(critRecord.sum_right) / (critRecord.weight_right * critRecord.weight_right);
+
+		double weight_all = critRecord.weight_left + critRecord.weight_right;
+		double fraction_left = critRecord.weight_left / weight_all;
+		double fraction_right = critRecord.weight_right / weight_all;
+
+		// improvement
+		critRecord.improvement = critRecord.impurity - fraction_left * critRecord.impurity_left - fraction_right * critRecord.impurity_right;
+	}
 };
 
 struct ClassificationCriterion{
@@ -318,25 +441,36 @@ struct ClassificationCriterion{
 			critRecord.weight_right -= weight;
 		}
 		critRecord.current_pos = new_pos;
-		critRecord.impurity_left = 0.0;
-		critRecord.impurity_right = 0.0;
-
-		for (std::size_t i = 0; i < critRecord.class_counts_left.size(); i++) {
-			// left impurity
-			double pmk_left = critRecord.class_counts_left[i] / critRecord.weight_left;
-			critRecord.impurity_left += pmk_left * (1.0 - pmk_left);
-
-			// right impurity
-			double pmk_right = critRecord.class_counts_right[i] / critRecord.weight_right;
-			critRecord.impurity_right += pmk_right * (1.0 - pmk_right);
+		computeImprovement(critRecord);
+	}
+	
+	///\brief Number of statistics of the labels stored per histogram bin.
+	static std::size_t histogramSize(std::size_t nClasses){
+		return nClasses;
+	}
+	
+	///\brief Adds the label of the i-th point of the bootstrap to the statistics of a histogram bin.
+	static void addToHistogram(double* stats, UIntVector const& labels, std::size_t i, double weight){
+		stats[labels[i]] += weight;
+	}
+	
+	///\brief Moves the points of a histogram bin with the given weight and statistics to the left side of the split.
+	static void updateCriterion(
+		CriterionRecord& critRecord,
+		double weight,
+		double const* stats
+	) {
+		std::size_t nClasses = critRecord.class_counts_right.size();
+		if(critRecord.class_counts_left.empty())
+			critRecord.class_counts_left.resize(nClasses,false);
+		for(std::size_t c = 0; c != nClasses; ++c){
+			int count = int(stats[c]);
+			critRecord.class_counts_left[c] += count;
+			critRecord.class_counts_right[c] -= count;
 		}
-
-		double weight_all = critRecord.weight_left + critRecord.weight_right;
-		double fraction_left = critRecord.weight_left / weight_all;
-		double fraction_right = critRecord.weight_right / weight_all;
-
-		// improvement
-		critRecord.improvement = critRecord.impurity - fraction_left * critRecord.impurity_left - fraction_right * critRecord.impurity_right;
+		critRecord.weight_left += weight;
+		critRecord.weight_right -= weight;
+		computeImprovement(critRecord);
 	}
 	
 	static void split(CriterionRecord critRecord, CriterionRecord& left, CriterionRecord& right){
@@ -358,6 +492,28 @@ struct ClassificationCriterion{
 		right.weight_right = critRecord.weight_right;
 		right.class_counts_right = std::move(critRecord.class_counts_right);
 	}
+private:
+	static void computeImprovement(CriterionRecord& critRecord){
+		critRecord.impurity_left = 0.0;
+		critRecord.impurity_right = 0.0;
+
+		for (std::size_t i = 0; i < critRecord.class_counts_left.size(); i++) {
+			// left impurity
+			double pmk_left = critRecord.class_counts_left[i] / critRecord.weight_left;
+			critRecord.impurity_left += pmk_left * (1.0 - pmk_left);
+
+			// right impurity
+			double pmk_right = critRecord.class_counts_right[i] / critRecord.weight_right;
+			critRecord.impurity_right += pmk_right * (1.0 - pmk_right);
+		}
+
+		double weight_all = critRecord.weight_left + critRecord.weight_right;
+		double fraction_left = critRecord.weight_left / weight_all;
+		double fraction_right = critRecord.weight_right / weight_all;
+
+		// improvement
+		critRecord.improvement = critRecord.impurity - fraction_left * critRecord.impurity_left - fraction_right * critRecord.impurity_right;
+	}
 };
 
  template<class LabelType, class Criterion>
@@ -370,6 +526,11 @@ public:
 private:
 	typedef typename Criterion::CriterionRecord CriterionRecord;
 	
+	/// histograms of the features of a node. The histogram of a feature has a row for every bin
+	/// storing the number of points, their weight and the statistics of their labels.
+	/// Histograms which are not computed are empty.
+	typedef std::vector<RealMatrix> Histograms;
+	
 	struct TraversalRecord{
 		std::size_t nodeId;
 		std::size_t start;
@@ -378,11 +539,33 @@ private:
 		std::vector<bool> constFeatures;
 		double priority;
 		CriterionRecord criterion;
+		
+		//histogram split search only
+		std::shared_ptr<Histograms> histograms;///< histograms of the node
+		std::shared_ptr<Histograms> parentHistograms;///< histograms of the parent node, null for the root
+		std::shared_ptr<Histograms> siblingHistograms;///< histograms of the sibling node
+		std::size_t siblingStart;
+		std::size_t siblingEnd;
 
 		bool operator<(TraversalRecord const& other)const{
 			return priority < other.priority;
 		}
 	};
+
+	/// \brief Creates the record of a node, the criterion and histograms are set by the caller.
+	static TraversalRecord makeRecord(
+		std::size_t nodeId, std::size_t start, std::size_t end,
+		unsigned depth, std::vector<bool> const& constFeatures, double priority
+	){
+		TraversalRecord record = TraversalRecord();
+		record.nodeId = nodeId;
+		record.start = start;
+		record.end = end;
+		record.depth = depth;
+		record.constFeatures = constFeatures;
+		record.priority = priority;
+		return record;
+	}
 	
 	struct SplitRecord{
 		unsigned int feature;
@@ -404,9 +587,21 @@ public:
 	std::size_t m_max_depth;///< maximum depth of the tree
 	double m_epsilon;///< Minimum difference between two values to be considered different
 	double m_min_impurity_split;///< stops splitting when the impority is below a threshold
+	///\brief Binned features of the data for the histogram split search, or null for the exact search.
+	///
+	/// Histograms are used for a feature if the node holds at least as many points as the feature has bins,
+	/// smaller nodes are split exactly.
+	BinnedData const* m_binned = nullptr;
+	std::size_t m_min_parallel_samples = 4096;///< nodes with at least this many points evaluate their features in parallel
 	
+	///\brief Builds a tree on a bootstrap sample.
+	///
+	/// All random decisions are taken using rng. For nodes with many points,
+	/// the candidate features are evaluated in parallel on the global thread pool.
+	/// The result does not depend on the number of threads.
+	template<class Rng>
 	CARTree<LabelType> buildTree(
-		random::rng_type& rng,
+		Rng& rng,
 		Bootstrap& bootstrap
 	){
 		//create root of the tree
@@ -424,8 +619,10 @@ public:
 		
 		//push root entry into the priority queue
 		std::priority_queue<TraversalRecord> queue;
-		TraversalRecord record = {0, 0,bootstrap.indices.size(), 0, std::vector<bool>(bootstrap.data.size2(),false),0};
+		TraversalRecord record = makeRecord(0, 0, bootstrap.indices.size(), 0, std::vector<bool>(bootstrap.data.size2(),false), 0);
 		record.criterion = Criterion::initCriterion(bootstrap.labels, bootstrap.weights, bootstrap.labelDim);
+		if(m_binned)
+			record.histograms = std::make_shared<Histograms>(bootstrap.data.size2());
 		if(!enqueueRecord(queue,record))
 			makeLeaf(record);
 
@@ -452,9 +649,22 @@ public:
 			//enqueue new nodes taking priority into account
 			unsigned leafDepth = record.depth + 1;
 			double priority = double(leafDepth);
-			TraversalRecord left = {node.leftId, start, pos, leafDepth, record.constFeatures, priority};
-			TraversalRecord right = {node.rightIdOrIndex, pos, end, leafDepth, record.constFeatures, priority};
+			TraversalRecord left = makeRecord(node.leftId, start, pos, leafDepth, record.constFeatures, priority);
+			TraversalRecord right = makeRecord(node.rightIdOrIndex, pos, end, leafDepth, record.constFeatures, priority);
 			Criterion::split(std::move(split.criterion),left.criterion,right.criterion);
+			if(m_binned){
+				//the histograms of a child are the difference of the parent's and the sibling's
+				left.histograms = std::make_shared<Histograms>(bootstrap.data.size2());
+				right.histograms = std::make_shared<Histograms>(bootstrap.data.size2());
+				left.parentHistograms = record.histograms;
+				right.parentHistograms = record.histograms;
+				left.siblingHistograms = right.histograms;
+				right.siblingHistograms = left.histograms;
+				left.siblingStart = pos;
+				left.siblingEnd = end;
+				right.siblingStart = start;
+				right.siblingEnd = pos;
+			}
 			//enqueue childs if they do not already statisfy condition for a leaf(e.g. too small)
 			if(!enqueueRecord(queue,left))
 				makeLeaf(left);
@@ -480,8 +690,9 @@ private:
 	// Compute the best split based on the impurity measure
 	// the split is stored in the traversal record and has all information
 	// to perform the actual splitting
+	template<class Rng>
 	bool findSplit(
-		random::rng_type& rng,
+		Rng& rng,
 		TraversalRecord& record,
 		SplitRecord& split,
 		Bootstrap const& bootstrap
@@ -490,14 +701,40 @@ private:
 		std::iota(randomFeatures.begin(),randomFeatures.end(),0);
 		std::shuffle(randomFeatures.begin(), randomFeatures.end(),rng);
 		
-		std::size_t start = record.start;
-		std::size_t end = record.end;
-		
-		//vector for storing split feature values. This gives faster memory access later
-		std::vector<KeyValuePair<double,std::size_t> > XF(end - start);
 		split.improvement = 0.0;
-		CriterionRecord bestCriterion;
-		for (std::size_t j = 0; j < randomFeatures.size(); j++) {
+		std::size_t numSamples = record.end - record.start;
+		//vector for storing split feature values. This gives faster memory access later
+		std::vector<KeyValuePair<double,std::size_t> > XF(numSamples);
+		std::size_t j = 0;
+		
+		//for large nodes, the first max_features features are evaluated in parallel.
+		//Features known to be constant count towards max_features but are not checked again.
+		//The results are combined in the order of the features, which gives the same split
+		//as the sequential loop below.
+		if(numSamples >= m_min_parallel_samples && threading::globalThreadPool().numWorkers() > 1){
+			std::size_t n = std::min<std::size_t>(m_max_features, randomFeatures.size());
+			std::vector<unsigned> candidates;
+			for(std::size_t k = 0; k != n; ++k){
+				if(!record.constFeatures[randomFeatures[k]])
+					candidates.push_back(randomFeatures[k]);
+			}
+			std::vector<SplitRecord> splits(candidates.size());
+			std::vector<char> constant(candidates.size(), 0);
+			auto evaluate = [&](std::size_t k){
+				std::vector<KeyValuePair<double,std::size_t> > localXF(numSamples);
+				bool isConstant = false;
+				splits[k] = evaluateFeature(record, candidates[k], bootstrap, localXF, isConstant);
+				constant[k] = isConstant;
+			};
+			threading::parallelND({candidates.size()}, {1}, evaluate, threading::globalThreadPool());
+			for(std::size_t k = 0; k != candidates.size(); ++k){
+				if(constant[k])
+					record.constFeatures[candidates[k]] = true;
+				split=std::max(split,splits[k]);
+			}
+			j = n;
+		}
+		for (; j < randomFeatures.size(); j++) {
 			// Break as soon as at least max_features and a non-trivial split can be found
 			if (j >= m_max_features && split.improvement > 0.0) {
 				break;
@@ -507,6 +744,42 @@ private:
 			if(record.constFeatures[feature]){
 				continue;
 			}
+			bool constant = false;
+			SplitRecord newSplit = evaluateFeature(record, feature, bootstrap, XF, constant);
+			if(constant)
+				record.constFeatures[feature] = true;
+			split=std::max(split,newSplit);
+		}
+		
+		//if we could not find any improvement, this is a leaf
+		return (split.improvement > 0.0);
+	}
+	
+	// Computes the best split of the node on a single feature.
+	// If the feature is constant on the points of the node, constant is set to true.
+	// XF is used as buffer for the feature values and must have one entry for every point of the node.
+	SplitRecord evaluateFeature(
+		TraversalRecord& record,
+		unsigned feature,
+		Bootstrap const& bootstrap,
+		std::vector<KeyValuePair<double,std::size_t> >& XF,
+		bool& constant
+	){
+		std::size_t start = record.start;
+		std::size_t end = record.end;
+		SplitRecord newSplit;
+		newSplit.improvement = 0.0;
+		if(m_binned && end - start >= m_binned->numberOfBins(feature)){
+			RealMatrix const& hist = histogram(record, feature, bootstrap);
+			std::size_t usedBins = 0;
+			for(std::size_t b = 0; b != hist.size1(); ++b){
+				usedBins += hist(b,0) > 0;
+			}
+			//no reason to check with a constant split
+			constant = usedBins <= 1;
+			if(!constant)
+				newSplit = computeHistogramThreshold(hist, feature, end - start, record.criterion);
+		}else{
 			// Copy data in XF for faster lookup and
 			// compute minimum and maximum to check if it is constant
 			double minf = std::numeric_limits<double>::max();
@@ -518,20 +791,13 @@ private:
 				minf = std::min(minf, f);
 				maxf = std::max(maxf, f);
 			}
-			//compute split
-			SplitRecord newSplit;
-			if (maxf <= minf + m_epsilon){//no reason to check with a constant split
-				newSplit.improvement = 0.0;
-				record.constFeatures[feature]  = true;
-			}else{
+			//no reason to check with a constant split
+			constant = maxf <= minf + m_epsilon;
+			if(!constant)
 				newSplit = computeOptimalThreshold(XF, bootstrap, record.criterion);
-			}
-			newSplit.feature = feature;
-			split=std::max(split,newSplit);
 		}
-		
-		//if we could not find any improvement, this is a leaf
-		return (split.improvement > 0.0);
+		newSplit.feature = feature;
+		return newSplit;
 	}
 	
 	SplitRecord computeOptimalThreshold(
@@ -587,6 +853,94 @@ private:
 		Criterion::updateCriterion(bestSplit.criterion, bestSplit.pos, XF, bootstrap.labels, bootstrap.weights);
 		return bestSplit;
 	}
+	
+	// Returns the histogram of a feature for the points of a node.
+	// If the histogram of the parent is known, the histogram is obtained as difference
+	// of the parent's and the sibling's histogram. The histogram of the sibling is computed
+	// for that purpose if the sibling holds fewer points than the node.
+	RealMatrix const& histogram(
+		TraversalRecord& record,
+		unsigned feature,
+		Bootstrap const& bootstrap
+	){
+		RealMatrix& hist = (*record.histograms)[feature];
+		if(hist.size1() != 0)
+			return hist;
+		if(record.parentHistograms){
+			RealMatrix const& parent = (*record.parentHistograms)[feature];
+			RealMatrix& sibling = (*record.siblingHistograms)[feature];
+			if(parent.size1() != 0 && sibling.size1() == 0 && record.siblingEnd - record.siblingStart < record.end - record.start){
+				fillHistogram(sibling, feature, record.siblingStart, record.siblingEnd, bootstrap);
+			}
+			if(parent.size1() != 0 && sibling.size1() != 0){
+				hist = parent - sibling;
+				return hist;
+			}
+		}
+		fillHistogram(hist, feature, record.start, record.end, bootstrap);
+		return hist;
+	}
+	
+	void fillHistogram(
+		RealMatrix& hist,
+		unsigned feature,
+		std::size_t start, std::size_t end,
+		Bootstrap const& bootstrap
+	){
+		hist = RealMatrix(m_binned->numberOfBins(feature), 2 + Criterion::histogramSize(bootstrap.labelDim), 0.0);
+		for (std::size_t i = start; i < end; i++) {
+			std::size_t b = m_binned->bin(bootstrap.indices[i], feature);
+			double weight = bootstrap.weights[i];
+			hist(b, 0) += 1;
+			hist(b, 1) += weight;
+			Criterion::addToHistogram(&hist(b, 2), bootstrap.labels, i, weight);
+		}
+	}
+	
+	// Same as computeOptimalThreshold, but only the thresholds between the bins
+	// of the feature are checked, using the histogram of the node.
+	SplitRecord computeHistogramThreshold(
+		RealMatrix const& hist,
+		unsigned feature,
+		std::size_t numSamples,
+		CriterionRecord criterion//copied because it is changed
+	){
+		// init split
+		SplitRecord bestSplit;
+		bestSplit.improvement = 0;
+		bestSplit.threshold = -std::numeric_limits<double>::max();
+		bestSplit.pos = 0;
+		bestSplit.criterion = criterion;
+		
+		std::size_t bestBin = 0;
+		std::size_t pos = 0;
+		for(std::size_t b = 0; b + 1 < hist.size1(); ++b){
+			if(hist(b, 0) == 0)
+				continue;
+			pos += std::size_t(hist(b, 0));
+			//stop as soon as the right side becomes too small
+			if(numSamples - pos < m_min_samples_leaf)
+				break;
+			Criterion::updateCriterion(criterion, hist(b, 1), &hist(b, 2));
+			if(pos < m_min_samples_leaf)
+				continue;
+			
+			// store results if improvement is better than before
+			if (criterion.improvement > bestSplit.improvement) {
+				bestSplit.improvement = criterion.improvement;
+				bestSplit.threshold = m_binned->threshold(feature, b);
+				bestSplit.pos = pos;
+				bestSplit.impurity_left = criterion.impurity_left;
+				bestSplit.impurity_right = criterion.impurity_right;
+				bestBin = b;
+			}
+		}
+		for(std::size_t b = 0; bestSplit.pos != 0 && b <= bestBin; ++b){
+			if(hist(b, 0) != 0)
+				Criterion::updateCriterion(bestSplit.criterion, hist(b, 1), &hist(b, 2));
+		}
+		return bestSplit;
+	}
 
 };
 }}
@@ -44,6 +44,7 @@
 #include <shark/Models/LinearModel.h>
 #include <shark/Core/IParameterizable.h>
 #include <shark/Algorithms/Trainers/AbstractTrainer.h>
+#include <shark/Data/ContiguousData.h>
 
 namespace shark {
 
@@ -88,6 +89,11 @@ public:
 	}
 
 	SHARK_EXPORT_SYMBOL void train(LinearModel<>& model, LabeledData<RealVector, RealVector> const& dataset);
+
+	/// \brief Trains on a dataset stored in contiguous arenas.
+	///
+	/// The batches are used as views of the arenas, nothing is copied.
+	SHARK_EXPORT_SYMBOL void train(LinearModel<>& model, ContiguousLabeledData<RealVector, RealVector> const& dataset);
 protected:
 	double m_regularization;
 };
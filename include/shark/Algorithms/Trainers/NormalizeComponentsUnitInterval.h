@@ -39,7 +39,9 @@
 
 
 #include <shark/Models/Normalizer.h>
+#include <shark/Data/Statistics.h>
 #include <shark/Algorithms/Trainers/AbstractTrainer.h>
+#include <limits>
 
 namespace shark{
 
@@ -86,15 +88,30 @@ public:
 		SHARK_RUNTIME_CHECK(ic >= 2, "Input needs to consist of at least two points");
 		std::size_t dc = dataDimension(input);
 
-		auto elements = shark::elements(input);
-		
-		RealVector min = elements[0];
-		RealVector max = elements[0];
-		for(auto const& element: elements){
+		//every thread computes the range of a block of batches
+		std::vector<RealVector> mins(input.size());
+		std::vector<RealVector> maxs(input.size());
+		std::size_t numBlocks = detail::parallelBatchBlocks(input.size(), [&](std::size_t block, std::size_t begin, std::size_t end){
+			mins[block] = RealVector(dc, std::numeric_limits<double>::infinity());
+			maxs[block] = RealVector(dc, -std::numeric_limits<double>::infinity());
+			for(std::size_t b = begin; b != end; ++b){
+				auto const& batch = input[b];
+				for(std::size_t i = 0; i != batch.size1(); ++i){
+					auto element = row(batch, i);
+					for(std::size_t d = 0; d != dc; d++){
+						double x = element(d);
+						mins[block](d) = std::min(mins[block](d), x);
+						maxs[block](d) = std::max(maxs[block](d), x);
+					}
+				}
+			}
+		});
+		RealVector min = mins[0];
+		RealVector max = maxs[0];
+		for(std::size_t block = 1; block != numBlocks; ++block){
 			for(std::size_t d = 0; d != dc; d++){
-				double x = element(d);
-				min(d) = std::min(min(d), x);
-				max(d) = std::max(max(d), x);
+				min(d) = std::min(min(d), mins[block](d));
+				max(d) = std::max(max(d), maxs[block](d));
 			}
 		}
 
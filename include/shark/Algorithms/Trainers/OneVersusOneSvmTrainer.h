@@ -0,0 +1,185 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Parallel training of one-versus-one multi-class SVMs
+ *
+ *
+ * \par
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+
+#ifndef SHARK_ALGORITHMS_TRAINERS_ONEVERSUSONESVMTRAINER_H
+#define SHARK_ALGORITHMS_TRAINERS_ONEVERSUSONESVMTRAINER_H
+
+
+#include <shark/Algorithms/Trainers/CSvmTrainer.h>
+#include <shark/LinAlg/SharedKernelCache.h>
+#include <shark/Models/OneVersusOneClassifier.h>
+#include <shark/Core/Threading/Algorithms.h>
+
+#include <memory>
+
+
+namespace shark {
+
+
+///
+/// \brief Training of one-versus-one multi-class SVMs.
+///
+/// \par
+/// The one-versus-one machine consists of a binary C-SVM for every
+/// pair of classes, trained only on the points of these two classes,
+/// see OneVersusOneClassifier. For c classes, c(c-1)/2 independent
+/// quadratic programs have to be solved. This trainer solves them in
+/// parallel on the global thread pool and returns the complete model.
+///
+/// \par
+/// Every point takes part in c-1 binary problems. Instead of computing
+/// the kernel values of a point in every problem again, all binary
+/// problems read their kernel values concurrently from a KernelRowStore
+/// of the whole dataset, which computes every value at most once. The
+/// store is used if the Gram matrix fits into the cache size of the
+/// trainer. Otherwise every binary problem computes its own kernel values
+/// using a kernel cache of the given size.
+///
+/// \par
+/// The trainer reorders a copy of the dataset by class, see repartitionByClass.
+/// The binary machines are owned by the trained model.
+/// \ingroup supervised_trainer
+template <class InputType, class CacheType = float>
+class OneVersusOneSvmTrainer : public AbstractSvmTrainer<InputType, unsigned int, OneVersusOneClassifier<InputType> >
+{
+private:
+	typedef AbstractSvmTrainer<InputType, unsigned int, OneVersusOneClassifier<InputType> > base_type;
+public:
+	/// \brief Convenience typedefs:
+	/// this and many of the below typedefs build on the class template type CacheType.
+	/// Simply changing that one template parameter CacheType thus allows to flexibly
+	/// switch between using float or double as type for caching the kernel values.
+	/// The default is float, offering sufficient accuracy in the vast majority
+	/// of cases, at a memory cost of only four bytes. However, the template
+	/// parameter makes it easy to use double instead, (e.g., in case high
+	/// accuracy training is needed).
+	typedef CacheType QpFloatType;
+	typedef AbstractKernelFunction<InputType> KernelType;
+	typedef KernelClassifier<InputType> BinaryModelType;
+
+	//! Constructor
+	//! \param  kernel         kernel function to use for training and prediction
+	//! \param  C              regularization parameter of all binary machines - always the 'true' value of C, even when unconstrained is set
+	//! \param offset whether to train the binary svms with offset term
+	//! \param  unconstrained  when a C-value is given via setParameter, should it be piped through the exp-function before using it in the solver?
+	OneVersusOneSvmTrainer(KernelType* kernel, double C, bool offset, bool unconstrained = false)
+	: base_type(kernel, C, offset, unconstrained)
+	{ }
+
+	/// \brief From INameable: return the class name.
+	std::string name() const
+	{ return "OneVersusOneSvmTrainer"; }
+
+	/// \brief Train the one-versus-one machine.
+	///
+	/// Previous binary machines of the model are removed.
+	void train(OneVersusOneClassifier<InputType>& model, LabeledData<InputType, unsigned int> const& dataset)
+	{
+		std::vector<std::size_t> sizes = classSizes(dataset);
+		std::size_t classes = sizes.size();
+		SHARK_RUNTIME_CHECK(classes >= 2, "The dataset must contain at least two classes");
+		for (std::size_t c = 0; c != classes; ++c)
+			SHARK_RUNTIME_CHECK(sizes[c] > 0, "Every class must be present in the dataset");
+
+		LabeledData<InputType, unsigned int> data = dataset;
+		repartitionByClass(data);
+		std::size_t ell = data.numberOfElements();
+
+		// the pairs in the order of the binary machines of the model
+		std::vector<std::pair<unsigned int, unsigned int> > pairs;
+		for (unsigned int c = 1; c != classes; c++)
+			for (unsigned int e = 0; e != c; e++)
+				pairs.push_back(std::make_pair(e, c));
+
+		typedef KernelRowStore<InputType, QpFloatType> StoreType;
+		std::unique_ptr<StoreType> store;
+		if (ell * ell <= base_type::cacheSize())
+			store.reset(new StoreType(*base_type::m_kernel, data.inputs()));
+
+		std::vector<boost::shared_ptr<BinaryModelType> > svms(pairs.size());
+		std::vector<QpSolutionProperties> properties(pairs.size());
+		std::vector<unsigned long long> accessCounts(pairs.size(), 0);
+		auto trainPair = [&](std::size_t p){
+			LabeledData<InputType, unsigned int> bindata = binarySubProblem(data, pairs[p].first, pairs[p].second);
+			CSvmTrainer<InputType, QpFloatType> bintrainer(base_type::m_kernel, this->C(), this->m_trainOffset);
+			bintrainer.setCacheSize(this->cacheSize());
+			bintrainer.sparsify() = base_type::sparsify();
+			bintrainer.stoppingCondition() = base_type::stoppingCondition();
+			bintrainer.precomputeKernel() = base_type::precomputeKernel();
+			bintrainer.shrinking() = base_type::shrinking();
+			bintrainer.s2do() = base_type::s2do();
+			bintrainer.verbosity() = base_type::verbosity();
+			svms[p].reset(new BinaryModelType());
+			if (store){
+				SubsetKernelMatrix<InputType, QpFloatType, StoreType> km(*store, bindata.inputs());
+				bintrainer.trainWithKernelMatrix(*svms[p], bindata, km);
+			}
+			else{
+				bintrainer.train(*svms[p], bindata);
+				accessCounts[p] = bintrainer.accessCount();
+			}
+			properties[p] = bintrainer.solutionProperties();
+		};
+		threading::parallelND({pairs.size()}, {1}, trainPair, threading::globalThreadPool());
+
+		model.clear();
+		for (std::size_t c = 1, p = 0; c != classes; c++){
+			std::vector<boost::shared_ptr<typename OneVersusOneClassifier<InputType>::binary_classifier_type> > vs_c;
+			for (std::size_t e = 0; e != c; e++, p++)
+				vs_c.push_back(svms[p]);
+			model.addClass(vs_c);
+		}
+
+		base_type::m_solutionproperties.type = QpNone;
+		base_type::m_solutionproperties.accuracy = 0.0;
+		base_type::m_solutionproperties.iterations = 0;
+		base_type::m_solutionproperties.value = 0.0;
+		base_type::m_solutionproperties.seconds = 0.0;
+		base_type::m_accessCount = store ? store->getAccessCount() : 0;
+		for (std::size_t p = 0; p != pairs.size(); p++){
+			base_type::m_solutionproperties.iterations += properties[p].iterations;
+			base_type::m_solutionproperties.seconds += properties[p].seconds;
+			base_type::m_solutionproperties.accuracy = std::max(base_type::m_solutionproperties.accuracy, properties[p].accuracy);
+			base_type::m_accessCount += accessCounts[p];
+		}
+	}
+};
+
+
+}
+#endif
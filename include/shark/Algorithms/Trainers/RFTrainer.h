@@ -42,6 +42,7 @@
 
 #include <vector>
 #include <limits>
+#include <random>
 
 namespace shark {
 
@@ -64,6 +65,11 @@ namespace shark {
 /// After growing a maximum sized tree, the tree is added to the ensemble
 /// without pruning.
 ///
+/// The trees are built in parallel. Every tree uses its own random number
+/// generator seeded from random::globalRng(), therefore the forest only
+/// depends on the state of the global generator and not on the number of threads.
+/// Large nodes evaluate their candidate features in parallel as well.
+///
 /// For detailed information about Random Forest, see Random Forest
 /// by L. Breiman et al. 2001.
 /// \ingroup supervised_trainer
@@ -88,6 +94,8 @@ public:
 		m_min_impurity_split = 1e-10; 
 		m_epsilon = 1e-10;
 		m_max_features = 0;
+		m_numBins = 0;
+		m_minParallelSamples = 4096;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -118,6 +126,23 @@ public:
 	/// The minimum dtsnace of features to be considered different (detault 1.e-10)
 	void epsilon(double distance) {m_epsilon = distance;}
 	
+	/// Use histograms with at most the given number of bins per feature to find the splits (default 0)
+	///
+	/// The features are discretized once before training. Nodes then find their split by scanning
+	/// the histograms of the features instead of sorting the feature values, which only checks
+	/// thresholds between the bins. Nodes holding fewer points than a feature has bins use the exact search.
+	/// The number of bins must be between 2 and 256, 0 disables histograms.
+	void setNumBins(std::size_t numBins) {
+		SHARK_RUNTIME_CHECK(numBins == 0 || (numBins >= 2 && numBins <= 256), "Number of bins must be 0 or between 2 and 256");
+		m_numBins = numBins;
+	}
+	
+	/// Set the minimum number of points of a node for which the features are evaluated in parallel (default 4096)
+	///
+	/// Smaller nodes evaluate their features sequentially, as the work does not pay off the synchronization.
+	/// The trained forest does not depend on this setting.
+	void setMinParallelSamples(std::size_t numSamples) {m_minParallelSamples = numSamples;}
+	
 	/// Return the parameter vector.
 	RealVector parameterVector() const{return RealVector();}
 
@@ -140,27 +165,42 @@ public:
 		builder.m_min_impurity_split = m_min_impurity_split;
 		builder.m_epsilon = m_epsilon;
 		builder.m_max_features = m_max_features? m_max_features: std::sqrt(inputDimension(dataset));
+		builder.m_min_parallel_samples = m_minParallelSamples;
 		
 		//copy data into single batch for easier lookup
 		blas::matrix<double, blas::column_major> data_train = createBatch<RealVector>(elements(dataset.inputs()));
 		auto labels_train = createBatch<LabelType>(elements(dataset.labels()));
 		auto weights_train = createBatch<double>(elements(dataset.weights()));
 		
-		std::vector<std::vector<std::size_t> > complements;
-
-		//mutex that protects complements and model
-		std::mutex resultMutex;
+		//discretize the features once for the histogram split search
+		CART::BinnedData binned_train;
+		builder.m_binned = nullptr;
+		if(m_numBins){
+			binned_train = CART::BinnedData(data_train, m_numBins, m_epsilon);
+			builder.m_binned = &binned_train;
+		}
+		
+		//every tree gets its own random stream, seeded from the global rng.
+		//This makes the forest independent of the number of threads and the order
+		//in which the trees are finished.
+		std::vector<std::mt19937::result_type> seeds(m_numTrees);
+		for(auto& seed: seeds)
+			seed = random::globalRng()();
+		
+		std::vector<CARTree<unsigned int> > trees(m_numTrees);
+		std::vector<std::vector<std::size_t> > complements(m_numTrees);
 		//Generate trees in parallel
-		auto buildFunc = [&](std::size_t t){			
-			//Setup data for this tree
-			CART::Bootstrap<blas::matrix<double, blas::column_major>, UIntVector> bootstrap(random::globalRng(), data_train,labels_train, weights_train);
-			auto const& tree = builder.buildTree(random::globalRng(), bootstrap);
-			
-			std::lock_guard<std::mutex> lock(resultMutex);
-			model.addModel(tree);
-			complements.push_back(std::move(bootstrap.complement));
+		auto buildFunc = [&](std::size_t t){
+			std::mt19937 rng(seeds[t]);
+			//Setup data for this tree and build it
+			CART::Bootstrap<blas::matrix<double, blas::column_major>, UIntVector> bootstrap(rng, data_train,labels_train, weights_train);
+			trees[t] = builder.buildTree(rng, bootstrap);
+			complements[t] = std::move(bootstrap.complement);
 		};
 		threading::parallelND({m_numTrees}, {1}, buildFunc, threading::globalThreadPool());
+		for(auto const& tree: trees)
+			model.addModel(tree);
+		model.compile();
 		
 		if(m_computeOOBerror)
 			model.computeOOBerror(complements, dataset.data());
@@ -181,6 +221,8 @@ private:
 	std::size_t m_max_depth;///< maximum depth of the tree
 	double m_epsilon;///< Minimum difference between two values to be considered different
 	double m_min_impurity_split;///< stops splitting when the impority is below a threshold
+	std::size_t m_numBins;///< maximum number of bins per feature for the histogram split search, 0 for exact search
+	std::size_t m_minParallelSamples;///< nodes with at least this many points evaluate their features in parallel
 };
 
 
@@ -200,6 +242,8 @@ public:
 		m_min_impurity_split = 1e-10; 
 		m_epsilon = 1e-10;
 		m_max_features = 0;
+		m_numBins = 0;
+		m_minParallelSamples = 4096;
 	}
 
 	/// \brief From INameable: return the class name.
@@ -230,6 +274,23 @@ public:
 	/// The minimum dtsnace of features to be considered different (detault 1.e-10)
 	void epsilon(double distance) {m_epsilon = distance;}
 	
+	/// Use histograms with at most the given number of bins per feature to find the splits (default 0)
+	///
+	/// The features are discretized once before training. Nodes then find their split by scanning
+	/// the histograms of the features instead of sorting the feature values, which only checks
+	/// thresholds between the bins. Nodes holding fewer points than a feature has bins use the exact search.
+	/// The number of bins must be between 2 and 256, 0 disables histograms.
+	void setNumBins(std::size_t numBins) {
+		SHARK_RUNTIME_CHECK(numBins == 0 || (numBins >= 2 && numBins <= 256), "Number of bins must be 0 or between 2 and 256");
+		m_numBins = numBins;
+	}
+	
+	/// Set the minimum number of points of a node for which the features are evaluated in parallel (default 4096)
+	///
+	/// Smaller nodes evaluate their features sequentially, as the work does not pay off the synchronization.
+	/// The trained forest does not depend on this setting.
+	void setMinParallelSamples(std::size_t numSamples) {m_minParallelSamples = numSamples;}
+	
 	/// Return the parameter vector.
 	RealVector parameterVector() const{ return RealVector();}
 
@@ -239,7 +300,8 @@ public:
 	}
 	
 	
-	/// Train a random forest for classification.
+	/// Train a random forest for regression.
+	using AbstractWeightedTrainer<RFClassifier<RealVector> >::train;
 	void train(RFClassifier<LabelType>& model, WeightedLabeledData<RealVector,LabelType> const& dataset){
 		model.clearModels();
 		//setup treebuilder
@@ -250,27 +312,41 @@ public:
 		builder.m_min_impurity_split = m_min_impurity_split;
 		builder.m_epsilon = m_epsilon;
 		builder.m_max_features = m_max_features? m_max_features: inputDimension(dataset)/3;
+		builder.m_min_parallel_samples = m_minParallelSamples;
 		//copy data into single batch for easier lookup
 		blas::matrix<double, blas::column_major> data_train = createBatch<RealVector>(elements(dataset.inputs()));
 		auto labels_train = createBatch<LabelType>(elements(dataset.labels()));
 		auto weights_train = createBatch<double>(elements(dataset.weights()));
 		
-		std::vector<std::vector<std::size_t> > complements;
-
-		//mutex that protects complements and model
-		std::mutex resultMutex;
+		//discretize the features once for the histogram split search
+		CART::BinnedData binned_train;
+		builder.m_binned = nullptr;
+		if(m_numBins){
+			binned_train = CART::BinnedData(data_train, m_numBins, m_epsilon);
+			builder.m_binned = &binned_train;
+		}
+		
+		//every tree gets its own random stream, seeded from the global rng.
+		//This makes the forest independent of the number of threads and the order
+		//in which the trees are finished.
+		std::vector<std::mt19937::result_type> seeds(m_numTrees);
+		for(auto& seed: seeds)
+			seed = random::globalRng()();
+		
+		std::vector<CARTree<RealVector> > trees(m_numTrees);
+		std::vector<std::vector<std::size_t> > complements(m_numTrees);
 		//Generate trees in parallel
 		auto buildFunc = [&](std::size_t t){
+			std::mt19937 rng(seeds[t]);
 			//Setup data for this tree and build it
-			CART::Bootstrap<blas::matrix<double, blas::column_major>, RealMatrix> bootstrap(random::globalRng(), data_train,labels_train, weights_train);
-			auto const& tree = builder.buildTree(random::globalRng(), bootstrap);
-			
-			//write models in a  threadsafe way
-			std::lock_guard<std::mutex> lock(resultMutex);
-			model.addModel(tree);
-			complements.push_back(std::move(bootstrap.complement));
+			CART::Bootstrap<blas::matrix<double, blas::column_major>, RealMatrix> bootstrap(rng, data_train,labels_train, weights_train);
+			trees[t] = builder.buildTree(rng, bootstrap);
+			complements[t] = std::move(bootstrap.complement);
 		};
 		threading::parallelND({m_numTrees}, {1}, buildFunc, threading::globalThreadPool());
+		for(auto const& tree: trees)
+			model.addModel(tree);
+		model.compile();
 		
 		if(m_computeOOBerror)
 			model.computeOOBerror(complements,dataset.data());
@@ -291,6 +367,8 @@ private:
 	std::size_t m_max_depth;///< maximum depth of the tree
 	double m_epsilon;///< Minimum difference between two values to be considered different
 	double m_min_impurity_split;///< stops splitting when the impority is below a threshold
+	std::size_t m_numBins;///< maximum number of bins per feature for the histogram split search, 0 for exact search
+	std::size_t m_minParallelSamples;///< nodes with at least this many points evaluate their features in parallel
 };
 
 
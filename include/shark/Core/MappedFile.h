@@ -0,0 +1,66 @@
+/*!
+ * 
+ *
+ * \brief       Read-only access to the contents of a file by memory mapping
+ * 
+ * 
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ * 
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ * 
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_CORE_MAPPEDFILE_H
+#define SHARK_CORE_MAPPEDFILE_H
+
+#include <shark/Core/DLLSupport.h>
+#include <memory>
+#include <string>
+
+namespace shark{
+/// \brief Read-only view of the contents of a file.
+///
+/// Regular files are memory mapped, thus the contents are only loaded
+/// by the operating system when they are accessed and do not need to
+/// fit into memory. Other files, for example pipes, are read into memory.
+/// The contents stay valid until the object is destroyed.
+class MappedFile{
+public:
+	/// \brief Opens the file for reading. Throws an exception if this is not possible.
+	SHARK_EXPORT_SYMBOL MappedFile(std::string const& path);
+	SHARK_EXPORT_SYMBOL ~MappedFile();
+
+	/// \brief Pointer to the first character of the file.
+	SHARK_EXPORT_SYMBOL char const* begin() const;
+	/// \brief Pointer past the last character of the file.
+	SHARK_EXPORT_SYMBOL char const* end() const;
+	/// \brief Size of the file in bytes.
+	std::size_t size() const{
+		return end() - begin();
+	}
+private:
+	struct Impl;//Pimpl-Idiom to prevent having to include the boost iostreams headers
+	std::unique_ptr<Impl> m_impl;
+};
+}
+
+#endif 
@@ -74,6 +74,12 @@ public:
 			m_numElements *= dim;
 		}
 	}
+	Shape(std::vector<std::size_t> const& dims): m_dims(dims){
+		m_numElements = 1;
+		for(auto dim: m_dims){
+			m_numElements *= dim;
+		}
+	}
 	std::size_t size()const{
 		return m_dims.size();
 	}
@@ -38,6 +38,10 @@
 #include <vector>
 namespace shark{
 /// \brief Class for opening zip files for reading
+///
+/// Files can be read from several threads at the same time. Access to the archive is serialized,
+/// but files compressed with deflate, the default method of zip, are decompressed by the
+/// reading threads in parallel.
 class ZipReader{
 public:
 	/// \brief Opens an unencrpyted zip-file for reading.
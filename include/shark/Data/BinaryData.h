@@ -0,0 +1,212 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Binary file format for datasets which can be loaded without parsing
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_BINARYDATA_H
+#define SHARK_DATA_BINARYDATA_H
+
+#include <shark/Core/DLLSupport.h>
+#include <shark/Core/MappedFile.h>
+#include <shark/Data/Dataset.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shark {
+
+/**
+ * \ingroup shark_globals
+ *
+ * @{
+ */
+
+/// \brief Read-only access to a dataset stored in the binary data format.
+///
+/// \par
+/// The binary data format stores the batches of a Data or LabeledData object in the
+/// memory layout of the batches, such that no parsing is needed to load them.
+/// A file consists of
+/// - a header with a magic number, the format version, the type of the inputs
+///   and labels, the number of elements and batches, and the shapes of inputs and labels,
+/// - a table holding for every batch its size, its number of nonzeros and the positions of
+///   the payloads of its inputs and labels in the file,
+/// - the payloads of the batches, every payload starting at a multiple of 64 bytes.
+///
+/// Dense inputs and vector labels are stored as row-major matrices of doubles and class
+/// labels as 32 bit unsigned integers. Sparse inputs are stored in compressed sparse row
+/// format: the row offsets (one more than the size of the batch), the column indices, both as
+/// 64 bit unsigned integers, followed by the values. All values are stored in the byte order
+/// of the machine writing the file, files are rejected on machines with a different byte order.
+///
+/// \par
+/// The file is mapped into memory and the batches are returned as views of the mapped memory,
+/// therefore opening a file with dense inputs takes constant time and pages are only read by the
+/// operating system when a batch is accessed. The row offsets and column indices of sparse inputs
+/// are checked when the file is opened, such that the views are valid compressed sparse rows. The views are valid as long as the object is alive.
+/// Files are written by exportBinaryData and can be copied into Data objects by importBinaryData.
+class BinaryDataFile{
+public:
+	/// \brief Storage format of the inputs.
+	enum InputFormat{
+		DenseInputs = 0,
+		SparseInputs = 1
+	};
+	/// \brief Storage format of the labels.
+	enum LabelFormat{
+		NoLabels = 0,
+		ClassLabels = 1,
+		DenseLabels = 2
+	};
+
+	typedef blas::dense_matrix_adaptor<double const, blas::row_major, blas::continuous_dense_tag, blas::cpu_tag> DenseBatch;
+	typedef blas::dense_vector_adaptor<unsigned int const, blas::continuous_dense_tag, blas::cpu_tag> ClassLabelBatch;
+	typedef blas::sparse_matrix_storage<double const, std::uint64_t const> SparseBatch;
+
+	/// \brief Maps the file into memory and checks its header.
+	SHARK_EXPORT_SYMBOL explicit BinaryDataFile(std::string const& fn);
+
+	InputFormat inputFormat() const{
+		return m_inputFormat;
+	}
+	LabelFormat labelFormat() const{
+		return m_labelFormat;
+	}
+	/// \brief Shape of the inputs. For sparse inputs the number of columns.
+	Shape const& inputShape() const{
+		return m_inputShape;
+	}
+	/// \brief Shape of the labels. For class labels the number of classes.
+	Shape const& labelShape() const{
+		return m_labelShape;
+	}
+	/// \brief Number of elements stored in the file.
+	std::size_t numberOfElements() const{
+		return m_numberOfElements;
+	}
+	/// \brief Number of batches stored in the file.
+	std::size_t numberOfBatches() const{
+		return m_batches.size();
+	}
+	/// \brief Number of elements of batch b.
+	std::size_t batchSize(std::size_t b) const{
+		return m_batches[b].size;
+	}
+	/// \brief Number of nonzeros of the sparse inputs of batch b.
+	std::size_t nonzeros(std::size_t b) const{
+		return m_batches[b].nonzeros;
+	}
+
+	/// \brief Returns the dense inputs of batch b, one row per element.
+	DenseBatch denseInputs(std::size_t b) const{
+		SHARK_RUNTIME_CHECK(m_inputFormat == DenseInputs, "The inputs are not dense");
+		return DenseBatch(payload<double>(m_batches[b].inputOffset), batchSize(b), m_inputShape.numElements());
+	}
+
+	/// \brief Returns the compressed sparse row storage of the inputs of batch b.
+	///
+	/// The nonzeros of row i are stored at the positions major_indices_begin[i],...,major_indices_end[i]-1.
+	SparseBatch sparseInputs(std::size_t b) const{
+		SHARK_RUNTIME_CHECK(m_inputFormat == SparseInputs, "The inputs are not sparse");
+		std::uint64_t const* offsets = payload<std::uint64_t>(m_batches[b].inputOffset);
+		std::uint64_t const* indices = offsets + batchSize(b) + 1;
+		double const* values = reinterpret_cast<double const*>(indices + nonzeros(b));
+		return SparseBatch(values, indices, offsets, offsets + 1, nonzeros(b));
+	}
+
+	/// \brief Returns the class labels of batch b.
+	ClassLabelBatch classLabels(std::size_t b) const{
+		SHARK_RUNTIME_CHECK(m_labelFormat == ClassLabels, "The file does not store class labels");
+		return ClassLabelBatch(payload<unsigned int>(m_batches[b].labelOffset), batchSize(b), 1);
+	}
+
+	/// \brief Returns the vector labels of batch b, one row per element.
+	DenseBatch denseLabels(std::size_t b) const{
+		SHARK_RUNTIME_CHECK(m_labelFormat == DenseLabels, "The file does not store vector labels");
+		return DenseBatch(payload<double>(m_batches[b].labelOffset), batchSize(b), m_labelShape.numElements());
+	}
+
+private:
+	/// \brief Entry of the batch table.
+	struct BatchEntry{
+		std::uint64_t size;///< number of elements
+		std::uint64_t nonzeros;///< number of nonzeros of sparse inputs, 0 for dense inputs
+		std::uint64_t inputOffset;///< position of the inputs in the file
+		std::uint64_t labelOffset;///< position of the labels in the file, 0 without labels
+	};
+
+	template<class T>
+	T const* payload(std::uint64_t offset) const{
+		return reinterpret_cast<T const*>(m_file.begin() + offset);
+	}
+
+	MappedFile m_file;
+	InputFormat m_inputFormat;
+	LabelFormat m_labelFormat;
+	Shape m_inputShape;
+	Shape m_labelShape;
+	std::size_t m_numberOfElements;
+	std::vector<BatchEntry> m_batches;
+};
+
+/// \brief Writes unlabeled data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(Data<RealVector> const& data, std::string const& fn);
+/// \brief Writes unlabeled sparse data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(Data<CompressedRealVector> const& data, std::string const& fn);
+/// \brief Writes classification data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(LabeledData<RealVector, unsigned int> const& data, std::string const& fn);
+/// \brief Writes sparse classification data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(LabeledData<CompressedRealVector, unsigned int> const& data, std::string const& fn);
+/// \brief Writes regression data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(LabeledData<RealVector, RealVector> const& data, std::string const& fn);
+/// \brief Writes sparse regression data in the binary data format.
+SHARK_EXPORT_SYMBOL void exportBinaryData(LabeledData<CompressedRealVector, RealVector> const& data, std::string const& fn);
+
+/// \brief Reads unlabeled data from a file in the binary data format.
+///
+/// The batches of the dataset are the batches stored in the file. They are copied in parallel.
+SHARK_EXPORT_SYMBOL void importBinaryData(Data<RealVector>& data, std::string const& fn);
+/// \brief Reads unlabeled sparse data from a file in the binary data format.
+SHARK_EXPORT_SYMBOL void importBinaryData(Data<CompressedRealVector>& data, std::string const& fn);
+/// \brief Reads classification data from a file in the binary data format.
+SHARK_EXPORT_SYMBOL void importBinaryData(LabeledData<RealVector, unsigned int>& data, std::string const& fn);
+/// \brief Reads sparse classification data from a file in the binary data format.
+SHARK_EXPORT_SYMBOL void importBinaryData(LabeledData<CompressedRealVector, unsigned int>& data, std::string const& fn);
+/// \brief Reads regression data from a file in the binary data format.
+SHARK_EXPORT_SYMBOL void importBinaryData(LabeledData<RealVector, RealVector>& data, std::string const& fn);
+/// \brief Reads sparse regression data from a file in the binary data format.
+SHARK_EXPORT_SYMBOL void importBinaryData(LabeledData<CompressedRealVector, RealVector>& data, std::string const& fn);
+
+/** @}*/
+
+}
+#endif
@@ -166,12 +166,9 @@ CVFolds<LabeledData<I,L> > createCVSameSizeBalanced(
 	batchPartitioning(validationSize,partitionStart,batchSizes,batchSize);
 
 
-	LabeledData<I,L> newSet(batchSizes, set.shape());//set of empty batches
-	DataView<LabeledData<I,L> > setView(set);//fast access to single elements of the original set
-	std::vector<std::size_t> validationSetStart = partitionStart;//current index for the batch of every fold
-	//partition classes into the validation subsets of newSet
+	//partition classes into the validation subsets
 	std::size_t fold = 0;//current fold
-	std::vector<std::vector<std::size_t> > batchElements(numberOfPartitions);
+	std::vector<std::vector<std::size_t> > foldElements(numberOfPartitions);
 
 	//initialize the list of position indices which can later be used to re-create the fold (via createCV(Fully)Indexed)
 	if ( cv_indices != NULL ) {
@@ -185,9 +182,7 @@ CVFolds<LabeledData<I,L> > createCVSameSizeBalanced(
 	for (std::size_t c = 0; c != numClasses; c++) {
 		for (std::size_t i = 0; i != members[c].size(); i++) {
 			std::size_t oldPos = members[c][i];
-			std::size_t batchNumber = validationSetStart[fold];
-
-			batchElements[fold].push_back(oldPos);
+			foldElements[fold].push_back(oldPos);
 
 			if ( cv_indices != NULL ) {
 				cv_indices->first[ j ] = oldPos; //store the position in which the (now) i-th sample previously resided
@@ -195,13 +190,6 @@ CVFolds<LabeledData<I,L> > createCVSameSizeBalanced(
 				// old: //(*cv_indices)[ oldPos ] = fold; //store in vector to recreate partition if desired
 			}
 
-			//if all elements for the current batch are found, create it
-			if (batchElements[fold].size() == batchSizes[batchNumber]) {
-				newSet[validationSetStart[fold]] = subBatch(setView,batchElements[fold]);
-				batchElements[fold].clear();
-				++validationSetStart[fold];
-			}
-
 			fold = (fold+1) % numberOfPartitions;
 
 			j++;
@@ -209,6 +197,14 @@ CVFolds<LabeledData<I,L> > createCVSameSizeBalanced(
 	}
 	SHARK_ASSERT( j == numInputs );
 
+	//copy the elements of the folds one after another into the new set
+	std::vector<std::size_t> order;
+	order.reserve(numInputs);
+	for (std::size_t f = 0; f != numberOfPartitions; ++f) {
+		order.insert(order.end(), foldElements[f].begin(), foldElements[f].end());
+	}
+	LabeledData<I,L> newSet = toDataset(subset(elements(set), order), batchSizes);
+
 	//swap old and new set
 	swap(set, newSet);
 
@@ -383,23 +379,18 @@ CVFolds<LabeledData<I,L> > createCVIndexed(
 	std::vector<std::size_t> batchSizes;
 	detail::batchPartitioning(validationSize,partitionStart,batchSizes,batchSize);
 
-	//construct a new set with the correct batch format from the old set
-	LabeledData<I,L> newSet(batchSizes, set.shape());
-	DataView<LabeledData<I,L> > setView(set); //fast access to single elements of the original set
-	std::vector<std::size_t> validationSetStart = partitionStart; //current index for the batch of every partition
-	std::vector<std::vector<std::size_t> > batchElements(numberOfPartitions);
+	//order the elements by partition, keeping their order inside the partitions
+	std::vector<std::size_t> partitionPosition(numberOfPartitions, 0);
+	for (std::size_t partition = 1; partition != numberOfPartitions; partition++) {
+		partitionPosition[partition] = partitionPosition[partition - 1] + validationSize[partition - 1];
+	}
+	std::vector<std::size_t> order(numInputs);
 	for (std::size_t input = 0; input != numInputs; input++) {
-		std::size_t partition = indices[input];
-		batchElements[partition].push_back(input);
-
-		//if all elements for the current batch are found, create it
-		std::size_t batchNumber = validationSetStart[partition];
-		if (batchElements[partition].size() == batchSizes[batchNumber]) {
-			newSet[validationSetStart[partition]] = subBatch(setView,batchElements[partition]);
-			batchElements[partition].clear();
-			++validationSetStart[partition];
-		}
+		order[partitionPosition[indices[input]]++] = input;
 	}
+
+	//construct a new set with the correct batch format from the old set
+	LabeledData<I,L> newSet = toDataset(subset(elements(set), order), batchSizes);
 	swap(set, newSet);
 	//now we only need to create the subset itself
 	return CVFolds<LabeledData<I,L> >(set,partitionStart);
@@ -0,0 +1,575 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Dataset storing all elements in a single contiguous container
+ *
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_CONTIGUOUSDATA_H
+#define SHARK_DATA_CONTIGUOUSDATA_H
+
+#include <shark/Data/Dataset.h>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace shark {
+
+namespace detail{
+/// \brief The single container holding all elements of a ContiguousData object.
+///
+/// Arithmetic types are stored as entries of one vector, batches are ranges of the vector.
+template<class T>
+struct ContiguousStorage{
+	static_assert(std::is_arithmetic<T>::value, "ContiguousData stores dense vectors and arithmetic types");
+	typedef blas::vector<T> type;
+
+	static type create(Shape const&, std::size_t numElements){
+		return type(numElements);
+	}
+	static std::size_t size(type const& storage){
+		return storage.size();
+	}
+	template<class S>
+	static auto batch(S& storage, std::size_t start, std::size_t end)->decltype(subrange(storage, start, end)){
+		return subrange(storage, start, end);
+	}
+	template<class S>
+	static auto element(S& storage, std::size_t i)->decltype(storage(i)){
+		return storage(i);
+	}
+};
+
+/// \brief Dense vectors are stored as rows of one matrix, batches are ranges of rows of the matrix.
+template<class T>
+struct ContiguousStorage<blas::vector<T> >{
+	typedef blas::matrix<T, blas::row_major> type;
+
+	static type create(Shape const& shape, std::size_t numElements){
+		return type(numElements, shape.numElements());
+	}
+	static std::size_t size(type const& storage){
+		return storage.size1();
+	}
+	template<class S>
+	static auto batch(S& storage, std::size_t start, std::size_t end)->decltype(rows(storage, start, end)){
+		return rows(storage, start, end);
+	}
+	template<class S>
+	static auto element(S& storage, std::size_t i)->decltype(row(storage, i)){
+		return row(storage, i);
+	}
+};
+}
+
+template<class DatasetType>
+class ContiguousDataElements;
+
+/// \brief Dataset storing all elements in a single container.
+///
+/// In contrast to Data, which allocates every batch on its own and shares it between datasets through a pointer per batch,
+/// ContiguousData allocates one matrix, the arena, holding all elements as rows. The batches are
+/// ranges of rows of the arena and are returned as proxies referencing it, so accessing a batch copies nothing.
+/// Arithmetic types, e.g. class labels, are stored in a single vector in the same way.
+///
+/// Subsets are lazy: a subset shares the arena with the dataset it was created from and only stores
+/// the rows of its batches in the arena. Thus creating a subset does not allocate anything per batch except
+/// for its position, and changes of the elements of a subset are visible in all datasets sharing the arena.
+/// makeIndependent() copies the batches of a subset into a new arena.
+///
+/// elements() returns a view of the single elements. If the batches are consecutive ranges of the arena,
+/// which is the case for all datasets not created as a subset, the i-th element is the i-th row of
+/// the used range of the arena and iterating over the elements is a linear scan over the arena.
+///
+/// The batches are not of type Data<Type>::value_type, so they can not be passed to functions taking a reference to a batch
+/// of a Data object. ContiguousData is converted from and to Data by copying the batches in parallel.
+/// Labeled data is stored by ContiguousLabeledData.
+template<class Type>
+class ContiguousData{
+private:
+	typedef detail::ContiguousStorage<Type> Storage;
+public:
+	typedef typename Storage::type storage_type;
+	typedef std::size_t size_type;
+	typedef Type element_type;
+	typedef typename Batch<Type>::shape_type shape_type;
+	/// \brief Type of a copy of a batch.
+	typedef typename Batch<Type>::type value_type;
+	typedef decltype(Storage::batch(std::declval<storage_type&>(), 0, 0)) reference;
+	typedef decltype(Storage::batch(std::declval<storage_type const&>(), 0, 0)) const_reference;
+	typedef decltype(Storage::element(std::declval<storage_type&>(), 0)) element_reference;
+	typedef decltype(Storage::element(std::declval<storage_type const&>(), 0)) const_element_reference;
+	typedef std::vector<size_type> IndexSet;
+
+	typedef IndexingIterator<ContiguousData> iterator;
+	typedef IndexingIterator<ContiguousData const> const_iterator;
+
+	/// \brief Constructs an empty set.
+	ContiguousData():m_numElements(0), m_consecutive(true){}
+
+	/// \brief Constructs a set holding a specific number of elements of a given shape.
+	///
+	/// @param numElements number of data points stored in the dataset
+	/// @param shape the shape of the elements to create
+	/// @param batchSize the size of the batches. if this is 0, the size is unlimited
+	explicit ContiguousData(size_type numElements, shape_type const& shape, size_type batchSize = constants::DefaultBatchSize)
+	: m_shape(shape){
+		allocate(detail::optimalBatchSizes(numElements, batchSize));
+	}
+
+	/// \brief Constructs a set with a given shape and a chosen partitioning.
+	///
+	/// @param partitioning batch sizes of the dataset
+	/// @param shape the shape of the elements to create
+	explicit ContiguousData(std::vector<size_type> const& partitioning, shape_type const& shape)
+	: m_shape(shape){
+		allocate(partitioning);
+	}
+
+	/// \brief Copies the elements of a Data object into a new arena, keeping its partitioning.
+	///
+	/// The batches are copied in parallel.
+	explicit ContiguousData(Data<Type> const& data)
+	: m_shape(data.shape()){
+		allocate(data.getPartitioning());
+		threading::parallelND({size()}, {1}, [&](std::size_t b){
+			noalias((*this)[b]) = data[b];
+		}, threading::globalThreadPool());
+	}
+
+	/// \brief Copies the batches into a Data object with the same partitioning.
+	///
+	/// The batches are copied in parallel.
+	Data<Type> toData() const{
+		Data<Type> data(getPartitioning(), m_shape);
+		threading::parallelND({size()}, {1}, [&](std::size_t b){
+			noalias(data[b]) = (*this)[b];
+		}, threading::globalThreadPool());
+		return data;
+	}
+
+	/// \brief Returns the number of batches of the set.
+	size_type size() const{
+		return m_batchStart.size();
+	}
+	/// \brief Returns the total number of elements.
+	size_type numberOfElements() const{
+		return m_numElements;
+	}
+	/// \brief Check whether the set is empty.
+	bool empty() const{
+		return m_batchStart.empty();
+	}
+
+	///\brief Returns the shape of the elements in the dataset.
+	shape_type const& shape() const{
+		return m_shape;
+	}
+	///\brief Sets the shape of the elements in the dataset.
+	void setShape(shape_type const& shape){
+		m_shape = shape;
+	}
+
+	// BATCH ACCESS
+	reference operator[](size_type i){
+		SIZE_CHECK(i < size());
+		return Storage::batch(*m_storage, m_batchStart[i], m_batchStart[i] + m_batchSize[i]);
+	}
+	const_reference operator[](size_type i) const{
+		SIZE_CHECK(i < size());
+		return Storage::batch(static_cast<storage_type const&>(*m_storage), m_batchStart[i], m_batchStart[i] + m_batchSize[i]);
+	}
+	iterator begin(){
+		return iterator(*this, 0);
+	}
+	const_iterator begin()const{
+		return const_iterator(*this, 0);
+	}
+	iterator end(){
+		return iterator(*this, size());
+	}
+	const_iterator end()const{
+		return const_iterator(*this, size());
+	}
+
+	// ELEMENT ACCESS
+
+	/// \brief Returns the i-th element of the set.
+	element_reference element(size_type i){
+		return Storage::element(*m_storage, row(i));
+	}
+	/// \brief Returns the i-th element of the set.
+	const_element_reference element(size_type i) const{
+		return Storage::element(static_cast<storage_type const&>(*m_storage), row(i));
+	}
+
+	/// \brief Returns the arena, which may hold elements of other datasets sharing it.
+	storage_type const& storage() const{
+		return *m_storage;
+	}
+
+	/// \brief Creates a vector with the batch sizes of every batch.
+	std::vector<size_type> getPartitioning()const{
+		return m_batchSize;
+	}
+
+	// SUBSETS
+
+	/// \brief Creates a subset of the batches indexed by indices, which shares the arena with this set.
+	ContiguousData indexedSubset(IndexSet const& indices) const{
+		ContiguousData subset;
+		subset.m_storage = m_storage;
+		subset.m_shape = m_shape;
+		subset.m_batchStart.resize(indices.size());
+		subset.m_batchSize.resize(indices.size());
+		for(std::size_t i = 0; i != indices.size(); ++i){
+			SIZE_CHECK(indices[i] < size());
+			subset.m_batchStart[i] = m_batchStart[indices[i]];
+			subset.m_batchSize[i] = m_batchSize[indices[i]];
+		}
+		subset.updatePartition();
+		return subset;
+	}
+
+	///\brief Is the container independent of all others?
+	bool isIndependent() const{
+		return !m_storage || m_storage.use_count() == 1;
+	}
+
+	///\brief Ensures that the container is independent.
+	///
+	/// If the arena is shared, the batches are copied into a new arena holding only the elements of this set.
+	void makeIndependent(){
+		if(isIndependent())
+			return;
+		ContiguousData copy(getPartitioning(), m_shape);
+		threading::parallelND({size()}, {1}, [&](std::size_t b){
+			noalias(copy[b]) = (*this)[b];
+		}, threading::globalThreadPool());
+		swap(*this, copy);
+	}
+
+	friend void swap(ContiguousData& a, ContiguousData& b){
+		using std::swap;
+		swap(a.m_storage, b.m_storage);
+		swap(a.m_shape, b.m_shape);
+		swap(a.m_batchStart, b.m_batchStart);
+		swap(a.m_batchSize, b.m_batchSize);
+		swap(a.m_partition, b.m_partition);
+		swap(a.m_numElements, b.m_numElements);
+		swap(a.m_consecutive, b.m_consecutive);
+	}
+private:
+	/// \brief Allocates the arena holding the batches of the partitioning one after another.
+	void allocate(std::vector<size_type> const& partitioning){
+		m_batchSize = partitioning;
+		m_batchStart.resize(partitioning.size());
+		std::size_t start = 0;
+		for(std::size_t b = 0; b != partitioning.size(); ++b){
+			m_batchStart[b] = start;
+			start += partitioning[b];
+		}
+		m_storage = std::make_shared<storage_type>(Storage::create(m_shape, start));
+		updatePartition();
+	}
+
+	/// \brief Updates the lookup of the elements after the batches changed.
+	void updatePartition(){
+		m_partition = detail::BatchPartition(m_batchSize);
+		m_numElements = m_partition.numberOfElements();
+		m_consecutive = true;
+		for(std::size_t b = 1; b < m_batchStart.size(); ++b){
+			if(m_batchStart[b] != m_batchStart[b - 1] + m_batchSize[b - 1])
+				m_consecutive = false;
+		}
+	}
+
+	/// \brief Row of the arena holding the i-th element.
+	std::size_t row(size_type i) const{
+		SIZE_CHECK(i < numberOfElements());
+		if(m_consecutive)
+			return m_batchStart[0] + i;
+		std::size_t b = m_partition.batch(i);
+		return m_batchStart[b] + m_partition.positionInBatch(i, b);
+	}
+
+	std::shared_ptr<storage_type> m_storage;///< the arena holding the elements
+	shape_type m_shape;///< shape of a datapoint
+	std::vector<size_type> m_batchStart;///< first row of every batch in the arena
+	std::vector<size_type> m_batchSize;///< number of elements of every batch
+	detail::BatchPartition m_partition;///< maps elements to their batches
+	size_type m_numElements;
+	bool m_consecutive;///< true if the batches are consecutive ranges of the arena
+};
+
+/// \brief Labeled dataset storing inputs and labels in two arenas.
+///
+/// The counterpart of LabeledData for ContiguousData: inputs and labels are stored as two ContiguousData
+/// objects with the same partitioning. Batches and elements are returned as InputLabelPair of proxies
+/// referencing the arenas. Subsets share both arenas with the dataset they were created from.
+template<class InputT, class LabelT>
+class ContiguousLabeledData{
+public:
+	typedef InputT InputType;
+	typedef LabelT LabelType;
+	typedef ContiguousData<InputT> InputContainer;
+	typedef ContiguousData<LabelT> LabelContainer;
+	typedef typename InputContainer::IndexSet IndexSet;
+	typedef std::size_t size_type;
+	typedef InputLabelPair<InputType, LabelType> element_type;
+	typedef typename Batch<element_type>::shape_type shape_type;
+	typedef InputLabelPair<typename InputContainer::reference, typename LabelContainer::reference> reference;
+	typedef InputLabelPair<typename InputContainer::const_reference, typename LabelContainer::const_reference> const_reference;
+	typedef InputLabelPair<
+		typename InputContainer::element_reference,
+		typename LabelContainer::element_reference
+	> element_reference;
+	typedef InputLabelPair<
+		typename InputContainer::const_element_reference,
+		typename LabelContainer::const_element_reference
+	> const_element_reference;
+
+	typedef IndexingIterator<ContiguousLabeledData> iterator;
+	typedef IndexingIterator<ContiguousLabeledData const> const_iterator;
+
+	/// \brief Constructs an empty set.
+	ContiguousLabeledData(){}
+
+	/// \brief Constructs a set holding a specific number of elements of a given shape.
+	///
+	/// @param numElements number of data points stored in the dataset
+	/// @param shape the shape of the elements to create
+	/// @param batchSize the size of the batches. if this is 0, the size is unlimited
+	explicit ContiguousLabeledData(size_type numElements, shape_type const& shape, size_type batchSize = constants::DefaultBatchSize)
+	: m_data(numElements, shape.input, batchSize), m_label(numElements, shape.label, batchSize){}
+
+	/// \brief Constructs a set with a given shape and a chosen partitioning.
+	///
+	/// @param partitioning batch sizes of the dataset
+	/// @param shape the shape of the elements to create
+	explicit ContiguousLabeledData(std::vector<size_type> const& partitioning, shape_type const& shape)
+	: m_data(partitioning, shape.input), m_label(partitioning, shape.label){}
+
+	/// \brief Copies inputs and labels of a LabeledData object into new arenas, keeping its partitioning.
+	explicit ContiguousLabeledData(LabeledData<InputT, LabelT> const& data)
+	: m_data(data.inputs()), m_label(data.labels()){}
+
+	/// \brief Copies the batches into a LabeledData object with the same partitioning.
+	LabeledData<InputT, LabelT> toLabeledData() const{
+		return LabeledData<InputT, LabelT>(m_data.toData(), m_label.toData());
+	}
+
+	///\brief Access to inputs as a separate container.
+	InputContainer const& inputs() const{
+		return m_data;
+	}
+	///\brief Access to inputs as a separate container.
+	InputContainer& inputs(){
+		return m_data;
+	}
+	///\brief Access to labels as a separate container.
+	LabelContainer const& labels() const{
+		return m_label;
+	}
+	///\brief Access to labels as a separate container.
+	LabelContainer& labels(){
+		return m_label;
+	}
+
+	/// \brief Returns the number of batches of the set.
+	size_type size() const{
+		return m_data.size();
+	}
+	/// \brief Returns the total number of elements.
+	size_type numberOfElements() const{
+		return m_data.numberOfElements();
+	}
+	/// \brief Check whether the set is empty.
+	bool empty() const{
+		return m_data.empty();
+	}
+
+	///\brief Returns the shape of the elements in the dataset.
+	shape_type shape() const{
+		return {m_data.shape(), m_label.shape()};
+	}
+	///\brief Sets the shape of the elements in the dataset.
+	void setShape(shape_type const& shape){
+		m_data.setShape(shape.input);
+		m_label.setShape(shape.label);
+	}
+
+	// BATCH ACCESS
+	reference operator[](size_type i){
+		return {m_data[i], m_label[i]};
+	}
+	const_reference operator[](size_type i) const{
+		return {m_data[i], m_label[i]};
+	}
+	iterator begin(){
+		return iterator(*this, 0);
+	}
+	const_iterator begin()const{
+		return const_iterator(*this, 0);
+	}
+	iterator end(){
+		return iterator(*this, size());
+	}
+	const_iterator end()const{
+		return const_iterator(*this, size());
+	}
+
+	// ELEMENT ACCESS
+
+	/// \brief Returns the i-th element of the set.
+	element_reference element(size_type i){
+		return {m_data.element(i), m_label.element(i)};
+	}
+	/// \brief Returns the i-th element of the set.
+	const_element_reference element(size_type i) const{
+		return {m_data.element(i), m_label.element(i)};
+	}
+
+	/// \brief Creates a vector with the batch sizes of every batch.
+	std::vector<size_type> getPartitioning()const{
+		return m_data.getPartitioning();
+	}
+
+	// SUBSETS
+
+	/// \brief Creates a subset of the batches indexed by indices, which shares the arenas with this set.
+	ContiguousLabeledData indexedSubset(IndexSet const& indices) const{
+		ContiguousLabeledData subset;
+		subset.m_data = m_data.indexedSubset(indices);
+		subset.m_label = m_label.indexedSubset(indices);
+		return subset;
+	}
+
+	///\brief Is the container independent of all others?
+	bool isIndependent() const{
+		return m_data.isIndependent() && m_label.isIndependent();
+	}
+
+	///\brief Ensures that the container is independent.
+	void makeIndependent(){
+		m_data.makeIndependent();
+		m_label.makeIndependent();
+	}
+
+	friend void swap(ContiguousLabeledData& a, ContiguousLabeledData& b){
+		swap(a.m_data, b.m_data);
+		swap(a.m_label, b.m_label);
+	}
+private:
+	InputContainer m_data;///< the inputs
+	LabelContainer m_label;///< the labels
+};
+
+///\brief  Return the input dimensionality of a labeled dataset.
+template <class InputType, class LabelType>
+std::size_t inputDimension(ContiguousLabeledData<InputType, LabelType> const& dataset){
+	return dataset.inputs().shape().numElements();
+}
+
+///\brief  Return the label/output dimensionality of a labeled dataset.
+template <class InputType, class LabelType>
+std::size_t labelDimension(ContiguousLabeledData<InputType, LabelType> const& dataset){
+	return dataset.labels().shape().numElements();
+}
+
+/// \brief View of the elements of a ContiguousData or ContiguousLabeledData object.
+///
+/// The view stores a copy of the dataset, which shares the arena. Thus it is cheap to create.
+template<class DatasetType>
+class ContiguousDataElements{
+public:
+	typedef typename std::remove_const<DatasetType>::type dataset_type;
+	typedef typename dataset_type::element_type value_type;
+	typedef typename std::conditional<
+		std::is_const<DatasetType>::value,
+		typename dataset_type::const_element_reference,
+		typename dataset_type::element_reference
+	>::type reference;
+	typedef typename dataset_type::const_element_reference const_reference;
+	typedef IndexingIterator<ContiguousDataElements> iterator;
+	typedef IndexingIterator<ContiguousDataElements const> const_iterator;
+
+	ContiguousDataElements(DatasetType& dataset):m_dataset(dataset){}
+
+	reference operator[](std::size_t i){
+		return static_cast<DatasetType&>(m_dataset).element(i);
+	}
+	const_reference operator[](std::size_t i) const{
+		return m_dataset.element(i);
+	}
+	std::size_t size() const{
+		return m_dataset.numberOfElements();
+	}
+
+	iterator begin(){
+		return iterator(*this, 0);
+	}
+	const_iterator begin() const{
+		return const_iterator(*this, 0);
+	}
+	iterator end(){
+		return iterator(*this, size());
+	}
+	const_iterator end() const{
+		return const_iterator(*this, size());
+	}
+private:
+	dataset_type m_dataset;
+};
+
+/// \brief Returns a view of the elements of the dataset.
+template<class T>
+ContiguousDataElements<ContiguousData<T> > elements(ContiguousData<T>& data){
+	return ContiguousDataElements<ContiguousData<T> >(data);
+}
+/// \brief Returns a view of the elements of the dataset.
+template<class T>
+ContiguousDataElements<ContiguousData<T> const> elements(ContiguousData<T> const& data){
+	return ContiguousDataElements<ContiguousData<T> const>(data);
+}
+/// \brief Returns a view of the elements of the dataset.
+template<class I, class L>
+ContiguousDataElements<ContiguousLabeledData<I, L> > elements(ContiguousLabeledData<I, L>& data){
+	return ContiguousDataElements<ContiguousLabeledData<I, L> >(data);
+}
+/// \brief Returns a view of the elements of the dataset.
+template<class I, class L>
+ContiguousDataElements<ContiguousLabeledData<I, L> const> elements(ContiguousLabeledData<I, L> const& data){
+	return ContiguousDataElements<ContiguousLabeledData<I, L> const>(data);
+}
+
+}
+#endif
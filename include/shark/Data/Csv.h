@@ -44,9 +44,16 @@
 
 #include <shark/Core/DLLSupport.h>
 #include <shark/Data/Dataset.h>
+#include <shark/Data/Generator.h>
+#include <shark/Core/MappedFile.h>
 
+#include <boost/utility/string_ref.hpp>
+#include <algorithm>
 #include <fstream>
+#include <initializer_list>
+#include <istream>
 #include <string>
+#include <vector>
 
 namespace shark {
 
@@ -68,6 +75,91 @@ enum LabelPosition {
 	LAST_COLUMN,
 };
 
+/// \brief Describes the types of the columns of a CSV file with mixed content.
+///
+/// \par
+/// Every column of the file is either an input feature, the label, or ignored.
+/// Numeric columns hold numbers; empty fields and '?' are missing values and read as NaN,
+/// as expected by e.g. the MissingFeatureSvmTrainer. Categorical columns hold arbitrary strings, which are
+/// one-hot encoded: the column adds one input dimension per category. A missing
+/// categorical value sets all of its dimensions to NaN. ClassLabel columns hold the classes as strings,
+/// they are numbered by their categories. Target columns hold the numeric labels of regression.
+///
+/// \par
+/// The categories of a column are its distinct values, sorted by value if they are numbers and by
+/// name otherwise, numbers first. Surrounding double quotes are removed. The categories are
+/// collected while the records are counted and stored in the schema. If the categories of a column are
+/// already set, e.g. because the schema was used to import the training data, they are kept. Then values
+/// which are not in the list are read as missing for inputs and are an error for labels. This way, training and test data
+/// are encoded in the same way.
+class CsvSchema{
+public:
+	/// \brief Type of a column.
+	enum ColumnType{
+		Numeric,///< numeric input
+		Categorical,///< one-hot encoded input
+		ClassLabel,///< class label given by strings
+		Target,///< numeric label
+		Ignored///< column that is not read
+	};
+
+	CsvSchema(){}
+
+	/// \brief Creates the schema of a file with the given column types.
+	CsvSchema(std::vector<ColumnType> const& types)
+	: m_types(types), m_categories(types.size()){}
+	CsvSchema(std::initializer_list<ColumnType> types)
+	: m_types(types), m_categories(types.size()){}
+
+	/// \brief Creates the schema of a file with numColumns columns of the same type.
+	explicit CsvSchema(std::size_t numColumns, ColumnType type = Numeric)
+	: m_types(numColumns, type), m_categories(numColumns){}
+
+	/// \brief Number of columns in the file.
+	std::size_t numberOfColumns() const{
+		return m_types.size();
+	}
+
+	ColumnType columnType(std::size_t column) const{
+		SIZE_CHECK(column < numberOfColumns());
+		return m_types[column];
+	}
+	void setColumnType(std::size_t column, ColumnType type){
+		SIZE_CHECK(column < numberOfColumns());
+		m_types[column] = type;
+	}
+
+	/// \brief Categories of a Categorical or ClassLabel column, the i-th category is encoded as i.
+	std::vector<std::string> const& categories(std::size_t column) const{
+		SIZE_CHECK(column < numberOfColumns());
+		return m_categories[column];
+	}
+	/// \brief Sets the categories of a column. An empty list lets the importer collect the categories.
+	void setCategories(std::size_t column, std::vector<std::string> const& categories){
+		SIZE_CHECK(column < numberOfColumns());
+		m_categories[column] = categories;
+	}
+
+	/// \brief Number of input dimensions, one per numeric column and one per category of categorical columns.
+	std::size_t inputDimension() const{
+		std::size_t dimension = 0;
+		for(std::size_t i = 0; i != numberOfColumns(); ++i){
+			if(m_types[i] == Numeric)
+				++dimension;
+			else if(m_types[i] == Categorical)
+				dimension += m_categories[i].size();
+		}
+		return dimension;
+	}
+	/// \brief Number of columns of the given type.
+	std::size_t numberOfColumns(ColumnType type) const{
+		return std::count(m_types.begin(), m_types.end(), type);
+	}
+private:
+	std::vector<ColumnType> m_types;
+	std::vector<std::vector<std::string> > m_categories;
+};
+
 namespace detail {
 
 // export function for unlabeled data
@@ -191,6 +283,10 @@ void exportCSV_labeled(
 
 
 // ACTUAL READ IN ROUTINES BELOW
+//
+// The parsers split the contents into chunks of lines that are parsed in parallel
+// and write the values directly into the batches of the dataset. importCSV maps
+// the file into memory instead of reading it into a string.
 
 /// \brief Import unlabeled vectors from a read-in character-separated value file.
 ///
@@ -201,7 +297,7 @@ void exportCSV_labeled(
 /// \param  maximumBatchSize   Size of batches in the dataset
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	Data<FloatVector> &data,
-	std::string const& contents,
+	boost::string_ref contents,
 	char separator = ',',
 	char comment = '#',
 	std::size_t maximumBatchSize = constants::DefaultBatchSize
@@ -216,7 +312,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize   Size of batches in the dataset
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	Data<RealVector> &data,
-	std::string const& contents,
+	boost::string_ref contents,
 	char separator = ',',
 	char comment = '#',
 	std::size_t maximumBatchSize = constants::DefaultBatchSize
@@ -231,7 +327,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize   Size of batches in the dataset
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	Data<unsigned int> &data,
-	std::string const& contents,
+	boost::string_ref contents,
 	char separator = ',',
 	char comment = '#',
 	std::size_t maximumBatchSize = constants::DefaultBatchSize
@@ -247,7 +343,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize  maximum size of a batch in the dataset after import
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	LabeledData<RealVector, unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	char separator = ',',
 	char comment = '#',
@@ -264,7 +360,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize  maximum size of a batch in the dataset after import
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	LabeledData<FloatVector, unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	char separator = ',',
 	char comment = '#',
@@ -283,7 +379,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize  maximum size of a batch in the dataset after import
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	LabeledData<RealVector, RealVector> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	std::size_t numberOfOutputs = 1,
 	char separator = ',',
@@ -302,7 +398,7 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 /// \param  maximumBatchSize  maximum size of a batch in the dataset after import
 SHARK_EXPORT_SYMBOL void csvStringToData(
 	LabeledData<FloatVector, FloatVector> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	std::size_t numberOfOutputs = 1,
 	char separator = ',',
@@ -312,6 +408,123 @@ SHARK_EXPORT_SYMBOL void csvStringToData(
 
 
 
+/// \brief Import unlabeled vectors from a read-in character-separated value file with mixed content.
+///
+/// The schema must only contain input and ignored columns. The categories found in the
+/// file are stored in the schema.
+///
+/// \param  data       Container storing the loaded data
+/// \param  contents    The read in csv-file
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By dfault it is '#'
+/// \param  maximumBatchSize   Size of batches in the dataset
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	Data<RealVector> &data,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+/// \brief Import unlabeled vectors from a read-in character-separated value file with mixed content.
+///
+/// The schema must only contain input and ignored columns. The categories found in the
+/// file are stored in the schema.
+///
+/// \param  data       Container storing the loaded data
+/// \param  contents    The read in csv-file
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By dfault it is '#'
+/// \param  maximumBatchSize   Size of batches in the dataset
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	Data<FloatVector> &data,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+
+/// \brief Import labeled data from a read-in character-separated value file with mixed content.
+///
+/// The schema must contain exactly one ClassLabel column. The categories found in the
+/// file are stored in the schema.
+///
+/// \param  dataset    Container storing the loaded data
+/// \param  contents the read-in file contents.
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Character for indicating a comment, by default '#'
+/// \param  maximumBatchSize  maximum size of a batch in the dataset after import
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	LabeledData<RealVector, unsigned int> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+/// \brief Import labeled data from a read-in character-separated value file with mixed content.
+///
+/// The schema must contain exactly one ClassLabel column. The categories found in the
+/// file are stored in the schema.
+///
+/// \param  dataset    Container storing the loaded data
+/// \param  contents the read-in file contents.
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Character for indicating a comment, by default '#'
+/// \param  maximumBatchSize  maximum size of a batch in the dataset after import
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	LabeledData<FloatVector, unsigned int> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+
+/// \brief Import regression data from a read-in character-separated value file with mixed content.
+///
+/// The schema must contain at least one Target column, the targets form the labels in the order of the columns.
+/// The categories found in the file are stored in the schema.
+///
+/// \param  dataset    Container storing the loaded data
+/// \param  contents the read-in file contents.
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Character for indicating a comment, by default '#'
+/// \param  maximumBatchSize  maximum size of a batch in the dataset after import
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	LabeledData<RealVector, RealVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+/// \brief Import regression data from a read-in character-separated value file with mixed content.
+///
+/// The schema must contain at least one Target column, the targets form the labels in the order of the columns.
+/// The categories found in the file are stored in the schema.
+///
+/// \param  dataset    Container storing the loaded data
+/// \param  contents the read-in file contents.
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Character for indicating a comment, by default '#'
+/// \param  maximumBatchSize  maximum size of a batch in the dataset after import
+SHARK_EXPORT_SYMBOL void csvStringToData(
+	LabeledData<FloatVector, FloatVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+
 /// \brief Import a Dataset from a csv file
 ///
 /// \param  data       Container storing the loaded data
@@ -329,21 +542,14 @@ void importCSV(
 	std::size_t maximumBatchSize = constants::DefaultBatchSize,
 	std::size_t titleLines = 0
 ){
-	std::ifstream stream(fn.c_str());
-	SHARK_RUNTIME_CHECK(stream, "Stream cannot be opened for reading.");
-	
-	stream.unsetf(std::ios::skipws);
-	
-	for(std::size_t i=0; i < titleLines; ++i) // ignoring the first lines
-		stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
+	MappedFile file(fn);
+	char const* begin = file.begin();
+	for(std::size_t i=0; i < titleLines && begin != file.end(); ++i){ // ignoring the first lines
+		begin = std::find(begin, file.end(), '\n');
+		if(begin != file.end()) ++begin;
+	}
 	//call the actual parser
-	csvStringToData(data,contents,separator,comment,maximumBatchSize);
+	csvStringToData(data,boost::string_ref(begin, file.end() - begin),separator,comment,maximumBatchSize);
 }
 
 /// \brief Import a labeled Dataset from a csv file
@@ -363,17 +569,9 @@ void importCSV(
 	char comment = '#',
 	std::size_t maximumBatchSize = constants::DefaultBatchSize
 ){
-	std::ifstream stream(fn.c_str());
-	SHARK_RUNTIME_CHECK(stream, "Stream cannot be opened for reading.");
-
-	stream.unsetf(std::ios::skipws);
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
+	MappedFile file(fn);
 	//call the actual parser
-	csvStringToData(data,contents,lp,separator,comment,maximumBatchSize);
+	csvStringToData(data,boost::string_ref(file.begin(), file.size()),lp,separator,comment,maximumBatchSize);
 }
 
 /// \brief Import a labeled Dataset from a csv file
@@ -395,19 +593,198 @@ void importCSV(
 	char comment = '#',
 	std::size_t maximumBatchSize = constants::DefaultBatchSize
 ){
-	std::ifstream stream(fn.c_str());
-	SHARK_RUNTIME_CHECK(stream, "Stream cannot be opened for reading.");
-
-	stream.unsetf(std::ios::skipws);
-	std::istream_iterator<char> streamBegin(stream);
-	std::string contents(//read contents of file in string
-		streamBegin,
-		std::istream_iterator<char>()
-	);
+	MappedFile file(fn);
 	//call the actual parser
-	csvStringToData(data,contents,lp, numberOfOutputs, separator,comment,maximumBatchSize);
+	csvStringToData(data,boost::string_ref(file.begin(), file.size()),lp, numberOfOutputs, separator,comment,maximumBatchSize);
 }
 
+/// \brief Import a Dataset from a csv file with mixed content
+///
+/// Works for unlabeled data, classification and regression data, depending on the columns
+/// of the schema, see CsvSchema. The categories found in the file are stored in the schema.
+///
+/// \param  data       Container storing the loaded data
+/// \param  fn         The file to be read from
+/// \param  schema     The types of the columns of the file
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By dfault it is '#'
+/// \param  maximumBatchSize   Size of batches in the dataset
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the file
+template<class DatasetType>
+void importCSV(
+	DatasetType& data,
+	std::string fn,
+	CsvSchema& schema,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0
+){
+	MappedFile file(fn);
+	char const* begin = file.begin();
+	for(std::size_t i=0; i < titleLines && begin != file.end(); ++i){ // ignoring the first lines
+		begin = std::find(begin, file.end(), '\n');
+		if(begin != file.end()) ++begin;
+	}
+	//call the actual parser
+	csvStringToData(data,boost::string_ref(begin, file.end() - begin),schema,separator,comment,maximumBatchSize);
+}
+
+// STREAMING READ IN ROUTINES BELOW
+//
+// Instead of loading the whole file, the generators read the next maximumBatchSize records
+// of the file whenever a batch is requested and start from the beginning of the file after
+// the last record. Training can start immediately and the file does not have to fit into memory.
+// Reading a block of records is serialized, parsing is not, so with cacheSize > 0 the batches
+// are parsed in parallel by the thread pool; their order might then differ from the file.
+// As the file is not read in advance, the format of the data can not be inferred from all records:
+// the number of columns is taken from the first record and the number of classes must be given.
+// Lines must end with \n or \r\n.
+
+/// \brief Streams unlabeled vectors from a csv file.
+///
+/// \param  generator  the generator returning the batches
+/// \param  fn         The file to be read from
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the file
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	Generator<RealVector>& generator,
+	std::string const& fn,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Streams unlabeled vectors from a stream in csv format.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// \param  generator  the generator returning the batches
+/// \param  stream     The stream to be read from
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the stream
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	Generator<RealVector>& generator,
+	std::istream& stream,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Streams labeled data from a csv file.
+///
+/// The labels must be integers in 0,...,numberOfClasses-1. The label -1 is read as class 0
+/// to support files with the binary labels -1/1.
+///
+/// \param  generator  the generator returning the batches
+/// \param  fn         The file to be read from
+/// \param  lp         Position of the label in the record, either first or last column
+/// \param  numberOfClasses  number of classes of the labels
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the file
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::string const& fn,
+	LabelPosition lp,
+	std::size_t numberOfClasses,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Streams labeled data from a stream in csv format.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+/// The labels must be integers in 0,...,numberOfClasses-1. The label -1 is read as class 0
+/// to support files with the binary labels -1/1.
+///
+/// \param  generator  the generator returning the batches
+/// \param  stream     The stream to be read from
+/// \param  lp         Position of the label in the record, either first or last column
+/// \param  numberOfClasses  number of classes of the labels
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the stream
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::istream& stream,
+	LabelPosition lp,
+	std::size_t numberOfClasses,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Streams regression data from a csv file.
+///
+/// \param  generator  the generator returning the batches
+/// \param  fn         The file to be read from
+/// \param  lp         Position of the label in the record, either first or last column
+/// \param  numberOfOutputs dimensionality of the labels
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the file
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::string const& fn,
+	LabelPosition lp,
+	std::size_t numberOfOutputs = 1,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Streams regression data from a stream in csv format.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// \param  generator  the generator returning the batches
+/// \param  stream     The stream to be read from
+/// \param  lp         Position of the label in the record, either first or last column
+/// \param  numberOfOutputs dimensionality of the labels
+/// \param  separator  Optional separator between entries, typically a comma, spaces ar automatically ignored
+/// \param  comment    Trailing character indicating comment line. By default it is '#'
+/// \param  maximumBatchSize   Size of the batches returned by the generator
+/// \param  titleLines   Specifies a number of lines to be skipped in the beginning of the stream
+/// \param  cacheSize  number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamCSV(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::istream& stream,
+	LabelPosition lp,
+	std::size_t numberOfOutputs = 1,
+	char separator = ',',
+	char comment = '#',
+	std::size_t maximumBatchSize = constants::DefaultBatchSize,
+	std::size_t titleLines = 0,
+	std::size_t cacheSize = 0
+);
+
 /// \brief Format unlabeled data into a character-separated value file.
 ///
 /// \param  set       Container to be exported
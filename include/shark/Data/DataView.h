@@ -39,8 +39,10 @@
 #define SHARK_DATA_DATAVIEW_H
 
 #include <shark/Core/utility/functional.h>
+#include <shark/Core/Threading/Algorithms.h>
 #include <numeric>
 #include <shark/Data/BatchInterface.h>
+#include "Impl/Dataset.inl"
 namespace shark {
 	
 	
@@ -54,9 +56,11 @@ namespace constants{
 /// changed by the user, there is no way for the Data and LabeledData classes to provide fast random access
 /// to single elements. Still, this property is needed quite often, for example for creating subsets,
 /// randomize data or tree structures. 
-/// A View stores the position of every element in a dataset. So it has constant time access to the elements but
-/// it also requires linear memory in the number of elements in the set. This is typically small compared
-/// to the size of the set itself, but construction imposes an considerable overhead.
+/// A View stores the start of every batch of the dataset and, for subsets, the index of every element
+/// in the dataset. For the usual partitionings with batches of (nearly) equal size, the batch of an element is computed
+/// in constant time, otherwise it is found by binary search over the batches. A view of the whole dataset,
+/// like the one returned by elements(), does not store anything per element, so creating it is cheap
+/// and iterating over it is a linear scan over the batches.
 ///
 /// In contrast to (Un)LabeledData, which is centered around batches, the View is centered around single elements,
 /// so its iterators iterate over the elements.
@@ -84,42 +88,20 @@ public:
 	typedef IndexingIterator<DataView> iterator;
 	typedef IndexingIterator<DataView<DatasetType> const > const_iterator;
 
-	DataView(){}
+	DataView():m_isIdentity(true){}
 	DataView(DatasetType& dataset)
-	:m_dataset(dataset),m_indices(m_dataset.numberOfElements())
-	{
-		std::size_t index = 0;
-		for(std::size_t i = 0; i != m_dataset.size(); ++i){
-			std::size_t batchSize = Batch<value_type>::size(m_dataset[i]);
-			for(std::size_t j = 0; j != batchSize; ++j,++index){
-				m_indices[index].batch = i;
-				m_indices[index].positionInBatch = j;
-				m_indices[index].datasetIndex = index;
-			}
-		}
-	}
+	:m_dataset(dataset), m_partition(m_dataset.getPartitioning()), m_isIdentity(true){}
 	
 	DataView(DatasetType&& dataset)
-	:m_dataset(std::move(dataset)),m_indices(m_dataset.numberOfElements())
-	{
-		std::size_t index = 0;
-		for(std::size_t i = 0; i != m_dataset.size(); ++i){
-			std::size_t batchSize = Batch<value_type>::size(m_dataset[i]);
-			for(std::size_t j = 0; j != batchSize; ++j,++index){
-				m_indices[index].batch = i;
-				m_indices[index].positionInBatch = j;
-				m_indices[index].datasetIndex = index;
-			}
-		}
-	}
+	:m_dataset(std::move(dataset)), m_partition(m_dataset.getPartitioning()), m_isIdentity(true){}
 
 	/// create a subset of the dataset type using only the elemnt indexed by indices
 	template<class IndexRange>
 	DataView(DataView<DatasetType> const& view, IndexRange const& indices)
-	:m_dataset(view.m_dataset),m_indices(indices.size())
+	:m_dataset(view.m_dataset), m_partition(view.m_partition), m_indices(indices.size()), m_isIdentity(false)
 	{
 		for(std::size_t i = 0; i != m_indices.size(); ++i)
-			m_indices[i] = view.m_indices[indices[i]];
+			m_indices[i] = view.index(indices[i]);
 	}
 	
 	shape_type shape() const{
@@ -128,13 +110,15 @@ public:
 
 	reference operator[](std::size_t position){
 		SIZE_CHECK(position < size());
-		Index const& index = m_indices[position];
-		return Batch<value_type>::get(static_cast<DatasetType&>(m_dataset)[index.batch],index.positionInBatch);
+		std::size_t i = index(position);
+		std::size_t b = m_partition.batch(i);
+		return Batch<value_type>::get(static_cast<DatasetType&>(m_dataset)[b], m_partition.positionInBatch(i, b));
 	}
 	const_reference operator[](std::size_t position) const{
 		SIZE_CHECK(position < size());
-		Index const& index = m_indices[position];
-		return getBatchElement(m_dataset[index.batch],index.positionInBatch);
+		std::size_t i = index(position);
+		std::size_t b = m_partition.batch(i);
+		return getBatchElement(m_dataset[b], m_partition.positionInBatch(i, b));
 	}
 	
 	reference front(){
@@ -159,29 +143,36 @@ public:
 	/// This is useful for bagging, when identical elements among
 	/// several subsets are to be identified.
 	std::size_t index(std::size_t position)const{
-		return m_indices[position].datasetIndex;
+		return m_isIdentity? position : m_indices[position];
 	}
 
 	/// \brief Index of the batch holding the element.
 	std::size_t batch(std::size_t position) const {
-		return m_indices[position].batch;
+		return m_partition.batch(index(position));
 	}
 
 	/// \brief Index inside the batch holding the element.
 	std::size_t positionInBatch(std::size_t position) const {
-		return m_indices[position].positionInBatch;
+		std::size_t i = index(position);
+		return m_partition.positionInBatch(i, m_partition.batch(i));
 	}
 	
 	
 	/// \brief exchanges elements i and j in the Dataview.
 	///
 	/// This does not change the order in the underlying dataset.
+	/// The first exchange in a view of the whole dataset stores the index of every element.
 	void swapElements(std::size_t i, std::size_t j){
+		if(m_isIdentity){
+			m_indices.resize(size());
+			std::iota(m_indices.begin(), m_indices.end(), std::size_t(0));
+			m_isIdentity = false;
+		}
 		std::swap(m_indices[i], m_indices[j]);
 	}
 
 	std::size_t size() const{
-		return m_indices.size();
+		return m_isIdentity? m_partition.numberOfElements() : m_indices.size();
 	}
 
 	iterator begin(){
@@ -202,14 +193,9 @@ public:
 	}
 private:
 	dataset_type m_dataset;
-	// Stores for an element of the dataset, at which position of which batch it is located
-	// as well as the real index of the element inside the dataset
-	struct Index{
-		std::size_t batch;//the batch in which the element is located
-		std::size_t positionInBatch;//at which position in the batch it is
-		std::size_t datasetIndex;//index inside the dataset
-	};
-	std::vector<Index> m_indices;//stores for every element of the set it's position inside the dataset
+	detail::BatchPartition m_partition;///< start of the batches of the dataset
+	std::vector<std::size_t> m_indices;///< index of every element of the view in the dataset, empty for identity views
+	bool m_isIdentity;///< true if the view holds all elements of the dataset in their order
 };
 
 
@@ -266,8 +252,27 @@ typename DataView<DatasetType>::batch_type randomSubBatch(
 	return subBatch(view,boost::make_iterator_range(indices.begin(),indices.begin()+size));
 }
 
+namespace detail{
+/// \brief Creates a dataset with the given batch sizes holding the elements of the view in order.
+///
+/// The batches are created from the elements in parallel, so the dataset is created with empty batches.
+template<class T>
+typename DataView<T>::dataset_type viewToDataset(DataView<T> const& view, std::vector<std::size_t> const& batchSizes){
+	BatchPartition partition(batchSizes);
+	SHARK_RUNTIME_CHECK(partition.numberOfElements() == view.size(), "Partition has not the same number of elements as the view");
+	typename DataView<T>::dataset_type dataset(std::vector<std::size_t>(batchSizes.size(), 0), view.shape());
+	auto createBatchTask = [&](std::size_t b){
+		auto begin = view.begin() + partition.batchStart(b);
+		dataset[b] = createBatch<typename DataView<T>::value_type>(begin, begin + batchSizes[b]);
+	};
+	threading::parallelND({batchSizes.size()}, {1}, createBatchTask, threading::globalThreadPool());
+	return dataset;
+}
+}
+
 /// \brief Creates a new dataset from a View.
 ///
+/// The batches are filled in parallel.
 /// \param view the view from which to create the new dataset
 /// \param maximumBatchSize the size of the batches in the dataset
 template<class T>
@@ -275,34 +280,18 @@ typename DataView<T>::dataset_type
 toDataset(DataView<T> const& view, std::size_t maximumBatchSize = constants::DefaultBatchSize){
 	if(view.size() == 0)
 		return typename DataView<T>::dataset_type();
-	
-	typename DataView<T>::dataset_type dataset(view.size(), view.shape(), maximumBatchSize);
-	
-	std::size_t batchStart = 0;
-	for(std::size_t i = 0; i != dataset.size(); ++i){
-		std::size_t batchEnd = batchStart + batchSize(dataset[i]);
-		dataset[i] = createBatch<typename DataView<T>::value_type>(view.begin()+batchStart, view.begin()+batchEnd);
-		batchStart = batchEnd;
-	}
-	return dataset;
+	return detail::viewToDataset(view, detail::optimalBatchSizes(view.size(), maximumBatchSize));
 }
 
 /// \brief Creates a new dataset from a View.
 ///
+/// The batches are filled in parallel.
 /// \param view the view from which to create the new dataset
 /// \param batchSizes the sizes of each individual batch
 template<class T>
 typename DataView<T>::dataset_type 
 toDataset(DataView<T> const& view, std::vector<std::size_t> const& batchSizes){
-	typename DataView<T>::dataset_type dataset(batchSizes, view.shape());
-	
-	std::size_t batchStart = 0;
-	for(std::size_t i = 0; i != dataset.size(); ++i){
-		std::size_t batchEnd = batchStart + batchSize(dataset[i]);
-		dataset[i] = createBatch<typename DataView<T>::value_type>(view.begin()+batchStart, view.begin()+batchEnd);
-		batchStart = batchEnd;
-	}
-	return dataset;
+	return detail::viewToDataset(view, batchSizes);
 }
 
 /// Return the number of classes (size of the label vector)
@@ -360,11 +360,11 @@ std::ostream &operator << (std::ostream &stream, const Data<T>& d) {
 /// \brief Returns a shuffled copy of the input data
 ///
 /// The order of points is randomized and a copy of the initial data object returned.
-/// The batch sizes are the same as in the original dataset.
+/// The batch sizes are the same as in the original dataset. The batches of the copy are filled in parallel.
 /// \param data the dataset to shuffle
 template<class T>
 Data<T> shuffle(Data<T> const& data){
-	return toDataset(randomSubset(elements(data), data.numberOfElements()),data.getPartition());
+	return toDataset(randomSubset(elements(data), data.numberOfElements()),data.getPartitioning());
 }
 /** @} */
 
@@ -656,7 +656,7 @@ std::ostream &operator << (std::ostream &stream, const LabeledData<T, U>& d) {
 /// \brief Returns a shuffled copy of the input data
 ///
 /// The order of (input-label)-pairs is randomized and a copy of the initial data object returned.
-/// The batch sizes are the same as in the original dataset.
+/// The batch sizes are the same as in the original dataset. The batches of the copy are filled in parallel.
 /// \param data the dataset to shuffle
 template<class I, class L>
 LabeledData<I,L> shuffle(LabeledData<I,L> const& data){
@@ -759,6 +759,52 @@ Generator<typename DatasetType::element_type >  generator(DatasetType const& set
 	return Generator<typename DatasetType::element_type >(gen, set.shape(), cacheSize);
 }
 
+/// \brief Creates a Generator which returns the batches of a dataset in epochs.
+///
+/// Every epoch returns each batch of the dataset exactly once in a random order, which is redrawn
+/// for every epoch. The elements of every returned batch are randomly permuted. This is an
+/// inexpensive substitute for shuffling the whole dataset before every epoch, when an exact shuffle is not needed:
+/// elements never move to another batch, so only the copy of the returned batch is made, which a
+/// generator has to make anyway. To mix the batches, call shuffle on the dataset once before creating the generator.
+/// As with generator(), the dataset is shared until the Generator is destroyed and caching allows
+/// to create the batches in parallel.
+///
+/// \param set the dataset from which to create the generator
+/// \param cacheSize how many elements should be cached. default is 0.
+template<class DatasetType>
+Generator<typename DatasetType::element_type >  epochGenerator(DatasetType const& set, std::size_t cacheSize = 0){
+	SHARK_RUNTIME_CHECK(set.size() != 0, "The dataset must not be empty");
+	//the state of the current epoch, shared between the copies of the generating function
+	struct Epoch{
+		std::mutex mutex;
+		std::vector<std::size_t> order;//order of the batches in the current epoch
+		std::size_t next;//position of the next batch in order
+	};
+	auto epoch = std::make_shared<Epoch>();
+	epoch->order.resize(set.size());
+	epoch->next = set.size();
+	std::iota(epoch->order.begin(), epoch->order.end(), std::size_t(0));
+	DataView<DatasetType const> view(set);
+	detail::BatchPartition partition(set.getPartitioning());
+	auto gen = [epoch, view, partition]() -> typename DatasetType::value_type{
+		std::size_t b;
+		{
+			std::lock_guard<std::mutex> lock(epoch->mutex);
+			if(epoch->next == epoch->order.size()){
+				std::shuffle(epoch->order.begin(), epoch->order.end(), random::globalRng());
+				epoch->next = 0;
+			}
+			b = epoch->order[epoch->next++];
+		}
+		std::vector<std::size_t> indices(partition.batchStart(b + 1) - partition.batchStart(b));
+		std::iota(indices.begin(), indices.end(), partition.batchStart(b));
+		std::shuffle(indices.begin(), indices.end(), random::globalRng());
+		return subBatch(view, indices);
+	};
+	
+	return Generator<typename DatasetType::element_type >(gen, set.shape(), cacheSize);
+}
+
 
 
 
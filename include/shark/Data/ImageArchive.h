@@ -0,0 +1,106 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Loads image datasets stored in zip archives
+ *
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_IMAGEARCHIVE_H
+#define SHARK_DATA_IMAGEARCHIVE_H
+
+#include <shark/Core/DLLSupport.h>
+#include <shark/Data/Dataset.h>
+#include <string>
+#include <vector>
+
+namespace shark {
+
+/**
+ * \ingroup shark_globals
+ *
+ * @{
+ */
+
+/// \brief Throughput of loading a dataset from an archive.
+struct ArchiveImportStatistics{
+	std::size_t files;///< number of files loaded
+	std::size_t bytes;///< size of the decompressed files
+	double seconds;///< time needed for loading
+
+	double filesPerSecond() const{
+		return seconds > 0? files / seconds : 0.0;
+	}
+	double bytesPerSecond() const{
+		return seconds > 0? bytes / seconds : 0.0;
+	}
+};
+
+/// \brief Loads all images stored in a zip archive.
+///
+/// All png, jpeg and pgm files of the archive are loaded in the order of their names, other
+/// files are ignored. The images must have the same size, the shape of the dataset is
+/// height x width x channels as returned by image::readImage, with values in [0,1].
+///
+/// The dataset is allocated before loading and the batches are filled in parallel: every thread
+/// reads and decompresses the files of a batch from the archive and decodes them into the batch.
+///
+/// \param images    the loaded dataset
+/// \param archive   path to the zip archive
+/// \param maximumBatchSize  the maximum size of a batch
+/// \return the throughput of loading
+SHARK_EXPORT_SYMBOL ArchiveImportStatistics importImageArchive(
+	Data<RealVector>& images,
+	std::string const& archive,
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+
+/// \brief Loads all images stored in a zip archive, labeled by the directory holding them.
+///
+/// Every image must be stored in a directory, e.g. "cat/0001.png". The top-level directory is the name of the
+/// class of the image. The classes are numbered in the order of their names, which are returned in classNames.
+/// Otherwise, the images are loaded as by importImageArchive for unlabeled data.
+///
+/// \param data      the loaded dataset
+/// \param classNames  the names of the classes, the i-th entry is the name of class i
+/// \param archive   path to the zip archive
+/// \param maximumBatchSize  the maximum size of a batch
+/// \return the throughput of loading
+SHARK_EXPORT_SYMBOL ArchiveImportStatistics importImageArchive(
+	LabeledData<RealVector, unsigned int>& data,
+	std::vector<std::string>& classNames,
+	std::string const& archive,
+	std::size_t maximumBatchSize = constants::DefaultBatchSize
+);
+
+/** @}*/
+
+}
+#endif
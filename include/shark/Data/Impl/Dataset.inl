@@ -103,6 +103,69 @@ inline std::size_t batchPartitioning(
 	return sumOfBatches;
 }
 
+///\brief Maps the index of an element of a dataset to its batch and position in the batch.
+///
+/// Only the start of every batch is stored, not the position of every element.
+/// For the partitionings computed by optimalBatchSizes, where the first batches hold one element
+/// more than the others, the batch of an element is computed by a division. Otherwise it is found by binary
+/// search over the start of the batches.
+class BatchPartition{
+public:
+	BatchPartition():m_batchStart(1, 0), m_size(0), m_largeBatches(0){}
+
+	/// \brief Creates the partition from the sizes of the batches.
+	explicit BatchPartition(std::vector<std::size_t> const& batchSizes)
+	: m_batchStart(batchSizes.size() + 1, 0), m_size(0), m_largeBatches(0){
+		for(std::size_t b = 0; b != batchSizes.size(); ++b)
+			m_batchStart[b + 1] = m_batchStart[b] + batchSizes[b];
+		if(batchSizes.empty())
+			return;
+		//check whether the first batches have size m_size+1 and the remaining ones size m_size
+		m_size = batchSizes.back();
+		while(m_largeBatches != batchSizes.size() && batchSizes[m_largeBatches] == m_size + 1)
+			++m_largeBatches;
+		for(std::size_t b = m_largeBatches; b != batchSizes.size(); ++b){
+			if(batchSizes[b] != m_size){
+				m_size = 0;
+				return;
+			}
+		}
+	}
+
+	/// \brief Number of elements in all batches.
+	std::size_t numberOfElements() const{
+		return m_batchStart.back();
+	}
+	/// \brief Number of batches.
+	std::size_t numberOfBatches() const{
+		return m_batchStart.size() - 1;
+	}
+	/// \brief Index of the first element of batch b.
+	std::size_t batchStart(std::size_t b) const{
+		return m_batchStart[b];
+	}
+
+	/// \brief Returns the batch holding the i-th element.
+	std::size_t batch(std::size_t i) const{
+		SIZE_CHECK(i < numberOfElements());
+		if(m_size != 0){
+			std::size_t largeElements = m_largeBatches * (m_size + 1);
+			if(i < largeElements)
+				return i / (m_size + 1);
+			return m_largeBatches + (i - largeElements) / m_size;
+		}
+		return std::upper_bound(m_batchStart.begin(), m_batchStart.end(), i) - m_batchStart.begin() - 1;
+	}
+	/// \brief Returns the position of the i-th element in batch b, which must hold the element.
+	std::size_t positionInBatch(std::size_t i, std::size_t b) const{
+		return i - m_batchStart[b];
+	}
+private:
+	std::vector<std::size_t> m_batchStart;///< index of the first element of every batch, plus the number of elements
+	std::size_t m_size;///< size of the small batches of a regular partitioning, 0 otherwise
+	std::size_t m_largeBatches;///< number of batches of size m_size+1 in front of the others
+};
+
 /// compute the complement of the indices with respect to the set [0,...n[
 template<class T,class T2>
 void complement(
@@ -0,0 +1,177 @@
+/*!
+ *
+ *
+ * \brief       Reads the records of line based text files block by block
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_DATA_IMPL_RECORDSTREAM_H
+#define SHARK_DATA_IMPL_RECORDSTREAM_H
+
+#include <shark/Core/Exception.h>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace shark{ namespace detail{
+
+/// \brief Reads the records of a line based text file in blocks.
+///
+/// Used by the streaming readers of csv and sparse data files. Every line holding
+/// something else than whitespace and comments is a record. A block of records is
+/// copied while holding a lock, the caller parses it afterwards. Thus several threads
+/// can fetch blocks and parse them at the same time.
+///
+/// The first record is read on construction to allow the callers to determine the
+/// format of the file. When the end of the stream is reached, the stream is rewound to
+/// the first record, which requires the stream to support seeking. The last block before rewinding can
+/// be smaller than requested.
+class RecordStream{
+public:
+	/// \brief Reads from a stream which must stay alive while it is read.
+	///
+	/// \param stream      the stream to read from, starting at its current position
+	/// \param comment     character starting a comment, 0 if the file has no comments
+	/// \param titleLines  number of lines to skip in the beginning
+	RecordStream(std::istream& stream, char comment, std::size_t titleLines = 0)
+	: m_stream(&stream), m_comment(comment){
+		init(titleLines);
+	}
+
+	/// \brief Reads from a file.
+	///
+	/// \param filename    the file to read
+	/// \param comment     character starting a comment, 0 if the file has no comments
+	/// \param titleLines  number of lines to skip in the beginning
+	RecordStream(std::string const& filename, char comment, std::size_t titleLines = 0)
+	: m_file(new std::ifstream(filename.c_str(), std::ios::binary)), m_stream(m_file.get()), m_comment(comment){
+		SHARK_RUNTIME_CHECK(*m_file, "File cannot be opened for reading.");
+		init(titleLines);
+	}
+
+	/// \brief Returns the first record of the stream.
+	std::string const& firstRecord() const{
+		return m_first;
+	}
+
+	/// \brief Appends the next records to the string, every record ends with '\n'.
+	///
+	/// Comments and line endings are removed, whitespace is not. Returns the number of records read,
+	/// which is only smaller than maxRecords if the end of the stream was reached, but never 0.
+	std::size_t read(std::size_t maxRecords, std::string& records){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if(m_atEnd)
+			rewind();
+		std::size_t numRecords = readRecords(maxRecords, records);
+		if(numRecords == 0 && maxRecords != 0){
+			//the previous block ended exactly at the end of the stream
+			rewind();
+			numRecords = readRecords(maxRecords, records);
+		}
+		m_atEnd = numRecords != maxRecords;
+		return numRecords;
+	}
+
+	/// \brief Calls f(record) for every record of the stream.
+	///
+	/// Afterwards, the next call to read starts again with the first record.
+	template<class Functor>
+	void forEachRecord(Functor f){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		rewind();
+		std::string line;
+		while(nextRecord(line))
+			f(line);
+		rewind();
+		nextRecord(m_first);
+		m_firstPending = true;
+	}
+
+private:
+	void init(std::size_t titleLines){
+		std::string line;
+		for(std::size_t i = 0; i != titleLines && std::getline(*m_stream, line); ++i);
+		m_start = m_stream->tellg();
+		SHARK_RUNTIME_CHECK(nextRecord(m_first), "The stream does not contain any record");
+		m_firstPending = true;
+		m_atEnd = false;
+	}
+
+	std::size_t readRecords(std::size_t maxRecords, std::string& records){
+		std::size_t numRecords = 0;
+		if(m_firstPending && maxRecords != 0){
+			records += m_first;
+			records += '\n';
+			m_firstPending = false;
+			++numRecords;
+		}
+		std::string line;
+		while(numRecords != maxRecords && nextRecord(line)){
+			records += line;
+			records += '\n';
+			++numRecords;
+		}
+		return numRecords;
+	}
+
+	void rewind(){
+		m_stream->clear();
+		m_stream->seekg(m_start);
+		SHARK_RUNTIME_CHECK(*m_stream && m_start != std::streampos(-1), "The stream can not be rewound");
+		m_atEnd = false;
+	}
+
+	/// \brief Reads the next line containing a record and strips comments and line endings.
+	bool nextRecord(std::string& line){
+		while(std::getline(*m_stream, line)){
+			if(m_comment){
+				std::size_t comment = line.find(m_comment);
+				if(comment != std::string::npos)
+					line.erase(comment);
+			}
+			while(!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if(line.find_first_not_of(" \t\v\f") != std::string::npos)
+				return true;
+		}
+		return false;
+	}
+
+	std::unique_ptr<std::ifstream> m_file;///< the file if the stream is owned
+	std::istream* m_stream;
+	char m_comment;
+	std::streampos m_start;///< position of the first line after the title lines
+	std::string m_first;///< the first record
+	bool m_firstPending;///< true if the first record was not returned by read yet
+	bool m_atEnd;///< true if the stream must be rewound before reading
+	std::mutex m_mutex;
+};
+
+}}
+#endif
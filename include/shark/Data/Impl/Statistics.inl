@@ -26,12 +26,55 @@
  *
  */
 namespace shark{ 
-	
+namespace detail{
+/// \brief Splits the batches into one block of consecutive batches per thread and calls f(block, begin, end) for every block in parallel.
+///
+/// Returns the number of blocks.
+template<class Functor>
+std::size_t parallelBatchBlocks(std::size_t numBatches, Functor f){
+	std::size_t numBlocks = std::min(numBatches, std::max<std::size_t>(threading::globalThreadPool().numWorkers(), 1));
+	auto blockTask = [&](std::size_t block){
+		f(block, block * numBatches / numBlocks, (block + 1) * numBatches / numBlocks);
+	};
+	threading::parallelND({numBlocks}, {1}, blockTask, threading::globalThreadPool());
+	return numBlocks;
+}
+
+/// \brief Merges number of points, mean and sum of squared deviations of a second set of points into the first.
+///
+/// Uses the pairwise update of Chan, Golub and LeVeque, which stays accurate when the sets have very
+/// different sizes or the mean is large compared to the deviations.
+template<class V>
+void mergeVariance(double& n, V& mean, V& m2, double nOther, V const& meanOther, V const& m2Other){
+	if(nOther == 0) return;
+	double nTotal = n + nOther;
+	V delta = meanOther - mean;
+	noalias(mean) += (nOther / nTotal) * delta;
+	noalias(m2) += m2Other + (n * nOther / nTotal) * sqr(delta);
+	n = nTotal;
+}
+
+/// \brief Merges number of points, mean and co-moment matrix of a second set of points into the first.
+///
+/// Same as mergeVariance, but for the matrix of summed products of deviations. Only the lower triangle is used.
+template<class V, class M>
+void mergeCovariance(double& n, V& mean, M& m2, double nOther, V const& meanOther, M const& m2Other){
+	if(nOther == 0) return;
+	double nTotal = n + nOther;
+	V delta = meanOther - mean;
+	noalias(mean) += (nOther / nTotal) * delta;
+	noalias(m2) += m2Other + (n * nOther / nTotal) * outer_prod(delta, delta);
+	n = nTotal;
+}
+}
+
 /*!
  *  \brief Calculates the mean and variance values of a dataset
  *
  *  Given the vector of data, the mean and variance values
  *  are calculated as in the functions #mean and #variance.
+ *  The data is processed in a single parallel pass: every thread computes mean
+ *  and squared deviations of a block of batches, which are merged afterwards.
  *
  *      \param  data Input data.
  *      \param  meanVec Vector of mean values.
@@ -47,20 +90,30 @@ void meanvar
 )
 {
 	SIZE_CHECK(!data.empty());
+	typedef blas::vector<typename Vec2T::value_type, Device> VectorType;
 	std::size_t const dataSize = data.numberOfElements();
 	std::size_t elementSize=dataDimension(data);
 
-	varianceVec().resize(elementSize);
-	varianceVec().clear();
-	
-	meanVec()= mean(data);
-	
-	//sum of variances of each column
-	for(auto& batch: data){
-		std::size_t batchSize = batch.size1();
-		noalias(varianceVec()) += norm_sqr(as_columns(batch-repeat(meanVec,batchSize)));
+	std::vector<double> counts(data.size(), 0.0);
+	std::vector<VectorType> means(data.size());
+	std::vector<VectorType> m2s(data.size());
+	std::size_t numBlocks = detail::parallelBatchBlocks(data.size(), [&](std::size_t block, std::size_t begin, std::size_t end){
+		means[block] = VectorType(elementSize, 0.0);
+		m2s[block] = VectorType(elementSize, 0.0);
+		for(std::size_t b = begin; b != end; ++b){
+			auto const& batch = data[b];
+			std::size_t batchSize = batch.size1();
+			if(batchSize == 0) continue;
+			VectorType batchMean = sum(as_columns(batch)) / double(batchSize);
+			VectorType batchM2 = norm_sqr(as_columns(batch-repeat(batchMean,batchSize)));
+			detail::mergeVariance(counts[block], means[block], m2s[block], double(batchSize), batchMean, batchM2);
+		}
+	});
+	for(std::size_t block = 1; block != numBlocks; ++block){
+		detail::mergeVariance(counts[0], means[0], m2s[0], counts[block], means[block], m2s[block]);
 	}
-	varianceVec() /= double(dataSize);
+	meanVec() = means[0];
+	varianceVec() = m2s[0] / double(dataSize);
 }
 
 /*!
@@ -68,6 +121,8 @@ void meanvar
  *
  *  Given the vector of data, the mean and variance values
  *  are calculated as in the functions #mean and #variance.
+ *  The data is processed in a single parallel pass: every thread accumulates the products
+ *  of the deviations of a block of batches using a symmetric rank-k update, the results are merged afterwards.
  *
  *      \param  data Input data.
  *      \param  meanVec Vector of mean values.
@@ -82,21 +137,43 @@ void meanvar
 	blas::matrix_container<MatT, Device>& covariance
 ){
 	SIZE_CHECK(!data.empty());
-	typedef typename Batch<Vec1T>::type BatchType;
+	typedef typename MatT::value_type value_type;
+	typedef blas::vector<value_type, Device> VectorType;
+	typedef blas::matrix<value_type, blas::row_major, Device> MatrixType;
 	std::size_t const dataSize = data.numberOfElements();
 	std::size_t elementSize=dataDimension(data);
 
-	covariance().resize(elementSize,elementSize);
-	covariance().clear();
-	
-	meanVec() = mean(data);
-	//sum of variances of each column
-	for(std::size_t b = 0; b != data.size(); ++b){
-		//make the batch mean-free
-		BatchType batch = data[b]-repeat(meanVec,data[b].size1());
-		noalias(covariance) += prod(trans(batch),batch);
+	std::vector<double> counts(data.size(), 0.0);
+	std::vector<VectorType> means(data.size());
+	std::vector<MatrixType> m2s(data.size());
+	std::size_t numBlocks = detail::parallelBatchBlocks(data.size(), [&](std::size_t block, std::size_t begin, std::size_t end){
+		means[block] = VectorType(elementSize, 0.0);
+		m2s[block] = MatrixType(elementSize, elementSize, 0.0);
+		for(std::size_t b = begin; b != end; ++b){
+			auto const& batch = data[b];
+			std::size_t batchSize = batch.size1();
+			if(batchSize == 0) continue;
+			VectorType batchMean = sum(as_columns(batch)) / double(batchSize);
+			//the products of the deviations from the batch mean are added to the block,
+			//the merge adds the correction for the difference of the means
+			MatrixType deviations = batch-repeat(batchMean,batchSize);
+			double count = counts[block];
+			VectorType delta = batchMean - means[block];
+			blas::kernels::syrk<false>(trans(deviations), m2s[block], value_type(1));
+			noalias(m2s[block]) += (count * batchSize / (count + batchSize)) * outer_prod(delta, delta);
+			noalias(means[block]) += (batchSize / (count + batchSize)) * delta;
+			counts[block] += batchSize;
+		}
+	});
+	for(std::size_t block = 1; block != numBlocks; ++block){
+		detail::mergeCovariance(counts[0], means[0], m2s[0], counts[block], means[block], m2s[block]);
+	}
+	//only the lower triangle was computed
+	for(std::size_t i = 0; i + 1 < elementSize; ++i){
+		noalias(subrange(row(m2s[0], i), i + 1, elementSize)) = subrange(column(m2s[0], i), i + 1, elementSize);
 	}
-	covariance() /= double(dataSize);
+	meanVec() = means[0];
+	covariance() = m2s[0] / double(dataSize);
 }
 
 /*!
@@ -139,10 +216,18 @@ template<class VectorType>
 VectorType mean(Data<VectorType> const& data){
 	SIZE_CHECK(!data.empty());
 
-	VectorType mean(dataDimension(data),0.0);
-	 
-	for(auto& batch: data){
-		mean += sum(as_columns(batch));
+	//every thread sums up a block of batches
+	std::vector<VectorType> sums(data.size());
+	std::size_t numBlocks = detail::parallelBatchBlocks(data.size(), [&](std::size_t block, std::size_t begin, std::size_t end){
+		sums[block] = VectorType(dataDimension(data),0.0);
+		for(std::size_t b = begin; b != end; ++b){
+			if(data[b].size1() != 0)
+				sums[block] += sum(as_columns(data[b]));
+		}
+	});
+	VectorType mean = sums[0];
+	for(std::size_t block = 1; block != numBlocks; ++block){
+		mean += sums[block];
 	}
 	mean /= double(data.numberOfElements());
 	return mean;
@@ -0,0 +1,164 @@
+/*!
+ *
+ *
+ * \brief       Helper functions for parsing text files in parallel
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SHARK_DATA_IMPL_TEXTPARSING_H
+#define SHARK_DATA_IMPL_TEXTPARSING_H
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace shark{ namespace detail{
+
+/// \brief Whitespace except for the line feed.
+inline bool isBlank(char c){
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/// \brief Returns the start of the line following pos. Lines end with \n, \r or \r\n.
+inline char const* nextLine(char const* pos, char const* end){
+	while(pos != end && *pos != '\n' && *pos != '\r') ++pos;
+	if(pos != end && *pos == '\r') ++pos;
+	if(pos != end && *pos == '\n') ++pos;
+	return pos;
+}
+
+/// \brief Splits the range [begin, end) into chunks of whole lines that can be parsed in parallel.
+///
+/// Returns the start of every chunk followed by end. Chunks are about chunkSize bytes long.
+inline std::vector<char const*> splitLines(char const* begin, char const* end, std::size_t chunkSize = 1 << 20){
+	std::vector<char const*> chunkStart(1, begin);
+	while(chunkStart.back() != end){
+		char const* chunkEnd = chunkStart.back() + std::min<std::size_t>(chunkSize, end - chunkStart.back());
+		chunkStart.push_back(chunkEnd == end ? end : nextLine(chunkEnd, end));
+	}
+	return chunkStart;
+}
+
+/// \brief Parses a floating point number occupying the whole range [begin, end).
+///
+/// Numbers with at most 19 significant digits and an exponent of at most 22 are
+/// converted by a single multiplication or division of two exactly representable numbers,
+/// which is correctly rounded. All other numbers are converted by a stream with the classic locale,
+/// which does not depend on the locale set by setlocale. nan and inf are accepted as well.
+inline bool parseDouble(char const* begin, char const* end, double& value){
+	char const* pos = begin;
+	bool negative = false;
+	if(pos != end && (*pos == '-' || *pos == '+')){
+		negative = *pos == '-';
+		++pos;
+	}
+	std::uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos){
+		hasDigits = true;
+		if(mantissa == 0 && *pos == '0') continue;
+		if(significantDigits < 19){
+			mantissa = 10 * mantissa + (*pos - '0');
+		}else{
+			++exponent;
+		}
+		++significantDigits;
+	}
+	if(pos != end && *pos == '.'){
+		++pos;
+		for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos){
+			hasDigits = true;
+			if(mantissa == 0 && *pos == '0'){
+				--exponent;
+				continue;
+			}
+			if(significantDigits < 19){
+				mantissa = 10 * mantissa + (*pos - '0');
+				--exponent;
+			}
+			++significantDigits;
+		}
+	}
+	if(hasDigits && pos != end && (*pos == 'e' || *pos == 'E')){
+		++pos;
+		bool negativeExponent = false;
+		if(pos != end && (*pos == '-' || *pos == '+')){
+			negativeExponent = *pos == '-';
+			++pos;
+		}
+		if(pos == end) return false;
+		int e = 0;
+		for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos){
+			if(e < 100000) e = 10 * e + (*pos - '0');
+		}
+		exponent += negativeExponent ? -e : e;
+	}
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	if(hasDigits && pos == end && significantDigits <= 19 && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22){
+		value = double(mantissa);
+		value = exponent < 0 ? value / powers[-exponent] : value * powers[exponent];
+		if(negative) value = -value;
+		return true;
+	}
+
+	//nan and infinity
+	std::string rest(pos, end);
+	for(char& c: rest)
+		c = std::tolower(static_cast<unsigned char>(c));
+	if(!hasDigits && (rest == "nan" || rest == "inf" || rest == "infinity")){
+		value = rest == "nan" ? std::numeric_limits<double>::quiet_NaN() : std::numeric_limits<double>::infinity();
+		if(negative) value = -value;
+		return true;
+	}
+
+	//general case. The stream uses the classic locale as the decimal point of strtod depends on LC_NUMERIC
+	if(!hasDigits) return false;
+	std::istringstream stream(std::string(begin, end));
+	stream.imbue(std::locale::classic());
+	stream >> value;
+	if(stream.fail()){
+		//overflow sets the failbit and returns the largest finite value
+		if(std::abs(value) != std::numeric_limits<double>::max()) return false;
+		value = value > 0 ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+		stream.clear();
+	}
+	return stream.peek() == std::char_traits<char>::eof();
+}
+
+}}
+#endif
@@ -0,0 +1,311 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Computes batches in parallel ahead of their use
+ *
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_DATA_PREFETCH_H
+#define SHARK_DATA_PREFETCH_H
+
+#include <shark/Core/Threading/Pipeline.h>
+#include <shark/Core/Timer.h>
+#include <shark/Data/Dataset.h>
+#include <shark/Data/Generator.h>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace shark{
+
+/// \brief Throughput counters of a stage of a PrefetchPipeline.
+struct PrefetchStageStatistics{
+	std::string name;///< name of the stage
+	std::size_t batches;///< number of batches the stage has computed
+	double seconds;///< time spent computing the stage, summed over all threads
+
+	/// \brief Number of batches a single thread computes per second in this stage.
+	double throughput() const{
+		return seconds > 0? batches / seconds : 0.0;
+	}
+};
+
+namespace detail{
+/// \brief Thread safe counters of the stages of a PrefetchPipeline.
+class PrefetchCounters{
+public:
+	std::size_t addStage(std::string const& name){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stages.push_back(PrefetchStageStatistics{name, 0, 0.0});
+		return m_stages.size() - 1;
+	}
+	void record(std::size_t stage, double seconds){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_stages[stage].batches;
+		m_stages[stage].seconds += seconds;
+	}
+	std::vector<PrefetchStageStatistics> statistics() const{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_stages;
+	}
+private:
+	mutable std::mutex m_mutex;
+	std::vector<PrefetchStageStatistics> m_stages;
+};
+}
+
+/// \brief The stages computing the batches of a PrefetchPipeline.
+///
+/// The first stage is a source which computes the i-th object of a sequence from the index i,
+/// for example it reads the i-th batch of file names. Every stage added by then() transforms the result of the
+/// previous stage, for example it decodes the images and augments them. All stages of one batch are computed
+/// one after another by a single thread, different batches are computed by different threads at the same time.
+/// Thus all stages must be thread safe. The time spent in every stage is counted.
+///
+/// Sources of the batches of datasets and generators are created by prefetchSource.
+template<class T>
+class PrefetchStages{
+public:
+	typedef T value_type;
+
+	/// \brief Creates the source stage computing the i-th object as source(i).
+	template<class Source>
+	PrefetchStages(std::string const& name, Source source)
+	: m_counters(std::make_shared<detail::PrefetchCounters>()){
+		std::size_t stage = m_counters->addStage(name);
+		auto counters = m_counters;
+		m_compute = [source, stage, counters](std::size_t i) -> T{
+			Timer timer;
+			T result = source(i);
+			counters->record(stage, timer.stop());
+			return result;
+		};
+	}
+
+	/// \brief Appends a stage which transforms the result of the last stage using f.
+	template<class Functor>
+	PrefetchStages<typename std::decay<decltype(std::declval<Functor&>()(std::declval<T>()))>::type>
+	then(std::string const& name, Functor f) const{
+		typedef typename std::decay<decltype(std::declval<Functor&>()(std::declval<T>()))>::type Result;
+		std::size_t stage = m_counters->addStage(name);
+		auto counters = m_counters;
+		auto previous = m_compute;
+		std::function<Result(std::size_t)> compute = [previous, f, stage, counters](std::size_t i) -> Result{
+			T input = previous(i);
+			Timer timer;
+			Result result = f(std::move(input));
+			counters->record(stage, timer.stop());
+			return result;
+		};
+		return PrefetchStages<Result>(std::move(compute), m_counters);
+	}
+
+	/// \brief Computes all stages for the i-th object.
+	T operator()(std::size_t i) const{
+		return m_compute(i);
+	}
+
+	/// \brief Returns the counters of all stages.
+	std::vector<PrefetchStageStatistics> statistics() const{
+		return m_counters->statistics();
+	}
+private:
+	template<class> friend class PrefetchStages;
+	PrefetchStages(std::function<T(std::size_t)> compute, std::shared_ptr<detail::PrefetchCounters> const& counters)
+	: m_compute(std::move(compute)), m_counters(counters){}
+
+	std::function<T(std::size_t)> m_compute;
+	std::shared_ptr<detail::PrefetchCounters> m_counters;
+};
+
+/// \brief Creates a source returning the batches of a dataset in order, starting again after the last batch.
+///
+/// The dataset is shared by the source.
+template<class DatasetType>
+PrefetchStages<typename DatasetType::value_type> prefetchSource(DatasetType const& set, std::string const& name = "source"){
+	SHARK_RUNTIME_CHECK(set.size() != 0, "The dataset must not be empty");
+	return PrefetchStages<typename DatasetType::value_type>(name, [set](std::size_t i) -> typename DatasetType::value_type{
+		return set[i % set.size()];
+	});
+}
+
+/// \brief Creates a source returning the batches of a generator.
+///
+/// The generating function of the generator is called from several threads, caching of the generator is not used.
+template<class InputType>
+PrefetchStages<typename Batch<InputType>::type> prefetchSource(Generator<InputType> const& gen, std::string const& name = "source"){
+	auto generate = gen.generatingFunction();
+	return PrefetchStages<typename Batch<InputType>::type>(name, [generate](std::size_t){
+		return generate();
+	});
+}
+
+/// \brief Computes the batches of a sequence in parallel ahead of their use.
+///
+/// The pipeline computes the batches 0,1,2,... of the sequence described by a PrefetchStages object in
+/// the threadpool and keeps up to numPrefetched of them ready or in computation. When a batch is taken out by next(), the computation
+/// of the next batch is started. Thus the number of batches in memory is bounded, independent of how fast
+/// the batches are used. The batches are returned in order, even if they are done in a different order.
+///
+/// This is useful if creating a batch is expensive, for example when images are read, decoded and augmented before
+/// being used by an optimizer. The pipeline is used by a Generator created by prefetchGenerator, which can be used in place
+/// of any other generator, e.g. in an ErrorFunction.
+///
+/// Exceptions thrown while computing a batch are rethrown by next() when the batch would be returned.
+/// The statistics of the stages and the time spent waiting for batches in next() allow to find the
+/// stage limiting the throughput: if the waiting time is large, the stages can not keep up with the consumer.
+template<class InputType>
+class PrefetchPipeline{
+public:
+	typedef typename Batch<InputType>::type value_type;
+	typedef typename Batch<InputType>::shape_type shape_type;
+
+	/// \brief Starts computing the first numPrefetched batches.
+	///
+	/// \param stages the stages computing the batches
+	/// \param shape the shape of the batches
+	/// \param numPrefetched maximum number of batches computed ahead
+	/// \param pool the threadpool computing the batches
+	PrefetchPipeline(
+		PrefetchStages<value_type> const& stages, shape_type const& shape,
+		std::size_t numPrefetched, threading::ThreadPool& pool = threading::globalThreadPool()
+	): m_stages(stages)
+	, m_shape(shape)
+	, m_numPrefetched(numPrefetched)
+	, m_pool(pool)
+	, m_pipeline(numPrefetched, pool)
+	, m_nextIndex(0)
+	, m_batches(0)
+	, m_waitSeconds(0.0){
+		SHARK_RUNTIME_CHECK(numPrefetched > 0, "At least one batch must be prefetched");
+		fill();
+	}
+
+	PrefetchPipeline(PrefetchPipeline const&) = delete;
+	PrefetchPipeline& operator=(PrefetchPipeline const&) = delete;
+
+	~PrefetchPipeline(){
+		//the batches in computation reference this object
+		Result result;
+		while(!m_pipeline.empty()){
+			if(m_pipeline.pull(result) != threading::queue_status::success)
+				m_pool.yield();
+		}
+	}
+
+	shape_type const& shape() const{
+		return m_shape;
+	}
+	std::size_t numPrefetched() const{
+		return m_numPrefetched;
+	}
+
+	/// \brief Returns the next batch of the sequence.
+	///
+	/// If the batch is not ready yet, the calling thread helps the threadpool until it is.
+	value_type next(){
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Result result;
+		Timer timer;
+		while(m_pipeline.pull(result) != threading::queue_status::success)
+			m_pool.yield();
+		m_waitSeconds += timer.stop();
+		++m_batches;
+		fill();
+		if(result.error)
+			std::rethrow_exception(result.error);
+		return std::move(result.value);
+	}
+
+	/// \brief Returns the counters of all stages.
+	std::vector<PrefetchStageStatistics> statistics() const{
+		return m_stages.statistics();
+	}
+	/// \brief Number of batches returned by next().
+	std::size_t batches() const{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_batches;
+	}
+	/// \brief Time spent in next() waiting for batches to be computed.
+	double waitSeconds() const{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_waitSeconds;
+	}
+private:
+	struct Result{
+		value_type value;
+		std::exception_ptr error;
+	};
+
+	/// \brief Starts computing batches until numPrefetched batches are in the pipeline.
+	void fill(){
+		for(;;){
+			std::size_t i = m_nextIndex;
+			auto task = [this, i]{
+				Result result;
+				try{
+					result.value = m_stages(i);
+				}catch(...){
+					result.error = std::current_exception();
+				}
+				return result;
+			};
+			if(m_pipeline.push(task) != threading::queue_status::success)
+				return;
+			++m_nextIndex;
+		}
+	}
+
+	PrefetchStages<value_type> m_stages;
+	shape_type m_shape;
+	std::size_t m_numPrefetched;
+	threading::ThreadPool& m_pool;
+	threading::Pipeline<Result> m_pipeline;
+	std::size_t m_nextIndex;///< index of the next batch to start computing
+	mutable std::mutex m_mutex;///< protects the pipeline and the counters of next()
+	std::size_t m_batches;
+	double m_waitSeconds;
+};
+
+/// \brief Creates a generator returning the batches of a PrefetchPipeline in order.
+///
+/// The generator shares the pipeline. As the pipeline computes the batches ahead, the generator does not use
+/// a cache of its own.
+template<class InputType>
+Generator<InputType> prefetchGenerator(std::shared_ptr<PrefetchPipeline<InputType> > const& pipeline){
+	return Generator<InputType>([pipeline]{return pipeline->next();}, pipeline->shape());
+}
+
+}
+#endif
@@ -44,7 +44,9 @@
 #include <shark/Core/DLLSupport.h>
 #include <shark/Core/utility/KeyValuePair.h>
 #include <shark/Data/Dataset.h>
+#include <shark/Data/Generator.h>
 #include <fstream>
+#include <istream>
 
 namespace shark {
 
@@ -212,6 +214,176 @@ SHARK_EXPORT_SYMBOL void importSparseData(
 );
 
 
+// STREAMING READ IN ROUTINES BELOW
+//
+// The generators read the next batchSize records of the file whenever a batch is requested
+// and start from the beginning of the file after the last record, such that the file never
+// has to fit into memory. As the records are not known in advance, the dimensionality of
+// the inputs and the number of classes must be given. Feature indices start at 1.
+
+/// \brief Stream classification data from a sparse data (libSVM) file.
+///
+/// The labels are mapped to classes like by importSparseData: the labels -1 and +1 of binary
+/// problems are read as classes 0 and 1, otherwise the smallest label of the file becomes class 0.
+/// For this, the labels of all records are read once when the generator is created.
+/// The file must not contain more than numberOfClasses classes.
+///
+/// \param  generator     the generator returning the batches
+/// \param  fn            the file to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  numberOfClasses number of classes of the labels
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream classification data from a sparse data (libSVM) stream.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// The labels are mapped to classes like by importSparseData: the labels -1 and +1 of binary
+/// problems are read as classes 0 and 1, otherwise the smallest label of the file becomes class 0.
+/// For this, the labels of all records are read once when the generator is created.
+/// The file must not contain more than numberOfClasses classes.
+///
+/// \param  generator     the generator returning the batches
+/// \param  stream        the stream to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  numberOfClasses number of classes of the labels
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream regression data from a sparse data (libSVM) file.
+///
+///
+/// \param  generator     the generator returning the batches
+/// \param  fn            the file to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream regression data from a sparse data (libSVM) stream.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// \param  generator     the generator returning the batches
+/// \param  stream        the stream to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream classification data from a sparse data (libSVM) file.
+///
+/// The labels are mapped to classes like by importSparseData: the labels -1 and +1 of binary
+/// problems are read as classes 0 and 1, otherwise the smallest label of the file becomes class 0.
+/// For this, the labels of all records are read once when the generator is created.
+/// The file must not contain more than numberOfClasses classes.
+///
+/// \param  generator     the generator returning the batches
+/// \param  fn            the file to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  numberOfClasses number of classes of the labels
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, unsigned int>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream classification data from a sparse data (libSVM) stream.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// The labels are mapped to classes like by importSparseData: the labels -1 and +1 of binary
+/// problems are read as classes 0 and 1, otherwise the smallest label of the file becomes class 0.
+/// For this, the labels of all records are read once when the generator is created.
+/// The file must not contain more than numberOfClasses classes.
+///
+/// \param  generator     the generator returning the batches
+/// \param  stream        the stream to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  numberOfClasses number of classes of the labels
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, unsigned int>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream regression data from a sparse data (libSVM) file.
+///
+///
+/// \param  generator     the generator returning the batches
+/// \param  fn            the file to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, RealVector>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+/// \brief Stream regression data from a sparse data (libSVM) stream.
+///
+/// The stream must stay alive as long as the generator is used. After the last record,
+/// the stream is rewound to the first record, which requires the stream to support seeking.
+///
+/// \param  generator     the generator returning the batches
+/// \param  stream        the stream to be read from
+/// \param  highestIndex  highest feature index, which is the dimensionality of the inputs
+/// \param  batchSize     size of the batches returned by the generator
+/// \param  cacheSize     number of batches the generator prepares in advance
+SHARK_EXPORT_SYMBOL void streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, RealVector>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t batchSize = constants::DefaultBatchSize,
+	std::size_t cacheSize = 0
+);
+
+
 /// \brief Export classification data to sparse data (libSVM) format.
 ///
 /// \param  dataset     Container storing the  data
@@ -35,6 +35,7 @@
 #define SHARK_DATA_STATISTICS_H
 
 #include <shark/Data/Dataset.h>
+#include <shark/LinAlg/BLAS/kernels/syrk.hpp>
 
 /**
 * \ingroup shark_globals
@@ -0,0 +1,531 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Kernel cache shared between subsets of a dataset
+ *
+ *
+ * \par
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+
+#ifndef SHARK_LINALG_SHAREDKERNELCACHE_H
+#define SHARK_LINALG_SHAREDKERNELCACHE_H
+
+#include <shark/Data/Dataset.h>
+#include <shark/LinAlg/Base.h>
+#include <shark/LinAlg/KernelMatrix.h>
+#include <shark/LinAlg/LRUCache.h>
+#include <shark/Data/DataView.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace shark {
+
+namespace detail{
+/// \brief Maps the elements of subsets sharing the batches of a dataset to their index in the dataset.
+template<class InputType>
+class SharedBatchIndex{
+public:
+	SharedBatchIndex(Data<InputType> const& data)
+	: m_batchStart(data.size() + 1, 0){
+		for(std::size_t b = 0; b != data.size(); ++b){
+			m_batchIndex[&data[b]] = b;
+			m_batchStart[b + 1] = m_batchStart[b] + batchSize(data[b]);
+		}
+	}
+
+	/// \brief Returns for every batch of a subset its index in the dataset.
+	///
+	/// Throws an exception if a batch of the subset is not a batch of the dataset.
+	std::vector<std::size_t> batchIndices(Data<InputType> const& subset) const{
+		std::vector<std::size_t> indices(subset.size());
+		for(std::size_t b = 0; b != subset.size(); ++b){
+			auto pos = m_batchIndex.find(&subset[b]);
+			SHARK_RUNTIME_CHECK(pos != m_batchIndex.end(), "Subset does not share its batches with the cached dataset");
+			indices[b] = pos->second;
+		}
+		return indices;
+	}
+
+	/// \brief Returns for every element of a subset its index in the dataset.
+	///
+	/// Throws an exception if a batch of the subset is not a batch of the dataset.
+	std::vector<std::size_t> elementIndices(Data<InputType> const& subset) const{
+		std::vector<std::size_t> indices;
+		indices.reserve(subset.numberOfElements());
+		for(std::size_t b : batchIndices(subset)){
+			for(std::size_t i = m_batchStart[b]; i != m_batchStart[b + 1]; ++i)
+				indices.push_back(i);
+		}
+		return indices;
+	}
+
+	/// \brief Index of the first element of every batch, followed by the number of elements.
+	std::vector<std::size_t> const& batchStart() const{
+		return m_batchStart;
+	}
+private:
+	/// maps the address of a batch to its index in the dataset
+	std::unordered_map<typename Data<InputType>::value_type const*, std::size_t> m_batchIndex;
+	std::vector<std::size_t> m_batchStart;
+};
+}
+
+///
+/// \brief Cache of kernel matrix rows of a dataset, shared by all its subsets
+///
+/// \par
+/// Cross-validation trains the same model on many subsets of a dataset,
+/// for example the training parts of the folds created by the functions in
+/// CVDatasetTools.h. With a KernelMatrix per training run, the kernel value
+/// between two points is recomputed once for every fold the two points share.
+/// The SharedKernelCache instead stores rows of the Gram matrix of the whole
+/// dataset, so that every value is computed at most once as long as the row
+/// stays in the cache. Subsets access the cache through a SubsetKernelMatrix,
+/// which can be used everywhere a KernelMatrix is used.
+///
+/// \par
+/// Subsets are identified by their batches: a subset created via
+/// indexedSubset shares the batches of the dataset and thus the position of
+/// every element in the full dataset can be recovered.
+///
+/// \par
+/// The rows are only valid for the parameters of the kernel at the time of
+/// computation. Before use, update() must be called to discard the stored
+/// rows in case the kernel parameters changed in between, e.g. because the
+/// kernel is subject to model selection. This is done by SubsetKernelMatrix.
+///
+/// \par
+/// NOTE: Like the KernelMatrix, the class does not copy the data and assumes
+/// that the dataset is not altered during its lifetime. The cache is not
+/// thread safe, only a single subset may be used at a time.
+///
+template <class InputType, class CacheType>
+class SharedKernelCache{
+public:
+	typedef CacheType QpFloatType;
+
+	/// Constructor
+	/// \param kernelfunction   kernel function defining the Gram matrix
+	/// \param data             the dataset of which subsets are used
+	/// \param cachesize        Main memory to use as a kernel cache, in QpFloatTypes. Must be able to hold at least one row.
+	SharedKernelCache(
+		AbstractKernelFunction<InputType> const& kernelfunction,
+		Data<InputType> const& data,
+		std::size_t cachesize = 0x4000000
+	): m_kernel(kernelfunction)
+	, m_data(data)
+	, m_matrix(kernelfunction, data)
+	, m_cache(data.numberOfElements(), cachesize)
+	, m_parameters(kernelfunction.parameterVector())
+	, m_batchIndex(m_data){
+		SHARK_RUNTIME_CHECK(cachesize >= size(), "Cache size is smaller than the size of a row!");
+	}
+
+	/// \brief Returns the kernel function used to compute the Gram matrix.
+	AbstractKernelFunction<InputType> const& kernel() const{
+		return m_kernel;
+	}
+
+	/// \brief Returns the dataset of which subsets can use the cache.
+	Data<InputType> const& data() const{
+		return m_data;
+	}
+
+	/// \brief Returns the i-th row of the Gram matrix of the whole dataset.
+	///
+	/// The row is computed if it is not already cached. The returned pointer is
+	/// only valid until the next call to row().
+	QpFloatType const* row(std::size_t i){
+		SIZE_CHECK(i < size());
+		bool cached = m_cache.isCached(i);
+		QpFloatType* line = m_cache.getCacheLine(i, size());
+		if(!cached)
+			m_matrix.row(i, 0, size(), line);
+		return line;
+	}
+
+	/// \brief Returns the i-th row of the Gram matrix restricted to the given batches.
+	///
+	/// The cache always computes the complete row.
+	QpFloatType const* row(std::size_t i, std::vector<std::size_t> const&){
+		return row(i);
+	}
+
+	/// \brief Returns the entry (i,j) of the Gram matrix of the whole dataset.
+	///
+	/// Cached rows or columns are used when available, otherwise the entry is computed
+	/// but not stored.
+	QpFloatType entry(std::size_t i, std::size_t j) const{
+		if(m_cache.isCached(i))
+			return m_cache.getLinePointer(i)[j];
+		if(m_cache.isCached(j))
+			return m_cache.getLinePointer(j)[i];
+		return m_matrix.entry(i, j);
+	}
+
+	/// \brief Returns for every element of a subset its index in the whole dataset.
+	///
+	/// Throws an exception if a batch of the subset is not a batch of the dataset.
+	std::vector<std::size_t> elementIndices(Data<InputType> const& subset) const{
+		return m_batchIndex.elementIndices(subset);
+	}
+
+	/// \brief Returns for every batch of a subset its index in the whole dataset.
+	std::vector<std::size_t> batchIndices(Data<InputType> const& subset) const{
+		return m_batchIndex.batchIndices(subset);
+	}
+
+	/// \brief Discards all cached rows if the kernel parameters changed since they were computed.
+	void update(){
+		RealVector parameters = m_kernel.parameterVector();
+		bool changed = parameters.size() != m_parameters.size();
+		for(std::size_t i = 0; !changed && i != parameters.size(); ++i)
+			changed = parameters(i) != m_parameters(i);
+		if(changed){
+			m_cache.clear();
+			m_parameters = parameters;
+		}
+	}
+
+	/// \brief Completely clear/purge the kernel cache.
+	void clear(){
+		m_cache.clear();
+	}
+
+	/// return the number of points in the dataset
+	std::size_t size() const{
+		return m_matrix.size();
+	}
+
+	/// return the number of rows currently cached
+	std::size_t cachedRows() const{
+		return m_cache.cachedLines();
+	}
+
+	/// return the size of the kernel cache (in "number of QpFloatType-s")
+	std::size_t maxSize() const{
+		return m_cache.maxSize();
+	}
+
+	/// query the number of kernel evaluations performed so far
+	unsigned long long getAccessCount() const{
+		return m_matrix.getAccessCount();
+	}
+
+private:
+	AbstractKernelFunction<InputType> const& m_kernel;
+	Data<InputType> m_data;
+	KernelMatrix<InputType, QpFloatType> m_matrix;
+	LRUCache<QpFloatType> m_cache;
+	/// kernel parameters with which the cached rows were computed
+	RealVector m_parameters;
+	detail::SharedBatchIndex<InputType> m_batchIndex;
+};
+
+///
+/// \brief Gram matrix of a dataset, computed once and shared read-only by all its subsets
+///
+/// \par
+/// The KernelRowStore is the thread safe counterpart of the SharedKernelCache.
+/// It holds storage for the whole Gram matrix, which is filled on demand:
+/// the kernel values between a point and the points of one batch of the
+/// dataset are computed when a subset containing that batch first asks for
+/// the row of the point. Every such segment is computed exactly once and is
+/// only read afterwards, also when several SubsetKernelMatrix objects are
+/// used concurrently, e.g. to solve the binary problems of a one-versus-one
+/// multi-class SVM in parallel. The store needs memory for all size()*size()
+/// entries.
+///
+/// \par
+/// Subsets are identified by their batches in the same way as by the
+/// SharedKernelCache. Computation on demand pays off if the batches are
+/// aligned with the subsets, for example if every batch holds a single
+/// class, see repartitionByClass.
+///
+/// \par
+/// If the kernel parameters change, update() discards all computed values.
+/// This must not happen while the store is in use by another thread.
+///
+template <class InputType, class CacheType>
+class KernelRowStore{
+public:
+	typedef CacheType QpFloatType;
+
+	/// Constructor
+	/// \param kernelfunction   kernel function defining the Gram matrix
+	/// \param data             the dataset of which subsets are used
+	KernelRowStore(
+		AbstractKernelFunction<InputType> const& kernelfunction,
+		Data<InputType> const& data
+	): m_kernel(kernelfunction)
+	, m_data(data)
+	, m_elements(m_data)
+	, m_matrix(m_elements.size(), m_elements.size())
+	, m_parameters(kernelfunction.parameterVector())
+	, m_batchIndex(m_data)
+	, m_accessCount(0){
+		clear();
+	}
+
+	/// \brief Returns the kernel function used to compute the Gram matrix.
+	AbstractKernelFunction<InputType> const& kernel() const{
+		return m_kernel;
+	}
+
+	/// \brief Returns the dataset of which subsets can use the store.
+	Data<InputType> const& data() const{
+		return m_data;
+	}
+
+	/// \brief Returns the i-th row of the Gram matrix restricted to the given batches.
+	///
+	/// Only the entries belonging to the elements of the given batches are valid,
+	/// missing ones are computed. The method can be called concurrently.
+	QpFloatType const* row(std::size_t i, std::vector<std::size_t> const& batches){
+		SIZE_CHECK(i < size());
+		for(std::size_t b : batches){
+			std::call_once(m_computed[i * m_data.size() + b], [this, i, b]{ computeSegment(i, b); });
+		}
+		return &m_matrix(i, 0);
+	}
+
+	/// \brief Returns the entry (i,j) of the Gram matrix of the whole dataset.
+	///
+	/// The entry is computed but not stored.
+	QpFloatType entry(std::size_t i, std::size_t j) const{
+		++m_accessCount;
+		return QpFloatType(m_kernel.eval(m_elements[i], m_elements[j]));
+	}
+
+	/// \brief Returns for every element of a subset its index in the whole dataset.
+	///
+	/// Throws an exception if a batch of the subset is not a batch of the dataset.
+	std::vector<std::size_t> elementIndices(Data<InputType> const& subset) const{
+		return m_batchIndex.elementIndices(subset);
+	}
+
+	/// \brief Returns for every batch of a subset its index in the whole dataset.
+	std::vector<std::size_t> batchIndices(Data<InputType> const& subset) const{
+		return m_batchIndex.batchIndices(subset);
+	}
+
+	/// \brief Discards all computed values if the kernel parameters changed since they were computed.
+	void update(){
+		RealVector parameters = m_kernel.parameterVector();
+		bool changed = parameters.size() != m_parameters.size();
+		for(std::size_t i = 0; !changed && i != parameters.size(); ++i)
+			changed = parameters(i) != m_parameters(i);
+		if(changed){
+			clear();
+			m_parameters = parameters;
+		}
+	}
+
+	/// \brief Discards all computed values.
+	void clear(){
+		m_computed.reset(new std::once_flag[size() * m_data.size()]);
+	}
+
+	/// return the number of points in the dataset
+	std::size_t size() const{
+		return m_elements.size();
+	}
+
+	/// return the size of the store (in "number of QpFloatType-s")
+	std::size_t maxSize() const{
+		return size() * size();
+	}
+
+	/// query the number of kernel evaluations performed so far
+	unsigned long long getAccessCount() const{
+		return m_accessCount;
+	}
+
+private:
+	/// computes the kernel values between element i and the elements of batch b
+	void computeSegment(std::size_t i, std::size_t b){
+		std::size_t start = m_batchIndex.batchStart()[b];
+		std::size_t end = m_batchIndex.batchStart()[b + 1];
+		auto const& xi = m_elements[i];
+		for(std::size_t j = start; j != end; ++j){
+			m_matrix(i, j) = QpFloatType(m_kernel.eval(xi, m_elements[j]));
+		}
+		m_accessCount += end - start;
+	}
+
+	AbstractKernelFunction<InputType> const& m_kernel;
+	Data<InputType> m_data;
+	DataView<Data<InputType> const> m_elements;
+	blas::matrix<QpFloatType> m_matrix;
+	/// one flag for every segment of a row belonging to a batch of the dataset
+	std::unique_ptr<std::once_flag[]> m_computed;
+	/// kernel parameters with which the values were computed
+	RealVector m_parameters;
+	detail::SharedBatchIndex<InputType> m_batchIndex;
+	mutable std::atomic<unsigned long long> m_accessCount;
+};
+
+///
+/// \brief Kernel Gram matrix of a subset of a dataset backed by a SharedKernelCache
+///
+/// \par
+/// The template parameter Cache is the type of the shared storage, either a
+/// SharedKernelCache or a KernelRowStore.
+///
+/// \par
+/// The SubsetKernelMatrix offers the same interface as the KernelMatrix of the
+/// subset and can thus be used by all quadratic programming solvers, either
+/// directly or wrapped in a PrecomputedMatrix. All entries are taken from the
+/// rows of the shared cache. Thus, when training on all folds of a
+/// cross-validation, every kernel value is computed only once instead of
+/// once per fold.
+///
+/// \par
+/// It also offers the row access of the CachedMatrix. Wrapping it in a
+/// CachedMatrix is therefore not needed and would only store the rows a
+/// second time. Instead, the requested part of the row of the shared cache is
+/// gathered into a buffer owned by the matrix. The solvers work on at most two
+/// rows at a time, thus the last two rows returned stay valid.
+///
+/// \par
+/// The access count reports the kernel evaluations that had to be performed
+/// by the shared cache during the lifetime of this object.
+///
+template <class InputType, class CacheType, class Cache = SharedKernelCache<InputType, CacheType> >
+class SubsetKernelMatrix{
+public:
+	typedef CacheType QpFloatType;
+
+	/// Constructor
+	/// \param cache    the cache of the full dataset
+	/// \param subset   data of the subset, must share its batches with the cached dataset
+	SubsetKernelMatrix(Cache& cache, Data<InputType> const& subset)
+	: m_cache(cache)
+	, m_indices(cache.elementIndices(subset))
+	, m_batches(cache.batchIndices(subset))
+	, m_currentBuffer(0){
+		m_cache.update();
+		m_accessOffset = m_cache.getAccessCount();
+	}
+
+	/// return a single matrix entry
+	QpFloatType operator () (std::size_t i, std::size_t j) const
+	{ return entry(i, j); }
+
+	/// return a single matrix entry
+	QpFloatType entry(std::size_t i, std::size_t j) const{
+		return m_cache.entry(m_indices[i], m_indices[j]);
+	}
+
+	/// \brief Computes the i-th row of the kernel matrix.
+	///
+	///The entries start,...,end of the i-th row are computed and stored in storage.
+	///There must be enough room for this operation preallocated.
+	void row(std::size_t i, std::size_t start,std::size_t end, QpFloatType* storage) const{
+		if(start == end) return;
+		QpFloatType const* line = m_cache.row(m_indices[i], m_batches);
+		for(std::size_t j = start; j != end; ++j){
+			storage[j - start] = line[m_indices[j]];
+		}
+	}
+
+	/// \brief Return a subset of a matrix row
+	///
+	/// \par
+	/// This method returns an array of QpFloatType with at least
+	/// the entries in the interval [begin, end[ filled in.
+	/// The array is valid until the next but one call to this method.
+	///
+	/// \param k      matrix row
+	/// \param start  first column to be filled in
+	/// \param end    last column to be filled in +1
+	QpFloatType* row(std::size_t k, std::size_t start, std::size_t end){
+		SIZE_CHECK(start <= end);
+		SIZE_CHECK(end <= size());
+		m_currentBuffer = 1 - m_currentBuffer;
+		std::vector<QpFloatType>& buffer = m_buffers[m_currentBuffer];
+		buffer.resize(size());
+		row(k, start, end, buffer.data() + start);
+		return buffer.data();
+	}
+
+	/// \brief Computes the kernel-matrix
+	template<class M>
+	void matrix(blas::matrix_expression<M, blas::cpu_tag> & storage) const{
+		for(std::size_t i = 0; i != size(); ++i){
+			QpFloatType const* line = m_cache.row(m_indices[i], m_batches);
+			for(std::size_t j = 0; j != size(); ++j){
+				storage()(i, j) = line[m_indices[j]];
+			}
+		}
+	}
+
+	/// swap two variables
+	void flipColumnsAndRows(std::size_t i, std::size_t j){
+		std::swap(m_indices[i], m_indices[j]);
+	}
+
+	/// return the size of the quadratic matrix
+	std::size_t size() const
+	{ return m_indices.size(); }
+
+	/// return the size of the shared cache (in "number of QpFloatType-s")
+	std::size_t getMaxCacheSize() const
+	{ return m_cache.maxSize(); }
+
+	/// query the kernel access counter
+	unsigned long long getAccessCount() const
+	{ return m_cache.getAccessCount() - m_accessOffset; }
+
+	/// reset the kernel access counter
+	void resetAccessCount()
+	{ m_accessOffset = m_cache.getAccessCount(); }
+
+private:
+	Cache& m_cache;
+	/// index of every subset element in the full dataset
+	std::vector<std::size_t> m_indices;
+	/// index of every batch of the subset in the full dataset
+	std::vector<std::size_t> m_batches;
+	unsigned long long m_accessOffset;
+	/// storage of the last two rows returned by row(k, start, end)
+	std::vector<QpFloatType> m_buffers[2];
+	std::size_t m_currentBuffer;
+};
+
+}
+#endif
@@ -131,8 +131,13 @@ public:
 	/// \param  noClasses  number of clases in the dataset, default 0 means that the number is computed 
 	SHARK_EXPORT_SYMBOL void initFromData(ClassificationDataset const& data, std::size_t noClusters = 0, std::size_t noClasses = 0);
 
-	/// initialize centroids from unlabeled data: 
-	/// take a random subset of data points
+	/// initialize centroids from unlabeled data using k-means++ seeding:
+	/// the first centroid is a random data point, every further centroid is
+	/// a data point drawn with probability proportional to its squared distance
+	/// to the closest centroid chosen so far.
+	///
+	/// See Arthur, D. and Vassilvitskii, S. k-means++: The Advantages of Careful Seeding.
+	/// Proceedings of the Eighteenth Annual ACM-SIAM Symposium on Discrete Algorithms, 2007.
 	///
 	/// \param  dataset dataset from which to take the centroids
 	/// \param  noClusters  number of centroids in the model
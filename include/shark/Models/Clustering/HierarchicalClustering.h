@@ -48,7 +48,10 @@ namespace shark {
 ///
 /// \par
 /// Binary space-partitioning is a simple and fast way of
-/// clustering.
+/// clustering. The clusters are the leaves of the tree. Space
+/// partitioning trees like the LCTree split the data top down,
+/// while the AgglomerativeTree contains the hierarchy found by
+/// agglomerative clustering.
 ///
 /// \par
 /// It is not clear how the unfolding of the tree can be
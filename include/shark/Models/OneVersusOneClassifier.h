@@ -133,7 +133,7 @@ public:
 	binary_classifier_type const& binary(unsigned int class_one, unsigned int class_zero) const{
 		SHARK_ASSERT(class_zero < class_one);
 		SHARK_ASSERT(class_one < m_classes);
-		unsigned int index = class_one * (class_zero - 1) / 2 + class_zero;
+		unsigned int index = class_one * (class_one - 1) / 2 + class_zero;
 		return *m_binary[index];
 	}
 
@@ -152,6 +152,27 @@ public:
 		m_binary.insert(m_binary.end(), binmodels.begin(), binmodels.end());
 	}
 
+	/// \brief Add binary classifiers for one more class to the model.
+	///
+	/// Same as above, but the model shares the ownership of the binary
+	/// classifiers, so they are kept alive as long as the model uses them.
+	void addClass(std::vector<boost::shared_ptr<binary_classifier_type> > const& binmodels)
+	{
+		std::vector<binary_classifier_type*> pointers;
+		for (std::size_t i=0; i<binmodels.size(); i++)
+			pointers.push_back(binmodels[i].get());
+		addClass(pointers);
+		m_owned.insert(m_owned.end(), binmodels.begin(), binmodels.end());
+	}
+
+	/// \brief Remove all binary classifiers, the model is reset to a single class.
+	void clear()
+	{
+		m_classes = 1;
+		m_binary.clear();
+		m_owned.clear();
+	}
+
 	boost::shared_ptr<State> createState()const{
 		return boost::shared_ptr<State>(new EmptyState());
 	}
@@ -215,6 +236,7 @@ public:
 protected:
 	unsigned int m_classes;                          ///< number of classes to be distinguished
 	std::vector<binary_classifier_type*> m_binary;        ///< list of binary classifiers
+	std::vector<boost::shared_ptr<binary_classifier_type> > m_owned;        ///< binary classifiers owned by the model
 };
 
 
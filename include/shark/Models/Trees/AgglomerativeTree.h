@@ -0,0 +1,374 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Binary tree built by agglomerative clustering.
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+
+#ifndef SHARK_MODELS_TREES_AGGLOMERATIVETREE_H
+#define SHARK_MODELS_TREES_AGGLOMERATIVETREE_H
+
+#include <shark/Models/Trees/BinaryTree.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <shark/Data/Dataset.h>
+#include <shark/Data/DataView.h>
+#include <shark/LinAlg/Base.h>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace shark {
+
+
+///
+/// \brief Binary tree of the hierarchy of clusters found by agglomerative clustering.
+///
+/// \par
+/// Agglomerative clustering starts with every point in its own cluster
+/// and repeatedly merges the two clusters with the smallest dissimilarity.
+/// The merges form a binary tree over the points, which can be used by
+/// HierarchicalClustering. Two dissimilarities, both based on the
+/// Euclidean distance, are supported:
+/// <ul>
+///   <li>Ward: the increase of the sum of squared distances of the points to the centroids of their clusters,
+///       \f$ \frac{|A||B|}{|A|+|B|} \|c_A - c_B\|^2 \f$.</li>
+///   <li>Average: the average squared distance between the points of the two clusters,
+///       \f$ \|c_A - c_B\|^2 + s_A + s_B \f$, where \f$ s_A \f$ is the mean squared
+///       distance of the points of A to their centroid.</li>
+/// </ul>
+/// Both are computed from the centroids, sizes and spreads of the clusters, so no
+/// matrix of pairwise distances is stored and the memory is linear in the number of points.
+///
+/// \par
+/// The merges are found by the nearest-neighbor chain algorithm: a chain of clusters is
+/// grown, each the nearest neighbor of its predecessor, until two clusters are
+/// mutual nearest neighbors and can be merged. For both dissimilarities this gives the
+/// same hierarchy as merging the globally closest pair in every step, with O(n^2)
+/// dissimilarity evaluations in total. The nearest neighbor searches over the
+/// clusters are split into blocks that are processed in parallel.
+///
+/// \par
+/// The TreeConstruction object limits the depth of the tree and the size of the leaves,
+/// i.e. the clusters of the HierarchicalClustering. A new point is assigned to the child
+/// whose centroid is closer, thus the separating function of a node is the hyperplane
+/// bisecting the centroids of its children. As the clusters are not separated by these planes,
+/// the lower bounds on the distances to the points of a node are computed from the
+/// bounding boxes of the points.
+///
+/// \par
+/// See Murtagh, F. A survey of recent advances in hierarchical clustering algorithms.
+/// The Computer Journal 26(4), 1983.
+///
+/// \ingroup space_trees
+class AgglomerativeTree : public BinaryTree<RealVector>
+{
+	typedef BinaryTree<RealVector> base_type;
+public:
+	/// \brief Dissimilarity of clusters used for merging.
+	enum Linkage{
+		Ward,
+		Average
+	};
+
+	/// \brief Clusters the data and builds the tree of the merges.
+	///
+	/// It is assumed that the container exceeds
+	/// the lifetime of the tree, as the tree only
+	/// stores the indices of the points.
+	///
+	/// \param dataset  the points to cluster
+	/// \param linkage  dissimilarity of clusters
+	/// \param tc       limits of the depth of the tree and the size of the leaves
+	AgglomerativeTree(Data<RealVector> const& dataset, Linkage linkage = Ward, TreeConstruction tc = TreeConstruction())
+	: base_type(dataset.numberOfElements())
+	, m_height(0.0){
+		DataView<Data<RealVector> const> points(dataset);
+		std::size_t n = points.size();
+		std::vector<Merge> merges = nearestNeighborChain(points, linkage);
+
+		//number of points of every cluster, the clusters with index n+i are created by merge i
+		std::vector<std::size_t> clusterSizes(2 * n - 1, 1);
+		for(std::size_t i = 0; i != merges.size(); ++i)
+			clusterSizes[n + i] = clusterSizes[merges[i].left] + clusterSizes[merges[i].right];
+
+		//order the points such that every cluster is a contiguous range of the index list
+		std::vector<std::pair<std::size_t, std::size_t> > stack(1, std::make_pair(2 * n - 2, std::size_t(0)));
+		while(!stack.empty()){
+			std::size_t cluster = stack.back().first;
+			std::size_t offset = stack.back().second;
+			stack.pop_back();
+			if(cluster < n){
+				mp_indexList[offset] = cluster;
+			}else{
+				Merge const& merge = merges[cluster - n];
+				stack.push_back(std::make_pair(merge.left, offset));
+				stack.push_back(std::make_pair(merge.right, offset + clusterSizes[merge.left]));
+			}
+		}
+
+		//create the nodes top down. The tree can be deep, therefore no recursion is used
+		std::vector<AgglomerativeTree*> nodes;
+		std::vector<std::pair<AgglomerativeTree*, std::size_t> > open(1, std::make_pair(this, 2 * n - 2));
+		std::vector<TreeConstruction> constructions(1, tc);
+		while(!open.empty()){
+			AgglomerativeTree* node = open.back().first;
+			std::size_t cluster = open.back().second;
+			TreeConstruction nodeTc = constructions.back();
+			open.pop_back();
+			constructions.pop_back();
+			nodes.push_back(node);
+			if(cluster < n || nodeTc.maxDepth() == 0 || node->m_size <= nodeTc.maxBucketSize())
+				continue;
+			Merge const& merge = merges[cluster - n];
+			std::size_t leftSize = clusterSizes[merge.left];
+			node->m_height = merge.height;
+			node->mp_left = new AgglomerativeTree(node, node->mp_indexList, leftSize);
+			node->mp_right = new AgglomerativeTree(node, node->mp_indexList + leftSize, node->m_size - leftSize);
+			open.push_back(std::make_pair((AgglomerativeTree*)node->mp_left, merge.left));
+			open.push_back(std::make_pair((AgglomerativeTree*)node->mp_right, merge.right));
+			constructions.push_back(nodeTc.nextDepthLevel());
+			constructions.push_back(nodeTc.nextDepthLevel());
+		}
+
+		//compute centroids, bounding boxes and separating planes bottom up
+		for(std::size_t i = nodes.size(); i != 0; --i){
+			nodes[i - 1]->finalize(points);
+		}
+	}
+
+	/// \brief Dissimilarity of the children at the time they were merged, 0 for leaves.
+	double height() const{
+		return m_height;
+	}
+
+	/// \brief Centroid of the points of this node.
+	RealVector const& centroid() const{
+		return m_centroid;
+	}
+
+	/// \par
+	/// Compute the squared Euclidean distance of
+	/// the bounding box of the points of this node
+	/// to the given reference point.
+	double squaredDistanceLowerBound(RealVector const& reference) const{
+		double dist = 0.0;
+		for(std::size_t d = 0; d != reference.size(); ++d){
+			double gap = std::max(std::max(m_lower(d) - reference(d), reference(d) - m_upper(d)), 0.0);
+			dist += gap * gap;
+		}
+		return dist;
+	}
+
+protected:
+	using base_type::mep_parent;
+	using base_type::mp_left;
+	using base_type::mp_right;
+	using base_type::mp_indexList;
+	using base_type::m_size;
+	using base_type::m_nodes;
+	using base_type::m_threshold;
+
+	/// (internal) construction of a non-root node
+	AgglomerativeTree(AgglomerativeTree* parent, std::size_t* list, std::size_t size)
+	: base_type(parent, list, size), m_height(0.0){}
+
+	/// function describing the separating hyperplane
+	double funct(RealVector const& reference) const{
+		return inner_prod(m_normal, reference);
+	}
+
+private:
+	/// \brief Merge of two clusters, given by their indices.
+	struct Merge{
+		std::size_t left;
+		std::size_t right;
+		double height;
+	};
+
+	/// \brief Computes the merges of the agglomerative clustering.
+	///
+	/// The points are the clusters 0,...,n-1, the cluster created by the i-th merge has index n+i.
+	/// The active clusters are stored in the first rows of a matrix of centroids, when two clusters
+	/// are merged, the result takes the row of the first, and the last active cluster is moved into
+	/// the row of the second.
+	static std::vector<Merge> nearestNeighborChain(DataView<Data<RealVector> const> const& points, Linkage linkage){
+		std::size_t n = points.size();
+		std::size_t dim = points[0].size();
+		RealMatrix centroids(n, dim);
+		std::vector<double> sizes(n, 1.0);
+		std::vector<double> spreads(n, 0.0);
+		std::vector<std::size_t> clusters(n);//cluster stored in each row
+		std::vector<std::size_t> rowOf(2 * n - 1);//row of each active cluster
+		for(std::size_t i = 0; i != n; ++i){
+			noalias(row(centroids, i)) = points[i];
+			clusters[i] = i;
+			rowOf[i] = i;
+		}
+
+		auto dissimilarity = [&](std::size_t s, std::size_t t){
+			double const* x = &centroids(s, 0);
+			double const* y = &centroids(t, 0);
+			double dist = 0.0;
+			for(std::size_t d = 0; d != dim; ++d)
+				dist += (x[d] - y[d]) * (x[d] - y[d]);
+			if(linkage == Ward)
+				return sizes[s] * sizes[t] / (sizes[s] + sizes[t]) * dist;
+			return dist + spreads[s] + spreads[t];
+		};
+		//smaller dissimilarity, ties are broken by the smaller cluster index to be independent of the order of the rows
+		typedef std::pair<double, std::size_t> Candidate;
+
+		std::size_t const blockSize = 4096;
+		std::vector<Candidate> blockResults;
+		std::vector<Merge> merges;
+		merges.reserve(n - 1);
+		std::vector<std::size_t> chain;
+		std::size_t active = n;
+		while(active > 1){
+			if(chain.empty())
+				chain.push_back(clusters[0]);
+			std::size_t current = rowOf[chain.back()];
+
+			//find the nearest neighbor of the last cluster of the chain
+			std::size_t numBlocks = (active + blockSize - 1) / blockSize;
+			blockResults.assign(numBlocks, Candidate(std::numeric_limits<double>::max(), 0));
+			auto searchBlock = [&](std::size_t b){
+				Candidate best(std::numeric_limits<double>::max(), 0);
+				std::size_t end = std::min(active, (b + 1) * blockSize);
+				double const* x = &centroids(current, 0);
+				for(std::size_t t = b * blockSize; t != end; ++t){
+					if(t == current) continue;
+					double const* y = &centroids(t, 0);
+					double dist = 0.0;
+					for(std::size_t d = 0; d != dim; ++d)
+						dist += (x[d] - y[d]) * (x[d] - y[d]);
+					if(linkage == Ward)
+						dist *= sizes[current] * sizes[t] / (sizes[current] + sizes[t]);
+					else
+						dist += spreads[current] + spreads[t];
+					Candidate candidate(dist, clusters[t]);
+					if(candidate < best)
+						best = candidate;
+				}
+				blockResults[b] = best;
+			};
+			if(numBlocks == 1)
+				searchBlock(0);
+			else
+				threading::parallelND({numBlocks}, {1}, searchBlock, threading::globalThreadPool());
+			Candidate best = *std::min_element(blockResults.begin(), blockResults.end());
+
+			//on ties the predecessor in the chain is preferred, otherwise the chain might not terminate
+			if(chain.size() > 1){
+				std::size_t previous = chain[chain.size() - 2];
+				double dist = dissimilarity(current, rowOf[previous]);
+				if(dist <= best.first)
+					best = Candidate(dist, previous);
+			}
+			if(chain.size() == 1 || best.second != chain[chain.size() - 2]){
+				chain.push_back(best.second);
+				continue;
+			}
+
+			//the last two clusters of the chain are mutual nearest neighbors: merge them
+			chain.pop_back();
+			chain.pop_back();
+			std::size_t s = current;
+			std::size_t t = rowOf[best.second];
+			Merge merge = {clusters[s], clusters[t], best.first};
+			merges.push_back(merge);
+
+			double total = sizes[s] + sizes[t];
+			RealVector centroid = (sizes[s] * row(centroids, s) + sizes[t] * row(centroids, t)) / total;
+			spreads[s] = (
+				sizes[s] * (spreads[s] + distanceSqr(row(centroids, s), centroid))
+				+ sizes[t] * (spreads[t] + distanceSqr(row(centroids, t), centroid))
+			) / total;
+			sizes[s] = total;
+			noalias(row(centroids, s)) = centroid;
+			clusters[s] = n + merges.size() - 1;
+			rowOf[clusters[s]] = s;
+
+			--active;
+			if(t != active){
+				noalias(row(centroids, t)) = row(centroids, active);
+				sizes[t] = sizes[active];
+				spreads[t] = spreads[active];
+				clusters[t] = clusters[active];
+				rowOf[clusters[t]] = t;
+			}
+		}
+		return merges;
+	}
+
+	/// computes centroid, bounding box and separating plane of a node whose children are finalized
+	void finalize(DataView<Data<RealVector> const> const& points){
+		if(isLeaf()){
+			m_nodes = 1;
+			m_centroid = points[mp_indexList[0]];
+			m_lower = m_centroid;
+			m_upper = m_centroid;
+			for(std::size_t i = 1; i != m_size; ++i){
+				auto const& point = points[mp_indexList[i]];
+				noalias(m_centroid) += point;
+				noalias(m_lower) = min(m_lower, point);
+				noalias(m_upper) = max(m_upper, point);
+			}
+			m_centroid /= double(m_size);
+			m_normal = RealVector(m_centroid.size(), 0.0);
+			m_threshold = 0.0;
+			return;
+		}
+		AgglomerativeTree const* left = (AgglomerativeTree const*)mp_left;
+		AgglomerativeTree const* right = (AgglomerativeTree const*)mp_right;
+		m_nodes = 1 + left->m_nodes + right->m_nodes;
+		m_centroid = (left->m_size * left->m_centroid + right->m_size * right->m_centroid) / double(m_size);
+		m_lower = min(left->m_lower, right->m_lower);
+		m_upper = max(left->m_upper, right->m_upper);
+
+		//the plane bisecting the centroids of the children, normalized such that funct measures distances
+		m_normal = right->m_centroid - left->m_centroid;
+		double length = norm_2(m_normal);
+		if(length > 0.0)
+			m_normal /= length;
+		m_threshold = 0.5 * inner_prod(m_normal, left->m_centroid + right->m_centroid);
+	}
+
+	RealVector m_centroid;///< centroid of the points of this node
+	RealVector m_normal;///< normal of the separating hyperplane
+	RealVector m_lower;///< lower corner of the bounding box of the points
+	RealVector m_upper;///< upper corner of the bounding box of the points
+	double m_height;///< dissimilarity of the children when they were merged
+};
+
+
+}
+#endif
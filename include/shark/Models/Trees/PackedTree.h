@@ -0,0 +1,270 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Pointer-free array layout of binary space-partitioning trees.
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+
+#ifndef SHARK_MODELS_TREES_PACKEDTREE_H
+#define SHARK_MODELS_TREES_PACKEDTREE_H
+
+#include <shark/Models/Trees/BinaryTree.h>
+#include <shark/Core/ISerializable.h>
+#include <shark/Data/Dataset.h>
+#include <shark/Data/DataView.h>
+#include <shark/LinAlg/Base.h>
+#include <boost/serialization/vector.hpp>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace shark {
+
+///
+/// \brief Pointer-free copy of a binary space-partitioning tree together with its points.
+///
+/// \par
+/// The nodes of a BinaryTree are allocated one by one and linked by pointers,
+/// and the points are only referenced by their index in the dataset. The
+/// PackedTree stores the same hierarchy in a few contiguous arrays:
+/// the nodes are stored in one array in which the two children of a node are
+/// stored next to each other, such that only the index of the left child is
+/// needed. The points are copied in the order of the leaves, therefore the
+/// points of every node, inner nodes included, are a contiguous range of rows
+/// of a matrix and scanning a leaf reads consecutive memory.
+///
+/// \par
+/// Instead of the splitting functions of the tree, every node stores the
+/// axis-aligned bounding box of its points, which gives lower bounds on the
+/// Euclidean distance between points and nodes, and between two nodes.
+/// For trees like the KDTree and the LCTree these bounds are at least as tight
+/// as the cells of the tree. The structure of a KHCTree can be packed as well,
+/// but the bounds refer to the Euclidean distance in input space, not to the
+/// distance induced by the kernel.
+///
+/// \par
+/// As all data is stored in arrays of plain values, a PackedTree is cheap to
+/// serialize and load, and does not depend on the original tree or dataset.
+/// \ingroup space_trees
+class PackedTree : public ISerializable{
+public:
+	/// \brief Node of the packed tree.
+	struct Node{
+		std::uint64_t begin;///< first row of the points of the node
+		std::uint64_t end;///< end of the rows of the points of the node
+		std::uint64_t left;///< index of the left child, the right child follows it. 0 for leaves.
+
+		template<class Archive>
+		void serialize(Archive & ar, const unsigned int version){
+			ar & begin;
+			ar & end;
+			ar & left;
+		}
+	};
+
+	/// \brief Creates an empty tree.
+	PackedTree(){}
+
+	/// \brief Packs a tree built on the given points.
+	///
+	/// \param tree    the tree to pack. Its indices refer to elements of points.
+	/// \param points  the points the tree was built from
+	PackedTree(BinaryTree<RealVector> const* tree, Data<RealVector> const& points){
+		DataView<Data<RealVector> const> view(points);
+		SHARK_RUNTIME_CHECK(tree->size() == view.size(), "The tree must hold all points of the dataset");
+		std::size_t dim = view.size() == 0 ? 0 : view[0].size();
+		m_points.resize(view.size(), dim);
+		m_indices.reserve(view.size());
+		m_nodes.push_back(Node());
+		pack(tree, 0, view);
+		m_lower.resize(m_nodes.size(), dim);
+		m_upper.resize(m_nodes.size(), dim);
+		computeBox(0);
+	}
+
+	/// \brief Number of nodes of the tree. The root is node 0.
+	std::size_t numberOfNodes() const{
+		return m_nodes.size();
+	}
+
+	/// \brief Number of points stored in the tree.
+	std::size_t size() const{
+		return m_points.size1();
+	}
+
+	/// \brief Dimensionality of the points.
+	std::size_t dimension() const{
+		return m_points.size2();
+	}
+
+	Node const& node(std::size_t i) const{
+		return m_nodes[i];
+	}
+
+	bool isLeaf(std::size_t i) const{
+		return m_nodes[i].left == 0;
+	}
+
+	/// \brief Index of the left child of node i.
+	std::size_t left(std::size_t i) const{
+		return m_nodes[i].left;
+	}
+
+	/// \brief Index of the right child of node i.
+	std::size_t right(std::size_t i) const{
+		return m_nodes[i].left + 1;
+	}
+
+	/// \brief Number of points of node i.
+	std::size_t size(std::size_t i) const{
+		return m_nodes[i].end - m_nodes[i].begin;
+	}
+
+	/// \brief Returns the points in the order of the leaves.
+	RealMatrix const& points() const{
+		return m_points;
+	}
+
+	/// \brief Returns the index in the original dataset of the point stored in the given row.
+	std::size_t pointIndex(std::size_t row) const{
+		return m_indices[row];
+	}
+
+	/// \brief Lower corners of the bounding boxes, row i belongs to node i.
+	RealMatrix const& lowerCorners() const{
+		return m_lower;
+	}
+
+	/// \brief Upper corners of the bounding boxes, row i belongs to node i.
+	RealMatrix const& upperCorners() const{
+		return m_upper;
+	}
+
+	/// \brief Lower bound on the squared Euclidean distance of the point to the points of node i.
+	double squaredDistanceLowerBound(std::size_t i, RealVector const& point) const{
+		SIZE_CHECK(point.size() == dimension());
+		double const* lower = &m_lower(i, 0);
+		double const* upper = &m_upper(i, 0);
+		double ret = 0.0;
+		for(std::size_t d = 0; d != dimension(); ++d){
+			double gap = std::max(std::max(lower[d] - point(d), point(d) - upper[d]), 0.0);
+			ret += gap * gap;
+		}
+		return ret;
+	}
+
+	/// \brief Lower bound on the squared Euclidean distance between the points of node i and the points of node j of the other tree.
+	double squaredDistanceLowerBound(std::size_t i, PackedTree const& other, std::size_t j) const{
+		SIZE_CHECK(other.dimension() == dimension());
+		double const* lower1 = &m_lower(i, 0);
+		double const* upper1 = &m_upper(i, 0);
+		double const* lower2 = &other.m_lower(j, 0);
+		double const* upper2 = &other.m_upper(j, 0);
+		double ret = 0.0;
+		for(std::size_t d = 0; d != dimension(); ++d){
+			double gap = std::max(std::max(lower1[d] - upper2[d], lower2[d] - upper1[d]), 0.0);
+			ret += gap * gap;
+		}
+		return ret;
+	}
+
+	/// from ISerializable, reads the tree from an archive
+	void read(InArchive& archive){
+		archive >> m_nodes;
+		archive >> m_lower;
+		archive >> m_upper;
+		archive >> m_points;
+		archive >> m_indices;
+	}
+
+	/// from ISerializable, writes the tree to an archive
+	void write(OutArchive& archive) const{
+		archive << m_nodes;
+		archive << m_lower;
+		archive << m_upper;
+		archive << m_points;
+		archive << m_indices;
+	}
+
+private:
+	/// copies the subtree of the node with the given index in depth first order
+	void pack(BinaryTree<RealVector> const* tree, std::size_t id, DataView<Data<RealVector> const> const& points){
+		m_nodes[id].begin = m_indices.size();
+		if(tree->hasChildren()){
+			std::size_t left = m_nodes.size();
+			m_nodes.resize(left + 2);
+			m_nodes[id].left = left;
+			pack(tree->left(), left, points);
+			pack(tree->right(), left + 1, points);
+		}else{
+			m_nodes[id].left = 0;
+			for(std::size_t i = 0; i != tree->size(); ++i){
+				std::size_t row = m_indices.size();
+				m_indices.push_back(tree->index(i));
+				noalias(blas::row(m_points, row)) = points[tree->index(i)];
+			}
+		}
+		m_nodes[id].end = m_indices.size();
+	}
+
+	/// computes the bounding boxes of the subtree of node i
+	void computeBox(std::size_t i){
+		if(isLeaf(i)){
+			for(std::size_t d = 0; d != dimension(); ++d){
+				double minimum = std::numeric_limits<double>::max();
+				double maximum = -std::numeric_limits<double>::max();
+				for(std::size_t p = m_nodes[i].begin; p != m_nodes[i].end; ++p){
+					minimum = std::min(minimum, m_points(p, d));
+					maximum = std::max(maximum, m_points(p, d));
+				}
+				m_lower(i, d) = minimum;
+				m_upper(i, d) = maximum;
+			}
+		}else{
+			std::size_t l = left(i);
+			std::size_t r = right(i);
+			computeBox(l);
+			computeBox(r);
+			for(std::size_t d = 0; d != dimension(); ++d){
+				m_lower(i, d) = std::min(m_lower(l, d), m_lower(r, d));
+				m_upper(i, d) = std::max(m_upper(l, d), m_upper(r, d));
+			}
+		}
+	}
+
+	std::vector<Node> m_nodes;///< nodes, the children of a node are stored next to each other
+	RealMatrix m_lower;///< lower corners of the bounding boxes, one row per node
+	RealMatrix m_upper;///< upper corners of the bounding boxes, one row per node
+	RealMatrix m_points;///< points in the order of the leaves
+	std::vector<std::size_t> m_indices;///< index in the dataset of every row of m_points
+};
+
+}
+#endif
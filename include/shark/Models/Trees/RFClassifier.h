@@ -40,6 +40,11 @@
 #include <shark/ObjectiveFunctions/Loss/ZeroOneLoss.h>
 #include <shark/ObjectiveFunctions/Loss/SquaredLoss.h>        
 #include <shark/Data/DataView.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <random>
 
 namespace shark {
 ///
@@ -56,64 +61,101 @@ namespace shark {
 /// which allows the use the out-of-bag error estimates for an approximately
 /// unbiased estimate of the test-error as well as unbiased feature-importance
 /// estimates using feature permutation.
+///
+/// \par
+/// For evaluation, the nodes of all trees are packed into a single array
+/// of compact nodes by compile(), which is called by the RFTrainer and after
+/// deserialization. Batches of patterns are then split into blocks, which are
+/// evaluated in parallel, and every block is passed through one tree after the
+/// other, such that the upper nodes of a tree stay in the cache. The result is
+/// the same as evaluating the trees of the ensemble. If the trees are changed
+/// through model(i) after compilation, compile() must be called again.
+/// Only the forest itself uses the compiled trees, decisionFunction() evaluates
+/// the trees of the ensemble one by one.
 /// \ingroup models
 template<class LabelType>
 class RFClassifier : public Ensemble<CARTree<LabelType> >{
 private:
+	typedef Ensemble<CARTree<LabelType> > base_type;
+	
+	/// \brief Node of the compiled forest.
+	struct CompiledNode{
+		double threshold;///< patterns with feature value smaller or equal to the threshold go to the left child
+		std::uint32_t feature;///< feature tested by the node, leafNode for leaves
+		std::uint32_t child;///< index of the left child, the right child follows it. For leaves the label or the index of the label values
+	};
+	static const std::uint32_t leafNode = std::numeric_limits<std::uint32_t>::max();
+	/// number of patterns in the blocks evaluated in parallel
+	static const std::size_t blockSize = 256;
+	
+
 	//OOB-Error for regression
-	template<class VectorType>
 	double doComputeOOBerror(
-		UIntMatrix const& oobPoints, LabeledData<VectorType, VectorType> const& data
+		std::vector<std::vector<std::size_t> > const& oobIndices,
+		std::vector<RealMatrix> const& predictions,
+		LabeledData<RealVector, RealVector> const& data
 	){
+		//aquire the weighted mean prediction of the trees for every element
+		std::size_t ell = data.numberOfElements();
+		RealMatrix mean(ell, labelDimension(data), 0.0);
+		RealVector oobWeightSum(ell, 0.0);
+		for(std::size_t m = 0; m != this->numberOfModels();++m){
+			for(std::size_t k = 0; k != oobIndices[m].size(); ++k){
+				std::size_t elem = oobIndices[m][k];
+				oobWeightSum(elem) += this->weight(m);
+				noalias(row(mean, elem)) += this->weight(m) * row(predictions[m], k);
+			}
+		}
 		double OOBerror = 0;
-		//aquire votes for every element
-		VectorType mean(labelDimension(data));
-		VectorType input(inputDimension(data));
 		std::size_t elem = 0;
 		for(auto const& point: elements(data)){
-			noalias(input) = point.input;
-			mean.clear();
-			double oobWeightSum = 0;
-			for(std::size_t m = 0; m != this->numberOfModels();++m){
-				if(oobPoints(m,elem)){
-					oobWeightSum += this->weight(m);
-					noalias(mean) += this->weight(m) * this->model(m)(input);
-				}
-			}
-			mean /= oobWeightSum;
-			OOBerror += 0.5 * norm_sqr(point.label - mean);
+			OOBerror += 0.5 * norm_sqr(point.label - row(mean, elem) / oobWeightSum(elem));
 			++elem;
 		}
-		OOBerror /= data.numberOfElements();
+		OOBerror /= ell;
 		return OOBerror;
 	}
 	
 	//OOB-Error for Classification
-	template<class VectorType>
 	double doComputeOOBerror(
-		UIntMatrix const& oobPoints, LabeledData<VectorType, unsigned int> const& data
+		std::vector<std::vector<std::size_t> > const& oobIndices,
+		std::vector<UIntVector> const& predictions,
+		LabeledData<RealVector, unsigned int> const& data
 	){
-		double OOBerror = 0;
 		//aquire votes for every element
-		RealVector votes(numberOfClasses(data));
-		RealVector input(inputDimension(data));
+		std::size_t ell = data.numberOfElements();
+		RealMatrix votes(ell, numberOfClasses(data), 0.0);
+		for(std::size_t m = 0; m != this->numberOfModels();++m){
+			for(std::size_t k = 0; k != oobIndices[m].size(); ++k){
+				votes(oobIndices[m][k], predictions[m](k)) += this->weight(m);
+			}
+		}
+		double OOBerror = 0;
 		std::size_t elem = 0;
 		for(auto const& point: elements(data)){
-			noalias(input) = point.input;
-			votes.clear();
-			for(std::size_t m = 0; m != this->numberOfModels();++m){
-				if(oobPoints(m,elem)){
-					unsigned int label = this->model(m)(input);
-					votes(label) += this->weight(m);
-				}
-			}
-			OOBerror += (arg_max(votes) != point.label);
+			OOBerror += (arg_max(row(votes, elem)) != point.label);
 			++elem;
 		}
-		OOBerror /= data.numberOfElements();
+		OOBerror /= ell;
 		return OOBerror;
 	}
 	
+	// evaluates every tree on its out-of-bag points, the trees are processed in parallel
+	std::vector<typename Batch<LabelType>::type> oobPredictions(
+		std::vector<std::vector<std::size_t> > const& oobIndices,
+		DataView<LabeledData<RealVector, LabelType> const > const& view
+	)const{
+		SHARK_RUNTIME_CHECK(oobIndices.size() == this->numberOfModels(), "Number of out-of-bag sets must match the number of trees");
+		std::vector<typename Batch<LabelType>::type> predictions(this->numberOfModels());
+		auto evalTree = [&](std::size_t m){
+			if(oobIndices[m].empty()) return;
+			auto batch = subBatch(view, oobIndices[m]);
+			predictions[m] = this->model(m)(batch.input);
+		};
+		threading::parallelND({this->numberOfModels()}, {1}, evalTree, threading::globalThreadPool());
+		return predictions;
+	}
+	
 	//loss for regression
 	double loss(RealMatrix const& labels, RealMatrix const& predictions) const{
 		SquaredLoss<RealVector, RealVector> loss;
@@ -125,12 +167,192 @@ private:
 		return loss.eval(labels,  predictions);
 	}
 	
+	//stores the label of a leaf of a classification tree in the node
+	std::uint32_t compileLeaf(unsigned int label){
+		return label;
+	}
+	//stores the label of a leaf of a regression tree in m_leafValues
+	std::uint32_t compileLeaf(RealVector const& label){
+		std::size_t index = m_leafValues.size();
+		m_leafValues.insert(m_leafValues.end(), label.begin(), label.end());
+		SHARK_RUNTIME_CHECK(index < leafNode, "Forest too large for compilation");
+		return std::uint32_t(index);
+	}
+	
+	//pooling for classification: count the votes of the trees
+	void addLeaf(RealMatrix& outputs, std::size_t p, std::uint32_t leaf, double weight, unsigned int const*)const{
+		outputs(p, leaf) += weight;
+	}
+	//pooling for regression: sum up the predictions of the trees
+	void addLeaf(RealMatrix& outputs, std::size_t p, std::uint32_t leaf, double weight, RealVector const*)const{
+		double const* values = m_leafValues.data() + leaf;
+		for(std::size_t k = 0; k != outputs.size2(); ++k){
+			outputs(p, k) += weight * values[k];
+		}
+	}
+	
+	// computes the pooled output of the ensemble using the compiled forest
+	void evalCompiled(RealMatrix const& patterns, RealMatrix& outputs) const{
+		std::size_t numPatterns = patterns.size1();
+		outputs.resize(numPatterns, this->outputShape().numElements());
+		outputs.clear();
+		double weightSum = this->sumOfWeights();
+		auto evalBlock = [&](std::size_t block){
+			std::size_t start = block * blockSize;
+			std::size_t end = std::min(start + blockSize, numPatterns);
+			//like Ensemble::pool: sum up the raw weights and normalize once
+			for(std::size_t t = 0; t != m_roots.size(); ++t){
+				double weight = this->weight(t);
+				for(std::size_t p = start; p != end; ++p){
+					double const* x = &patterns(p, 0);
+					CompiledNode const* node = &m_nodes[m_roots[t]];
+					while(node->feature != leafNode){
+						//same comparison as CARTree::findLeaf, computed without branch
+						node = &m_nodes[node->child + !(x[node->feature] <= node->threshold)];
+					}
+					addLeaf(outputs, p, node->child, weight, (LabelType const*)nullptr);
+				}
+			}
+			noalias(rows(outputs, start, end)) /= weightSum;
+		};
+		std::size_t numBlocks = (numPatterns + blockSize - 1) / blockSize;
+		if(numBlocks <= 1){
+			evalBlock(0);
+		}else{
+			threading::parallelND({numBlocks}, {1}, evalBlock, threading::globalThreadPool());
+		}
+	}
+	
+	//classification: choose the class with the most votes
+	void finalize(RealMatrix const& votes, UIntVector& outputs)const{
+		std::size_t batchSize = votes.size1();
+		outputs.resize(batchSize);
+		RealVector const& bias = this->bias();
+		if(votes.size2() == 1){
+			double b = bias.empty()? 0.0 : bias(0);
+			for(std::size_t i = 0; i != batchSize; ++i){
+				outputs(i) = votes(i,0) + b > 0;
+			}
+		}else{
+			for(std::size_t i = 0; i != batchSize; ++i){
+				if(bias.empty())
+					outputs(i) = static_cast<unsigned int>(arg_max(row(votes,i)));
+				else
+					outputs(i) = static_cast<unsigned int>(arg_max(row(votes,i) + bias));
+			}
+		}
+	}
+	//regression: the pooled prediction is the output
+	void finalize(RealMatrix& prediction, RealMatrix& outputs)const{
+		outputs = std::move(prediction);
+	}
+	
 public:
+	typedef typename base_type::BatchInputType BatchInputType;
+	typedef typename base_type::BatchOutputType BatchOutputType;
+	
+	/// \brief Layout of the nodes of the compiled trees.
+	enum class NodeOrdering{
+		BreadthFirst,///< the nodes of a tree are stored level by level
+		DepthFirst ///< the subtree of the left child is stored before the one of the right child
+	};
 
 	/// \brief From INameable: return the class name.
 	std::string name() const
 	{ return "RFClassifier"; }
 	
+	/// \brief Adds a new tree to the forest.
+	///
+	/// The forest needs to be compiled again before the compiled trees are used for evaluation.
+	void addModel(CARTree<LabelType> const& tree, double weight = 1.0){
+		base_type::addModel(tree, weight);
+		m_roots.clear();
+		m_nodes.clear();
+		m_leafValues.clear();
+	}
+	
+	/// \brief Removes all trees from the forest.
+	void clearModels(){
+		base_type::clearModels();
+		m_roots.clear();
+		m_nodes.clear();
+		m_leafValues.clear();
+	}
+	
+	/// \brief Packs the nodes of all trees into the layout used for evaluation.
+	///
+	/// Siblings are always stored next to each other, the ordering chooses
+	/// how the pairs of siblings of a tree are arranged.
+	void compile(NodeOrdering ordering = NodeOrdering::DepthFirst){
+		m_roots.clear();
+		m_nodes.clear();
+		m_leafValues.clear();
+		for(std::size_t t = 0; t != this->numberOfModels(); ++t){
+			CARTree<LabelType> const& tree = this->model(t);
+			SHARK_RUNTIME_CHECK(m_nodes.size() + tree.numberOfNodes() < leafNode, "Forest too large for compilation");
+			m_roots.push_back(m_nodes.size());
+			m_nodes.push_back(CompiledNode());
+			//pairs of (id in tree, index in m_nodes) of nodes whose content is not yet stored
+			std::deque<std::pair<std::size_t, std::size_t> > pending;
+			pending.push_back(std::make_pair(std::size_t(0), m_roots.back()));
+			while(!pending.empty()){
+				std::pair<std::size_t, std::size_t> next;
+				if(ordering == NodeOrdering::BreadthFirst){
+					next = pending.front();
+					pending.pop_front();
+				}else{
+					next = pending.back();
+					pending.pop_back();
+				}
+				auto const& node = tree.getNode(next.first);
+				CompiledNode& compiled = m_nodes[next.second];
+				if(node.leftId == 0){
+					compiled.threshold = 0.0;
+					compiled.feature = leafNode;
+					compiled.child = compileLeaf(tree.getLabel(next.first));
+				}else{
+					std::size_t left = m_nodes.size();
+					m_nodes.resize(left + 2);
+					//the reference is invalidated by resize
+					m_nodes[next.second].threshold = node.attributeValue;
+					m_nodes[next.second].feature = std::uint32_t(node.attributeIndex);
+					m_nodes[next.second].child = std::uint32_t(left);
+					//for depth first, the left child has to be processed first
+					pending.push_back(std::make_pair(node.rightIdOrIndex, left + 1));
+					pending.push_back(std::make_pair(node.leftId, left));
+					if(ordering == NodeOrdering::BreadthFirst)
+						std::swap(pending[pending.size() - 2], pending.back());
+				}
+			}
+		}
+	}
+	
+	/// \brief Returns true if the trees are compiled for evaluation.
+	bool isCompiled() const{
+		return !m_roots.empty() && m_roots.size() == this->numberOfModels();
+	}
+	
+	using base_type::eval;
+	/// \brief Evaluates the forest on a batch of patterns.
+	void eval(BatchInputType const& patterns, BatchOutputType& outputs)const{
+		if(!isCompiled()){
+			base_type::eval(patterns, outputs);
+			return;
+		}
+		RealMatrix pooled;
+		evalCompiled(patterns, pooled);
+		finalize(pooled, outputs);
+	}
+	void eval(BatchInputType const& patterns, BatchOutputType& outputs, State&)const{
+		eval(patterns, outputs);
+	}
+	
+	/// \brief Reads the forest from an archive and compiles it.
+	void read(InArchive& archive){
+		base_type::read(archive);
+		compile();
+	}
+	
 	
 	/// \brief Returns the computed out-of-bag-error of the forest
 	double OOBerror() const {
@@ -154,36 +376,57 @@ public:
 	}
 	
 	/// Compute oob error, given an oob dataset
+	///
+	/// The trees are evaluated on their out-of-bag samples in parallel.
 	void computeOOBerror(std::vector<std::vector<std::size_t> > const& oobIndices, LabeledData<RealVector, LabelType> const& data){
-		UIntMatrix oobMatrix(oobIndices.size(), data.numberOfElements(),0);
-		for(std::size_t i = 0; i != oobMatrix.size1(); ++i){
-			for(auto index: oobIndices[i])
-				oobMatrix(i,index) = 1;
-		}
-		m_OOBerror = this->doComputeOOBerror(oobMatrix,data);
+		DataView<LabeledData<RealVector, LabelType> const > view(data);
+		m_OOBerror = this->doComputeOOBerror(oobIndices, oobPredictions(oobIndices, view), data);
 	}
 
 	/// Compute feature importances, given an oob dataset
 	///
 	/// For each tree, extracts the out-of-bag-samples indicated by oobIndices. The feature importance is defined
 	/// as the average change of loss (Squared loss or accuracy depending on label type) when the feature is permuted across the oob samples of a tree.
+	///
+	/// The trees are processed in parallel. The loss of a tree on its unpermuted samples is computed once,
+	/// and permuting a feature on which the tree does not split can not change its predictions, therefore
+	/// the tree is only evaluated again for the features it uses. Every tree permutes with its own random
+	/// number generator seeded from rng, which makes the result independent of the number of threads.
 	void computeFeatureImportances(std::vector<std::vector<std::size_t> > const& oobIndices, LabeledData<RealVector, LabelType> const& data, random::rng_type& rng){
+		SHARK_RUNTIME_CHECK(oobIndices.size() == this->numberOfModels(), "Number of out-of-bag sets must match the number of trees");
 		std::size_t inputs = inputDimension(data);
-		m_featureImportances.resize(inputs);
+		std::size_t numTrees = this->numberOfModels();
 		DataView<LabeledData<RealVector, LabelType> const > view(data);
 		
-		for(std::size_t m = 0; m != this->numberOfModels();++m){
+		std::vector<std::mt19937::result_type> seeds(numTrees);
+		for(auto& seed: seeds)
+			seed = rng();
+		
+		//row m holds the weighted change of loss of tree m
+		RealMatrix importances(numTrees, inputs, 0.0);
+		auto permuteTree = [&](std::size_t m){
+			if(oobIndices[m].empty()) return;
+			std::mt19937 treeRng(seeds[m]);
 			auto batch = subBatch(view, oobIndices[m]);
 			double errorBefore = this->loss(batch.label,this->model(m)(batch.input));
+			UIntVector usedAttributes = this->model(m).countAttributes();
 			for(std::size_t i=0; i!=inputs;++i) {
+				if(usedAttributes(i) == 0) continue;
 				RealVector vOld= column(batch.input,i);
 				RealVector v = vOld;
-				std::shuffle(v.begin(), v.end(), rng);
+				std::shuffle(v.begin(), v.end(), treeRng);
 				noalias(column(batch.input,i)) = v;
 				double errorAfter = this->loss(batch.label,this->model(m)(batch.input));
 				noalias(column(batch.input,i)) = vOld;
-				m_featureImportances(i) += this->weight(m) * (errorAfter - errorBefore) / batch.size();
+				importances(m,i) = this->weight(m) * (errorAfter - errorBefore) / batch.size();
 			}
+		};
+		threading::parallelND({numTrees}, {1}, permuteTree, threading::globalThreadPool());
+		
+		m_featureImportances.resize(inputs);
+		m_featureImportances.clear();
+		for(std::size_t m = 0; m != numTrees; ++m){
+			noalias(m_featureImportances) += row(importances, m);
 		}
 		m_featureImportances /= this->sumOfWeights();
 	}
@@ -191,6 +434,10 @@ public:
 private:
 	double m_OOBerror; ///< oob error for the forest
 	RealVector m_featureImportances; ///< feature importances for the forest
+	
+	std::vector<std::size_t> m_roots; ///< index of the root of every compiled tree
+	std::vector<CompiledNode> m_nodes; ///< nodes of all compiled trees
+	std::vector<double> m_leafValues; ///< label values of the leaves of compiled regression trees
 
 };
 
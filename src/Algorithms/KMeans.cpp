@@ -34,65 +34,293 @@
 
 #define SHARK_COMPILE_DLL
 #include <shark/Algorithms/KMeans.h>
-#include <shark/Models/Clustering/HardClusteringModel.h>
-#include <shark/Data/DataView.h>
+#include <shark/Core/Threading/Algorithms.h>
 
-#include <boost/range/algorithm/equal.hpp>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 using namespace shark;
 
+namespace{
+
+/// Euclidean distance between two points given by arrays
+inline double distance(double const* x, double const* y, std::size_t dimension){
+	double ret = 0.0;
+	for(std::size_t d = 0; d != dimension; ++d){
+		double diff = x[d] - y[d];
+		ret += diff * diff;
+	}
+	return std::sqrt(ret);
+}
+
+/// \brief Accelerated Lloyd iterations.
+///
+/// Every point stores the index of its center, an upper bound on the distance to that
+/// center and lower bounds on the distances to the other centers. When the centers
+/// move, the bounds are loosened by the distances the centers moved. A distance
+/// is only computed when the triangle inequality cannot rule out that another
+/// center is closer. Hamerly's algorithm keeps a single lower bound for the closest
+/// of the other centers, Elkan's algorithm keeps one lower bound per center, which
+/// prunes more distance computations at the cost of n*k memory.
+///
+/// The points are split into chunks of consecutive batches which are processed in parallel.
+/// The chunks do not depend on the number of threads, therefore the results do not either.
+class KMeansIterations{
+public:
+	KMeansIterations(Data<RealVector> const& dataset, RealMatrix const& centers, bool elkan)
+	: m_dataset(dataset)
+	, m_centers(centers)
+	, m_elkan(elkan){
+		std::size_t k = centers.size1();
+		std::size_t numChunks = std::min<std::size_t>(dataset.size(), 32);
+		m_chunkStart.resize(numChunks + 1);
+		m_pointStart.resize(numChunks + 1, 0);
+		for(std::size_t c = 0; c != numChunks + 1; ++c)
+			m_chunkStart[c] = c * dataset.size() / numChunks;
+		for(std::size_t c = 0; c != numChunks; ++c){
+			m_pointStart[c + 1] = m_pointStart[c];
+			for(std::size_t b = m_chunkStart[c]; b != m_chunkStart[c + 1]; ++b)
+				m_pointStart[c + 1] += dataset[b].size1();
+		}
+		std::size_t n = m_pointStart.back();
+		m_assignment.resize(n);
+		m_upper.resize(n);
+		m_lower.resize(n, elkan ? k : 1);
+		m_movement = RealVector(k, 0.0);
+
+		//compute all distances to get the initial assignment and exact bounds
+		auto initChunk = [&](std::size_t c){
+			std::size_t i = m_pointStart[c];
+			RealVector dist(k);
+			for(std::size_t b = m_chunkStart[c]; b != m_chunkStart[c + 1]; ++b){
+				RealMatrix const& batch = m_dataset[b];
+				for(std::size_t p = 0; p != batch.size1(); ++p, ++i){
+					for(std::size_t j = 0; j != k; ++j)
+						dist(j) = distance(&batch(p, 0), &m_centers(j, 0), batch.size2());
+					std::size_t best = arg_min(dist);
+					m_assignment[i] = (unsigned int) best;
+					m_upper[i] = dist(best);
+					if(m_elkan){
+						noalias(row(m_lower, i)) = dist;
+					}else{
+						dist(best) = std::numeric_limits<double>::max();
+						m_lower(i, 0) = min(dist);
+					}
+				}
+			}
+		};
+		threading::parallelND({numChunks}, {1}, initChunk, threading::globalThreadPool());
+	}
+
+	/// \brief Computes the means of the clusters. Clusters without points are reseeded with random points.
+	RealMatrix means() const{
+		std::size_t k = m_centers.size1();
+		std::size_t dim = m_centers.size2();
+		std::size_t numChunks = m_chunkStart.size() - 1;
+
+		//every chunk sums its points separately, the sums are reduced in order
+		std::vector<RealMatrix> sums(numChunks, RealMatrix(k, dim, 0.0));
+		std::vector<std::vector<std::size_t> > counts(numChunks, std::vector<std::size_t>(k, 0));
+		auto sumChunk = [&](std::size_t c){
+			std::size_t i = m_pointStart[c];
+			for(std::size_t b = m_chunkStart[c]; b != m_chunkStart[c + 1]; ++b){
+				RealMatrix const& batch = m_dataset[b];
+				for(std::size_t p = 0; p != batch.size1(); ++p, ++i){
+					std::size_t j = m_assignment[i];
+					noalias(row(sums[c], j)) += row(batch, p);
+					++counts[c][j];
+				}
+			}
+		};
+		threading::parallelND({numChunks}, {1}, sumChunk, threading::globalThreadPool());
+
+		RealMatrix centers(k, dim, 0.0);
+		std::vector<std::size_t> numPoints(k, 0);
+		for(std::size_t c = 0; c != numChunks; ++c){
+			noalias(centers) += sums[c];
+			for(std::size_t j = 0; j != k; ++j)
+				numPoints[j] += counts[c][j];
+		}
+		auto data = elements(m_dataset);
+		for(std::size_t j = 0; j != k; ++j){
+			if(numPoints[j] == 0){
+				// empty cluster - assign random training point
+				std::size_t index = random::discrete(random::globalRng(), std::size_t(0), data.size() - 1);
+				noalias(row(centers, j)) = data[index];
+			}else{
+				row(centers, j) /= (double)numPoints[j];
+			}
+		}
+		return centers;
+	}
+
+	/// \brief Moves the centers and reassigns the points. Returns the number of points that changed their cluster.
+	std::size_t update(RealMatrix const& newCenters){
+		std::size_t k = m_centers.size1();
+		for(std::size_t j = 0; j != k; ++j)
+			m_movement(j) = distance(&newCenters(j, 0), &m_centers(j, 0), m_centers.size2());
+		noalias(m_centers) = newCenters;
+
+		//half the distance of every center to the closest other center. Points closer to their center
+		//than this can not be closer to any other center.
+		RealMatrix centerDistances(k, k, 0.0);
+		RealVector separation(k, std::numeric_limits<double>::max());
+		for(std::size_t j = 0; j != k; ++j){
+			for(std::size_t l = 0; l != j; ++l){
+				double dist = 0.5 * distance(&m_centers(j, 0), &m_centers(l, 0), m_centers.size2());
+				centerDistances(j, l) = centerDistances(l, j) = dist;
+				separation(j) = std::min(separation(j), dist);
+				separation(l) = std::min(separation(l), dist);
+			}
+		}
+
+		std::size_t numChunks = m_chunkStart.size() - 1;
+		std::vector<std::size_t> changes(numChunks, 0);
+		auto updateChunk = [&](std::size_t c){
+			if(m_elkan)
+				changes[c] = updateElkan(c, centerDistances, separation);
+			else
+				changes[c] = updateHamerly(c, separation);
+		};
+		threading::parallelND({numChunks}, {1}, updateChunk, threading::globalThreadPool());
+		std::size_t numChanges = 0;
+		for(std::size_t c = 0; c != numChunks; ++c)
+			numChanges += changes[c];
+		return numChanges;
+	}
+
+	RealMatrix const& centers() const{
+		return m_centers;
+	}
+
+private:
+	std::size_t updateHamerly(std::size_t c, RealVector const& separation){
+		std::size_t k = m_centers.size1();
+		std::size_t dim = m_centers.size2();
+		//the lower bound holds for all other centers, thus it is loosened by the largest movement among them
+		std::size_t fastest = arg_max(m_movement);
+		double maxMovement = m_movement(fastest);
+		double secondMovement = 0.0;
+		for(std::size_t j = 0; j != k; ++j){
+			if(j != fastest) secondMovement = std::max(secondMovement, m_movement(j));
+		}
+
+		std::size_t numChanges = 0;
+		std::size_t i = m_pointStart[c];
+		for(std::size_t b = m_chunkStart[c]; b != m_chunkStart[c + 1]; ++b){
+			RealMatrix const& batch = m_dataset[b];
+			for(std::size_t p = 0; p != batch.size1(); ++p, ++i){
+				std::size_t a = m_assignment[i];
+				m_upper[i] += m_movement(a);
+				m_lower(i, 0) -= (a == fastest) ? secondMovement : maxMovement;
+
+				double bound = std::max(separation(a), m_lower(i, 0));
+				if(m_upper[i] <= bound) continue;
+				double const* x = &batch(p, 0);
+				m_upper[i] = distance(x, &m_centers(a, 0), dim);
+				if(m_upper[i] <= bound) continue;
+
+				//the bounds failed, find the two closest centers
+				double best = std::numeric_limits<double>::max();
+				double second = std::numeric_limits<double>::max();
+				std::size_t bestIndex = a;
+				for(std::size_t j = 0; j != k; ++j){
+					double dist = (j == a) ? m_upper[i] : distance(x, &m_centers(j, 0), dim);
+					if(dist < best){
+						second = best;
+						best = dist;
+						bestIndex = j;
+					}else if(dist < second){
+						second = dist;
+					}
+				}
+				if(bestIndex != a){
+					m_assignment[i] = (unsigned int) bestIndex;
+					++numChanges;
+				}
+				m_upper[i] = best;
+				m_lower(i, 0) = second;
+			}
+		}
+		return numChanges;
+	}
+
+	std::size_t updateElkan(std::size_t c, RealMatrix const& centerDistances, RealVector const& separation){
+		std::size_t k = m_centers.size1();
+		std::size_t dim = m_centers.size2();
+		std::size_t numChanges = 0;
+		std::size_t i = m_pointStart[c];
+		for(std::size_t b = m_chunkStart[c]; b != m_chunkStart[c + 1]; ++b){
+			RealMatrix const& batch = m_dataset[b];
+			for(std::size_t p = 0; p != batch.size1(); ++p, ++i){
+				std::size_t a = m_assignment[i];
+				double* lower = &m_lower(i, 0);
+				for(std::size_t j = 0; j != k; ++j)
+					lower[j] = std::max(lower[j] - m_movement(j), 0.0);
+				m_upper[i] += m_movement(a);
+				if(m_upper[i] <= separation(a)) continue;
+
+				double const* x = &batch(p, 0);
+				bool tight = false;
+				for(std::size_t j = 0; j != k; ++j){
+					if(j == a || m_upper[i] <= lower[j] || m_upper[i] <= centerDistances(a, j)) continue;
+					if(!tight){
+						m_upper[i] = lower[a] = distance(x, &m_centers(a, 0), dim);
+						tight = true;
+						if(m_upper[i] <= lower[j] || m_upper[i] <= centerDistances(a, j)) continue;
+					}
+					double dist = lower[j] = distance(x, &m_centers(j, 0), dim);
+					if(dist < m_upper[i]){
+						a = j;
+						m_upper[i] = dist;
+					}
+				}
+				if(a != m_assignment[i]){
+					m_assignment[i] = (unsigned int) a;
+					++numChanges;
+				}
+			}
+		}
+		return numChanges;
+	}
+
+	Data<RealVector> const& m_dataset;
+	RealMatrix m_centers;
+	bool m_elkan;
+	std::vector<std::size_t> m_chunkStart;///< first batch of every chunk, plus the end
+	std::vector<std::size_t> m_pointStart;///< index of the first point of every chunk, plus the end
+	std::vector<unsigned int> m_assignment;///< index of the center of every point
+	std::vector<double> m_upper;///< upper bound on the distance of every point to its center
+	RealMatrix m_lower;///< lower bounds on the distances to the other centers, one row per point
+	RealVector m_movement;///< distance the centers moved in the last update
+};
+
+}
 
 std::size_t shark::kMeans(Data<RealVector> const& dataset, std::size_t k, Centroids& centroids, std::size_t maxIterations){
 	SIZE_CHECK(k <= dataset.numberOfElements());
 	if(!maxIterations)
 		maxIterations = std::numeric_limits<std::size_t>::max();
-	
-	// initialization
-	auto data = elements(dataset);
-	std::size_t ell = data.size();
-	std::size_t dimension = dataDimension(data);
-	
+
 	//if the centers are not already initialized, do it now
 	if (centroids.numberOfClusters() != k){
 		centroids.initFromData(dataset,k);
 	}
-	HardClusteringModel<RealVector> model(&centroids);
-	auto clusterMembership = createLabeledData(dataset,model(dataset));
+	//Elkan's bounds pay off for many clusters as long as they fit in memory
+	std::size_t n = dataset.numberOfElements();
+	bool elkan = k >= 20 && n * k <= (std::size_t(1) << 24);
+	KMeansIterations lloyd(dataset, createBatch<RealVector>(elements(centroids.centroids())), elkan);
 
-	// k-means loop
+	// k-means loop: compute new centers and reassign the points until no point changes its cluster
 	std::size_t iter = 0;
 	bool equal = false;
 	for(; iter != maxIterations && !equal; ++iter) {
-		// compute new centers
-		std::vector<std::size_t> numPoints(k,0); // number of points in each cluster
-		std::vector<RealVector> newCenters(k,RealVector(dimension,0.0));
-			
-		for(auto element: elements(clusterMembership)){
-			std::size_t j = element.label;
-			noalias(newCenters[j]) += element.input;
-			numPoints[j]++;
-		}
-		for (std::size_t j=0; j<k; j++) {
-			if (numPoints[j] == 0) {
-				// empty cluster - assign random training point
-				std::size_t index = random::discrete(random::globalRng(), std::size_t(0), ell-1);
-				newCenters[j] = data[index];
-			}
-			else {
-				newCenters[j] /= (double)numPoints[j];
-			}
-		}
-		centroids.setCentroids(createDataFromRange(newCenters));
-		
-		//compute new cluster memberships and check whether they are 
-		// equal to the old one, in that case we stop after this iteration
-		Data<unsigned int> newClusterMembership = model(dataset);
-		equal = boost::equal(
-			elements(newClusterMembership),
-			elements(clusterMembership.labels())
-		);
-		clusterMembership.labels() = newClusterMembership;
+		equal = lloyd.update(lloyd.means()) == 0;
 	}
+	std::vector<RealVector> centers(lloyd.centers().size1());
+	for(std::size_t j = 0; j != centers.size(); ++j)
+		centers[j] = row(lloyd.centers(), j);
+	centroids.setCentroids(createDataFromRange(centers));
 
 	// return the number of iterations
 	return iter;
@@ -105,3 +333,69 @@ std::size_t shark::kMeans(Data<RealVector> const& data, RBFLayer& model, std::si
 	model.centers() = createBatch<RealVector>(elements(centroids.centroids()));
 	return iter;
 }
+
+std::size_t shark::kMeans(Generator<RealVector> const& generator, std::size_t k, Centroids& centroids, std::size_t numBatches){
+	//if the centers are not already initialized, seed them on the first batches
+	if (centroids.numberOfClusters() != k){
+		Data<RealVector> initialData;
+		std::size_t numInitialPoints = 0;
+		while(numInitialPoints < k){
+			RealMatrix batch = generator();
+			SHARK_RUNTIME_CHECK(batch.size1() > 0, "The generator returned an empty batch");
+			numInitialPoints += batch.size1();
+			initialData.push_back(batch);
+		}
+		centroids.initFromData(initialData, k);
+	}
+	RealMatrix centers = createBatch<RealVector>(elements(centroids.centroids()));
+	std::vector<std::size_t> counts(k, 0);//number of points assigned to every center so far
+
+	std::size_t numPoints = 0;
+	std::size_t const blockSize = 64;
+	std::vector<std::size_t> assignment;
+	for(std::size_t t = 0; t != numBatches; ++t){
+		RealMatrix batch = generator();
+		std::size_t batchSize = batch.size1();
+		SIZE_CHECK(batchSize == 0 || batch.size2() == centers.size2());
+
+		//assign the points to the closest centers in parallel blocks of rows
+		assignment.resize(batchSize);
+		auto assignBlock = [&](std::size_t b){
+			std::size_t start = b * blockSize;
+			std::size_t end = std::min(start + blockSize, batchSize);
+			RealMatrix dist = distanceSqr(rows(batch, start, end), centers);
+			for(std::size_t i = 0; i != end - start; ++i)
+				assignment[start + i] = arg_min(row(dist, i));
+		};
+		std::size_t numBlocks = (batchSize + blockSize - 1) / blockSize;
+		threading::parallelND({numBlocks}, {1}, assignBlock, threading::globalThreadPool());
+
+		//moving the centers towards the points with learning rate 1/count keeps every center
+		//at the mean of all points assigned to it so far, thus a batch can be added at once
+		RealMatrix sums(k, centers.size2(), 0.0);
+		std::vector<std::size_t> batchCounts(k, 0);
+		for(std::size_t i = 0; i != batchSize; ++i){
+			noalias(row(sums, assignment[i])) += row(batch, i);
+			++batchCounts[assignment[i]];
+		}
+		for(std::size_t j = 0; j != k; ++j){
+			if(batchCounts[j] == 0) continue;
+			counts[j] += batchCounts[j];
+			noalias(row(centers, j)) += (row(sums, j) - batchCounts[j] * row(centers, j)) / double(counts[j]);
+		}
+		numPoints += batchSize;
+	}
+
+	std::vector<RealVector> result(k);
+	for(std::size_t j = 0; j != k; ++j)
+		result[j] = row(centers, j);
+	centroids.setCentroids(createDataFromRange(result));
+	return numPoints;
+}
+
+std::size_t shark::kMeans(Generator<RealVector> const& generator, RBFLayer& model, std::size_t numBatches){
+	Centroids centroids;
+	std::size_t numPoints = kMeans(generator, model.outputShape().numElements(), centroids, numBatches);
+	model.centers() = createBatch<RealVector>(elements(centroids.centroids()));
+	return numPoints;
+}
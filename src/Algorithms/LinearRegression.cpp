@@ -41,7 +41,10 @@ LinearRegression::LinearRegression(double regularization){
 	setRegularization(regularization);
 }
 
-void LinearRegression::train(LinearModel<>& model, LabeledData<RealVector, RealVector> const& dataset){
+namespace{
+//solves the regression problem batchwise for LabeledData and ContiguousLabeledData
+template<class DatasetType>
+void trainLinearRegression(LinearModel<>& model, DatasetType const& dataset, double regularization){
 	std::size_t inputDim = inputDimension(dataset);
 	std::size_t outputDim = labelDimension(dataset);
 	std::size_t numBatches = dataset.size();
@@ -54,17 +57,17 @@ void LinearRegression::train(LinearModel<>& model, LabeledData<RealVector, RealV
 	RealMatrix matA(inputDim+1,inputDim+1,0.0);
 	//compute A and the label matrix batchwise
 	for (std::size_t b=0; b != numBatches; b++){
-		auto const& input = dataset[b].input;
-		noalias(matA) += prod(trans(input|1),input|1);
+		auto batch = dataset[b];
+		noalias(matA) += prod(trans(batch.input|1),batch.input|1);
 	}
 	//X^TX+=lambda* I
-	subrange(diag(matA),0,inputDim) += m_regularization;
+	subrange(diag(matA),0,inputDim) += regularization;
 	
 	
 	//we also need to compute X^T L= (P^TL, 1^T L) where L is the matrix of labels 
 	RealMatrix XTL(inputDim + 1,outputDim,0.0);
 	for (std::size_t b=0; b != numBatches; b++){
-		auto const& batch = dataset[b];
+		auto batch = dataset[b];
 		noalias(XTL) += prod(trans(batch.input | 1),batch.label);
 	}	
 	
@@ -81,3 +84,12 @@ void LinearRegression::train(LinearModel<>& model, LabeledData<RealVector, RealV
 	// write parameters into the model
 	model.setStructure(matrix, offset);
 }
+}
+
+void LinearRegression::train(LinearModel<>& model, LabeledData<RealVector, RealVector> const& dataset){
+	trainLinearRegression(model, dataset, m_regularization);
+}
+
+void LinearRegression::train(LinearModel<>& model, ContiguousLabeledData<RealVector, RealVector> const& dataset){
+	trainLinearRegression(model, dataset, m_regularization);
+}
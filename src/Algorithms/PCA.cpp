@@ -66,27 +66,28 @@ void PCA::setData(Data<RealVector> const& inputs) {
 		//so if X0^T = (B0^T,B1^T)
 		//than S = B0 B0^T B0 B1^T
 		//               B1 B0^T  B1 B1^T
-		std::size_t start1 = 0;
-		for(std::size_t b1 = 0; b1 != inputs.size(); ++b1){
+		//the blocks of row b1 are computed in parallel, they do not overlap between different b1
+		detail::BatchPartition partition(inputs.getPartitioning());
+		auto computeRow = [&](std::size_t b1){
+			std::size_t start1 = partition.batchStart(b1);
 			std::size_t batchSize1 = inputs[b1].size1();
 			RealMatrix X1 = inputs[b1]-repeat(m_mean,batchSize1);
-			std::size_t start2 = 0;
 			//calculate off-diagonal blocks
 			//and the block X2 X1^T is the transpose of X1X2^T and thus can bee calculated for free.
 			for(std::size_t b2 = 0; b2 != b1; ++b2){
+				std::size_t start2 = partition.batchStart(b2);
 				std::size_t batchSize2 = inputs[b2].size1();
 				RealMatrix X2 = inputs[b2]-repeat(m_mean,batchSize2);
 				auto X1X2T= subrange(S,start1,start1+batchSize1,start2,start2+batchSize2);
 				auto X2X1T= subrange(S,start2,start2+batchSize2,start1,start1+batchSize1);
 				noalias(X1X2T) = prod(X1,trans(X2));// X1 X2^T
 				noalias(X2X1T) = trans(X1X2T);// X2 X1^T
-				start2+=batchSize2;
 			}
 			//diagonal block
 			auto X1X1T= subrange(S,start1,start1+batchSize1,start1,start1+batchSize1);
 			noalias(X1X1T) = prod(X1,trans(X1));
-			start1+=batchSize1;
-		}
+		};
+		threading::parallelND({inputs.size()}, {1}, computeRow, threading::globalThreadPool());
 		S /= m_l;
 		
 		blas::symm_eigenvalue_decomposition<RealMatrix> eigen(S);
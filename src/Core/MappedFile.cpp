@@ -0,0 +1,76 @@
+/*!
+ * 
+ *
+ * \brief       Read-only access to the contents of a file by memory mapping
+ * 
+ * 
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ * 
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ * 
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published 
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#define SHARK_COMPILE_DLL
+#include <shark/Core/MappedFile.h>
+#include <shark/Core/Exception.h>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace shark;
+
+struct MappedFile::Impl{
+	boost::iostreams::mapped_file_source m_mapping;
+	std::vector<char> m_buffer;//contents of files that can not be mapped
+	char const* m_begin;
+	char const* m_end;
+
+	Impl(std::string const& path){
+		boost::system::error_code error;
+		bool regular = boost::filesystem::is_regular_file(path, error);
+		if(regular && boost::filesystem::file_size(path, error) > 0){
+			m_mapping.open(path);
+			SHARK_RUNTIME_CHECK(m_mapping.is_open(), "File cannot be opened for reading.");
+			m_begin = m_mapping.data();
+			m_end = m_begin + m_mapping.size();
+			return;
+		}
+		//empty files can not be mapped and other files might not support it
+		std::ifstream stream(path.c_str(), std::ios::binary);
+		SHARK_RUNTIME_CHECK(stream, "File cannot be opened for reading.");
+		m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		m_begin = m_buffer.data();
+		m_end = m_begin + m_buffer.size();
+	}
+};
+
+MappedFile::MappedFile(std::string const& path):m_impl(new Impl(path)){}
+MappedFile::~MappedFile(){}
+
+char const* MappedFile::begin() const{
+	return m_impl->m_begin;
+}
+char const* MappedFile::end() const{
+	return m_impl->m_end;
+}
@@ -32,11 +32,13 @@
 
 #include <shark/Core/ZipSupport.h>
 #include <shark/Core/Exception.h>
+#include <limits>
 #include <mutex>
 #include <unordered_map>
 
 extern "C"{
 #include <zip.h>
+#include <zlib.h>
 }
 using namespace shark;
 
@@ -47,6 +49,9 @@ struct ZipReader::ZipImpl{
 		std::string name;
 		std::size_t size;
 		zip_uint64_t index;
+		std::size_t compressedSize;
+		bool deflated;///< true if the file is compressed with deflate and can be inflated without libzip
+		zip_uint32_t crc;
 	};
 	std::vector<Info> m_fileList;
 	std::unordered_map<std::string, std::size_t> m_nameLookup;
@@ -71,7 +76,13 @@ struct ZipReader::ZipImpl{
 			}
 			std::string fileName = stat.name;
 			if(fileName.back() != '/'){
-				m_fileList.push_back({fileName, stat.size, i});
+				zip_uint64_t required = ZIP_STAT_COMP_SIZE | ZIP_STAT_COMP_METHOD | ZIP_STAT_CRC | ZIP_STAT_ENCRYPTION_METHOD;
+				bool deflated = (stat.valid & required) == required
+					&& stat.comp_method == ZIP_CM_DEFLATE
+					&& stat.encryption_method == ZIP_EM_NONE
+					&& stat.comp_size <= std::numeric_limits<uInt>::max()
+					&& stat.size <= std::numeric_limits<uInt>::max();
+				m_fileList.push_back({fileName, stat.size, i, stat.comp_size, deflated, stat.crc});
 				m_nameLookup.emplace(fileName, m_fileList.size() -1);
 			}
 		}
@@ -87,17 +98,27 @@ struct ZipReader::ZipImpl{
 	}
 	
 	std::vector<unsigned char> readFile(Info const& info) const{
+		if(!info.deflated || info.size == 0)
+			return readEntry(info, info.size, ZIP_FL_UNCHANGED);
+		//only the compressed bytes are read while holding the lock. They are inflated afterwards,
+		//such that several threads can decompress files at the same time
+		std::vector<unsigned char> compressed = readEntry(info, info.compressedSize, ZIP_FL_COMPRESSED | ZIP_FL_UNCHANGED);
+		return inflateEntry(compressed, info);
+	}
+	
+	/// \brief Reads the contents of a file, either decompressed by libzip or the raw compressed bytes.
+	std::vector<unsigned char> readEntry(Info const& info, std::size_t size, zip_flags_t flags) const{
 		//lock for thread-safety
 		std::lock_guard<std::mutex> lock(m_mutex);
 		
 		//open file for reading
-		zip_file_t* file = zip_fopen_index(m_archive, info.index, ZIP_FL_UNCHANGED);
+		zip_file_t* file = zip_fopen_index(m_archive, info.index, flags);
 		if(file == nullptr){
 			handleError();
 		}
 
 		//read file contents chunk by chunk
-		std::vector<unsigned char> buffer(info.size);
+		std::vector<unsigned char> buffer(size);
 		unsigned char* pos = buffer.data();
 		unsigned char* end = pos + buffer.size();
 		while(pos != end){
@@ -107,11 +128,37 @@ struct ZipReader::ZipImpl{
 				zip_fclose(file);
 				throw SHARKEXCEPTION(message);
 			}
+			if(len == 0){
+				zip_fclose(file);
+				throw SHARKEXCEPTION("Error reading from zip-archive. File is truncated: " + info.name);
+			}
 			pos += len;
 		}
 		zip_fclose(file);
 		return buffer;
 	}
+	
+	/// \brief Decompresses a raw deflate stream and checks the checksum of the result.
+	static std::vector<unsigned char> inflateEntry(std::vector<unsigned char>& compressed, Info const& info){
+		std::vector<unsigned char> buffer(info.size);
+		z_stream stream;
+		stream.zalloc = Z_NULL;
+		stream.zfree = Z_NULL;
+		stream.opaque = Z_NULL;
+		stream.next_in = compressed.data();
+		stream.avail_in = static_cast<uInt>(compressed.size());
+		//negative window bits: raw deflate stream without zlib header
+		if(inflateInit2(&stream, -MAX_WBITS) != Z_OK){
+			throw SHARKEXCEPTION("Error initializing zlib for reading zip-archive");
+		}
+		stream.next_out = buffer.data();
+		stream.avail_out = static_cast<uInt>(buffer.size());
+		int status = inflate(&stream, Z_FINISH);
+		inflateEnd(&stream);
+		SHARK_RUNTIME_CHECK(status == Z_STREAM_END && stream.total_out == info.size, "Error decompressing file in zip-archive: " + info.name);
+		SHARK_RUNTIME_CHECK(crc32(0, buffer.data(), static_cast<uInt>(buffer.size())) == info.crc, "Checksum error in zip-archive: " + info.name);
+		return buffer;
+	}
 };
 
 ZipReader::ZipReader(std::string const& pathToArchive):m_impl(new ZipImpl(pathToArchive)){}
@@ -0,0 +1,398 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Reading and writing of the binary data format
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#define SHARK_COMPILE_DLL
+#include <shark/Data/BinaryData.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+using namespace shark;
+
+namespace {
+
+char const magic[8] = {'S','H','A','R','K','D','A','T'};
+std::uint32_t const formatVersion = 1;
+std::uint32_t const byteOrderMark = 0x01020304;
+std::uint64_t const payloadAlignment = 64;
+
+/// \brief Fixed part of the header, followed by the dimensions of the input and label shapes and the batch table.
+struct FileHeader{
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t byteOrder;
+	std::uint32_t inputFormat;
+	std::uint32_t labelFormat;
+	std::uint64_t numberOfElements;
+	std::uint64_t numberOfBatches;
+	std::uint64_t inputRank;
+	std::uint64_t labelRank;
+};
+
+/// \brief Entry of the batch table, same layout as BinaryDataFile::BatchEntry.
+struct BatchEntry{
+	std::uint64_t size;
+	std::uint64_t nonzeros;
+	std::uint64_t inputOffset;
+	std::uint64_t labelOffset;
+};
+
+std::uint64_t align(std::uint64_t offset){
+	return (offset + payloadAlignment - 1) / payloadAlignment * payloadAlignment;
+}
+
+//format and size of the payloads of the different batch types.
+//The formats are chosen by the batch type, so empty datasets are stored in the format of their type.
+
+BinaryDataFile::InputFormat inputFormat(RealMatrix const*){
+	return BinaryDataFile::DenseInputs;
+}
+BinaryDataFile::InputFormat inputFormat(CompressedRealMatrix const*){
+	return BinaryDataFile::SparseInputs;
+}
+BinaryDataFile::LabelFormat labelFormat(UIntVector const*){
+	return BinaryDataFile::ClassLabels;
+}
+BinaryDataFile::LabelFormat labelFormat(RealMatrix const*){
+	return BinaryDataFile::DenseLabels;
+}
+
+std::uint64_t nonzeros(RealMatrix const&){
+	return 0;
+}
+std::uint64_t nonzeros(CompressedRealMatrix const& batch){
+	std::uint64_t nnz = 0;
+	for(std::size_t i = 0; i != batch.size1(); ++i)
+		nnz += batch.major_nnz(i);
+	return nnz;
+}
+
+std::uint64_t payloadBytes(RealMatrix const& batch){
+	return batch.size1() * batch.size2() * sizeof(double);
+}
+std::uint64_t payloadBytes(CompressedRealMatrix const& batch){
+	std::uint64_t nnz = nonzeros(batch);
+	return (batch.size1() + 1 + nnz) * sizeof(std::uint64_t) + nnz * sizeof(double);
+}
+std::uint64_t payloadBytes(UIntVector const& batch){
+	return batch.size() * sizeof(std::uint32_t);
+}
+
+void writePayload(std::ostream& stream, RealMatrix const& batch){
+	for(std::size_t i = 0; i != batch.size1(); ++i)
+		stream.write(reinterpret_cast<char const*>(&batch(i, 0)), batch.size2() * sizeof(double));
+}
+void writePayload(std::ostream& stream, CompressedRealMatrix const& batch){
+	auto storage = batch.raw_storage();
+	std::vector<std::uint64_t> offsets(batch.size1() + 1, 0);
+	for(std::size_t i = 0; i != batch.size1(); ++i)
+		offsets[i + 1] = offsets[i] + batch.major_nnz(i);
+	std::vector<std::uint64_t> indices;
+	std::vector<double> values;
+	indices.reserve(offsets.back());
+	values.reserve(offsets.back());
+	for(std::size_t i = 0; i != batch.size1(); ++i){
+		for(std::size_t pos = storage.major_indices_begin[i]; pos != storage.major_indices_end[i]; ++pos){
+			indices.push_back(storage.indices[pos]);
+			values.push_back(storage.values[pos]);
+		}
+	}
+	stream.write(reinterpret_cast<char const*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+	stream.write(reinterpret_cast<char const*>(indices.data()), indices.size() * sizeof(std::uint64_t));
+	stream.write(reinterpret_cast<char const*>(values.data()), values.size() * sizeof(double));
+}
+void writePayload(std::ostream& stream, UIntVector const& batch){
+	for(std::size_t i = 0; i != batch.size(); ++i){
+		std::uint32_t label = batch(i);
+		stream.write(reinterpret_cast<char const*>(&label), sizeof(label));
+	}
+}
+
+void writeShape(std::ostream& stream, Shape const& shape){
+	for(std::size_t i = 0; i != shape.size(); ++i){
+		std::uint64_t dim = shape[i];
+		stream.write(reinterpret_cast<char const*>(&dim), sizeof(dim));
+	}
+}
+
+void pad(std::ostream& stream, std::uint64_t& position, std::uint64_t target){
+	static char const zeros[payloadAlignment] = {};
+	stream.write(zeros, target - position);
+	position = target;
+}
+
+/// \brief Writes the inputs and, if labels is not NULL, the labels into the file.
+template<class InputType, class LabelType>
+void writeBinaryData(Data<InputType> const& inputs, Data<LabelType> const* labels, std::string const& fn){
+	typedef typename Batch<InputType>::type InputBatch;
+	typedef typename Batch<LabelType>::type LabelBatch;
+	FileHeader header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = formatVersion;
+	header.byteOrder = byteOrderMark;
+	header.inputFormat = inputFormat(static_cast<InputBatch const*>(nullptr));
+	header.labelFormat = labels ? labelFormat(static_cast<LabelBatch const*>(nullptr)) : BinaryDataFile::NoLabels;
+	header.numberOfElements = inputs.numberOfElements();
+	header.numberOfBatches = inputs.size();
+	header.inputRank = inputs.shape().size();
+	header.labelRank = labels ? labels->shape().size() : 0;
+
+	//compute the position of every payload
+	std::vector<BatchEntry> table(inputs.size());
+	std::uint64_t position = sizeof(FileHeader) + (header.inputRank + header.labelRank + 4 * table.size()) * sizeof(std::uint64_t);
+	for(std::size_t b = 0; b != inputs.size(); ++b){
+		table[b].size = batchSize(inputs[b]);
+		table[b].nonzeros = nonzeros(inputs[b]);
+		table[b].inputOffset = align(position);
+		position = table[b].inputOffset + payloadBytes(inputs[b]);
+		table[b].labelOffset = 0;
+		if(labels){
+			SHARK_RUNTIME_CHECK(batchSize((*labels)[b]) == table[b].size, "batch sizes of inputs and labels must agree");
+			table[b].labelOffset = align(position);
+			position = table[b].labelOffset + payloadBytes((*labels)[b]);
+		}
+	}
+
+	std::ofstream stream(fn.c_str(), std::ios::binary);
+	SHARK_RUNTIME_CHECK(stream, "File can not be opened for writing");
+	stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+	writeShape(stream, inputs.shape());
+	if(labels)
+		writeShape(stream, labels->shape());
+	stream.write(reinterpret_cast<char const*>(table.data()), table.size() * sizeof(BatchEntry));
+	position = sizeof(FileHeader) + (header.inputRank + header.labelRank + 4 * table.size()) * sizeof(std::uint64_t);
+	for(std::size_t b = 0; b != inputs.size(); ++b){
+		pad(stream, position, table[b].inputOffset);
+		writePayload(stream, inputs[b]);
+		position += payloadBytes(inputs[b]);
+		if(labels){
+			pad(stream, position, table[b].labelOffset);
+			writePayload(stream, (*labels)[b]);
+			position += payloadBytes((*labels)[b]);
+		}
+	}
+	SHARK_RUNTIME_CHECK(stream, "Failed to write file");
+}
+
+//copying batches from the file into datasets
+
+std::vector<std::size_t> partitioning(BinaryDataFile const& file){
+	std::vector<std::size_t> sizes(file.numberOfBatches());
+	for(std::size_t b = 0; b != sizes.size(); ++b)
+		sizes[b] = file.batchSize(b);
+	return sizes;
+}
+
+void copyInputs(BinaryDataFile const& file, std::size_t b, RealMatrix& batch){
+	noalias(batch) = file.denseInputs(b);
+}
+//the sparse storage was validated when opening the file
+void copyInputs(BinaryDataFile const& file, std::size_t b, CompressedRealMatrix& batch){
+	BinaryDataFile::SparseBatch storage = file.sparseInputs(b);
+	batch.reserve(file.nonzeros(b));
+	for(std::size_t i = 0; i != batch.size1(); ++i){
+		std::uint64_t begin = storage.major_indices_begin[i];
+		std::uint64_t end = storage.major_indices_end[i];
+		batch.major_reserve(i, end - begin);
+		auto pos = batch.major_end(i);
+		for(std::uint64_t k = begin; k != end; ++k){
+			pos = batch.set_element(pos, storage.indices[k], storage.values[k]);
+		}
+	}
+}
+void copyLabels(BinaryDataFile const& file, std::size_t b, UIntVector& batch){
+	noalias(batch) = file.classLabels(b);
+}
+void copyLabels(BinaryDataFile const& file, std::size_t b, RealMatrix& batch){
+	noalias(batch) = file.denseLabels(b);
+}
+
+void checkFormat(BinaryDataFile const& file, BinaryDataFile::InputFormat input, BinaryDataFile::LabelFormat label){
+	SHARK_RUNTIME_CHECK(file.inputFormat() == input, "The format of the inputs in the file does not match the dataset");
+	SHARK_RUNTIME_CHECK(file.labelFormat() == label, "The format of the labels in the file does not match the dataset");
+}
+
+/// \brief Calls f(b) for all batches of the file in parallel.
+///
+/// Exceptions are lost in the thread pool, therefore they are rethrown afterwards.
+template<class Functor>
+void parallelForBatches(BinaryDataFile const& file, Functor f){
+	std::size_t numBatches = file.numberOfBatches();
+	if(numBatches == 0) return;
+	std::vector<std::exception_ptr> errors(numBatches);
+	threading::parallelND({numBatches}, {1}, [&](std::size_t b){
+		try{
+			f(b);
+		}catch(...){
+			errors[b] = std::current_exception();
+		}
+	}, threading::globalThreadPool());
+	for(std::size_t b = 0; b != numBatches; ++b){
+		if(errors[b]) std::rethrow_exception(errors[b]);
+	}
+}
+
+template<class InputType>
+void readBinaryData(Data<InputType>& data, std::string const& fn){
+	BinaryDataFile file(fn);
+	checkFormat(file, inputFormat(static_cast<typename Batch<InputType>::type const*>(nullptr)), BinaryDataFile::NoLabels);
+	data = Data<InputType>(partitioning(file), file.inputShape());
+	parallelForBatches(file, [&](std::size_t b){
+		copyInputs(file, b, data[b]);
+	});
+}
+
+template<class InputType, class LabelType>
+void readBinaryData(LabeledData<InputType, LabelType>& data, std::string const& fn){
+	typedef typename Batch<LabelType>::type LabelBatch;
+	BinaryDataFile file(fn);
+	checkFormat(file, inputFormat(static_cast<typename Batch<InputType>::type const*>(nullptr)), labelFormat(static_cast<LabelBatch const*>(nullptr)));
+	data = LabeledData<InputType, LabelType>(partitioning(file), {file.inputShape(), file.labelShape()});
+	parallelForBatches(file, [&](std::size_t b){
+		copyInputs(file, b, data.inputs()[b]);
+		copyLabels(file, b, data.labels()[b]);
+	});
+}
+
+}
+
+BinaryDataFile::BinaryDataFile(std::string const& fn):m_file(fn){
+	char const* begin = m_file.begin();
+	std::uint64_t size = m_file.size();
+	FileHeader header;
+	SHARK_RUNTIME_CHECK(size >= sizeof(header), "File is not in the binary data format");
+	std::memcpy(&header, begin, sizeof(header));
+	SHARK_RUNTIME_CHECK(std::memcmp(header.magic, magic, sizeof(magic)) == 0, "File is not in the binary data format");
+	SHARK_RUNTIME_CHECK(header.byteOrder == byteOrderMark, "File was written on a machine with different byte order");
+	SHARK_RUNTIME_CHECK(header.version == formatVersion, "Unsupported version of the binary data format");
+	SHARK_RUNTIME_CHECK(header.inputFormat <= SparseInputs && header.labelFormat <= DenseLabels, "Unknown storage format in file");
+	SHARK_RUNTIME_CHECK(header.inputRank < 64 && header.labelRank < 64, "Corrupted file header");
+	SHARK_RUNTIME_CHECK(header.numberOfBatches <= size / sizeof(BatchEntry), "Corrupted file header");
+	m_inputFormat = InputFormat(header.inputFormat);
+	m_labelFormat = LabelFormat(header.labelFormat);
+	m_numberOfElements = header.numberOfElements;
+
+	//shapes and batch table
+	std::uint64_t position = sizeof(header);
+	std::uint64_t tableEnd = position + (header.inputRank + header.labelRank + 4 * header.numberOfBatches) * sizeof(std::uint64_t);
+	SHARK_RUNTIME_CHECK(tableEnd <= size, "File is truncated");
+	std::vector<std::size_t> dims(header.inputRank + header.labelRank);
+	for(std::size_t i = 0; i != dims.size(); ++i, position += sizeof(std::uint64_t)){
+		std::uint64_t dim;
+		std::memcpy(&dim, begin + position, sizeof(dim));
+		dims[i] = dim;
+	}
+	m_inputShape = Shape(std::vector<std::size_t>(dims.begin(), dims.begin() + header.inputRank));
+	m_labelShape = Shape(std::vector<std::size_t>(dims.begin() + header.inputRank, dims.end()));
+	m_batches.resize(header.numberOfBatches);
+	std::memcpy(m_batches.data(), begin + position, m_batches.size() * sizeof(BatchEntry));
+
+	//check that all payloads are inside of the file and properly aligned
+	std::uint64_t numberOfElements = 0;
+	for(auto const& batch: m_batches){
+		numberOfElements += batch.size;
+		std::uint64_t inputBytes = m_inputFormat == DenseInputs
+			? batch.size * m_inputShape.numElements() * sizeof(double)
+			: (batch.size + 1 + 2 * batch.nonzeros) * sizeof(std::uint64_t);
+		SHARK_RUNTIME_CHECK(batch.inputOffset % sizeof(double) == 0, "Corrupted batch table");
+		SHARK_RUNTIME_CHECK(batch.inputOffset >= tableEnd && batch.inputOffset + inputBytes <= size, "File is truncated");
+		if(m_labelFormat != NoLabels){
+			std::uint64_t labelBytes = m_labelFormat == ClassLabels
+				? batch.size * sizeof(std::uint32_t)
+				: batch.size * m_labelShape.numElements() * sizeof(double);
+			SHARK_RUNTIME_CHECK(batch.labelOffset % sizeof(double) == 0, "Corrupted batch table");
+			SHARK_RUNTIME_CHECK(batch.labelOffset >= tableEnd && batch.labelOffset + labelBytes <= size, "File is truncated");
+		}
+	}
+	SHARK_RUNTIME_CHECK(numberOfElements == m_numberOfElements, "Corrupted batch table");
+
+	//the views returned by sparseInputs must be valid compressed sparse rows
+	if(m_inputFormat == SparseInputs){
+		std::size_t columns = m_inputShape.numElements();
+		for(std::size_t b = 0; b != m_batches.size(); ++b){
+			SparseBatch storage = sparseInputs(b);
+			std::uint64_t nnz = nonzeros(b);
+			SHARK_RUNTIME_CHECK(storage.major_indices_begin[0] == 0, "Corrupted sparse batch");
+			for(std::size_t i = 0; i != batchSize(b); ++i){
+				std::uint64_t rowBegin = storage.major_indices_begin[i];
+				std::uint64_t rowEnd = storage.major_indices_end[i];
+				SHARK_RUNTIME_CHECK(rowBegin <= rowEnd && rowEnd <= nnz, "Corrupted sparse batch");
+				for(std::uint64_t k = rowBegin; k != rowEnd; ++k){
+					SHARK_RUNTIME_CHECK(storage.indices[k] < columns, "Corrupted sparse batch");
+					SHARK_RUNTIME_CHECK(k == rowBegin || storage.indices[k - 1] < storage.indices[k], "Corrupted sparse batch");
+				}
+			}
+			//there is one more row offset than rows, the last one is the number of nonzeros
+			SHARK_RUNTIME_CHECK(storage.major_indices_begin[batchSize(b)] == nnz, "Corrupted sparse batch");
+		}
+	}
+}
+
+void shark::exportBinaryData(Data<RealVector> const& data, std::string const& fn){
+	writeBinaryData(data, static_cast<Data<unsigned int> const*>(nullptr), fn);
+}
+void shark::exportBinaryData(Data<CompressedRealVector> const& data, std::string const& fn){
+	writeBinaryData(data, static_cast<Data<unsigned int> const*>(nullptr), fn);
+}
+void shark::exportBinaryData(LabeledData<RealVector, unsigned int> const& data, std::string const& fn){
+	writeBinaryData(data.inputs(), &data.labels(), fn);
+}
+void shark::exportBinaryData(LabeledData<CompressedRealVector, unsigned int> const& data, std::string const& fn){
+	writeBinaryData(data.inputs(), &data.labels(), fn);
+}
+void shark::exportBinaryData(LabeledData<RealVector, RealVector> const& data, std::string const& fn){
+	writeBinaryData(data.inputs(), &data.labels(), fn);
+}
+void shark::exportBinaryData(LabeledData<CompressedRealVector, RealVector> const& data, std::string const& fn){
+	writeBinaryData(data.inputs(), &data.labels(), fn);
+}
+
+void shark::importBinaryData(Data<RealVector>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
+void shark::importBinaryData(Data<CompressedRealVector>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
+void shark::importBinaryData(LabeledData<RealVector, unsigned int>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
+void shark::importBinaryData(LabeledData<CompressedRealVector, unsigned int>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
+void shark::importBinaryData(LabeledData<RealVector, RealVector>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
+void shark::importBinaryData(LabeledData<CompressedRealVector, RealVector>& data, std::string const& fn){
+	readBinaryData(data, fn);
+}
@@ -34,8 +34,19 @@
 #define SHARK_COMPILE_DLL
 #include <limits>
 #include <boost/spirit/include/qi.hpp>
-#include <boost/fusion/adapted/std_pair.hpp>
 #include <shark/Data/Csv.h>
+#include <shark/Data/Impl/RecordStream.h>
+#include <shark/Data/Impl/TextParsing.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <ctype.h>
 
@@ -43,135 +54,241 @@ using namespace shark;
 
 namespace {
 
-//csv input for multiple homogenous values in a row
-inline std::vector<std::vector<double> > importCSVReaderSingleValues(
-	std::string const& contents,
-	char separator,
-	char comment = '#'
-) {
-	std::string::const_iterator first = contents.begin();
-	std::string::const_iterator last = contents.end();
-
-	using namespace boost::spirit::qi;
-	std::vector<std::vector<double> >  fileContents;
+using detail::isBlank;
+using detail::nextLine;
+using detail::parseDouble;
+using detail::splitLines;
 
-	double qnan = std::numeric_limits<double>::quiet_NaN();
+/// \brief Separator and comment character of a csv file.
+///
+/// A separator of 0 means that the fields are separated by whitespace.
+/// A comment of 0 means that the file has no comments.
+struct CsvSyntax{
+	CsvSyntax(char separator, char comment)
+	: separator(std::isspace(separator)? 0 : separator), comment(comment){}
+	char separator;
+	char comment;
+};
 
-	if(std::isspace(separator)){
-		separator = 0;
+/// \brief Restricts the line [begin, end) to its content without comment and surrounding whitespace.
+///
+/// Returns false if the line does not contain a record.
+inline bool recordContent(char const*& begin, char const*& end, CsvSyntax const& syntax){
+	while(end != begin && (end[-1] == '\n' || end[-1] == '\r')) --end;
+	if(syntax.comment){
+		char const* comment = static_cast<char const*>(std::memchr(begin, syntax.comment, end - begin));
+		if(comment) end = comment;
 	}
+	while(begin != end && isBlank(*begin)) ++begin;
+	while(end != begin && isBlank(end[-1])) --end;
+	return begin != end;
+}
 
-	bool r;
-	if( separator == 0){
-		r = phrase_parse(
-			first, last,
-			((
-				+(double_ | ('?' >>  attr(qnan) ))
-			) % eol) >> *eol,
-			(space-eol) | (comment >> *(char_ - eol) >> (eol| eoi)), fileContents
-		);
+/// \brief Parses a field of a record. Empty fields and '?' are read as NaN.
+inline double parseField(char const* begin, char const* end){
+	while(begin != end && isBlank(*begin)) ++begin;
+	while(end != begin && isBlank(end[-1])) --end;
+	if(begin == end || (end - begin == 1 && *begin == '?'))
+		return std::numeric_limits<double>::quiet_NaN();
+	double value;
+	SHARK_RUNTIME_CHECK(parseDouble(begin, end, value), "Failed to parse file");
+	return value;
+}
+
+/// \brief Calls f(j, fieldBegin, fieldEnd) for the j-th field of a record and returns the number of fields.
+template<class Functor>
+std::size_t forEachField(char const* begin, char const* end, CsvSyntax const& syntax, Functor f){
+	std::size_t numFields = 0;
+	char const* pos = begin;
+	if(syntax.separator){
+		while(true){
+			char const* separator = static_cast<char const*>(std::memchr(pos, syntax.separator, end - pos));
+			char const* fieldEnd = separator ? separator : end;
+			f(numFields, pos, fieldEnd);
+			++numFields;
+			if(!separator) break;
+			pos = separator + 1;
+		}
+	}else{
+		while(pos != end){
+			char const* fieldEnd = pos;
+			while(fieldEnd != end && !isBlank(*fieldEnd)) ++fieldEnd;
+			f(numFields, pos, fieldEnd);
+			++numFields;
+			pos = fieldEnd;
+			while(pos != end && isBlank(*pos)) ++pos;
+		}
 	}
-	else{
-		r = phrase_parse(
-			first, last,
-			(
-				(double_ | ((lit('?')| &lit(separator)) >>  attr(qnan))) % separator
-			) % eol >> *eol,
-			(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)) , fileContents
-		);
+	return numFields;
+}
+
+/// \brief Parses the fields of a record into values.
+///
+/// Returns the number of fields of the record. At most values.size() values are stored.
+inline std::size_t parseRecord(char const* begin, char const* end, CsvSyntax const& syntax, std::vector<double>& values){
+	return forEachField(begin, end, syntax, [&](std::size_t j, char const* fieldBegin, char const* fieldEnd){
+		if(j < values.size())
+			values[j] = parseField(fieldBegin, fieldEnd);
+	});
+}
+
+/// \brief Restricts a field to its content without surrounding whitespace and double quotes.
+///
+/// Returns false if the field is missing, i.e. empty or '?'.
+inline bool fieldContent(char const*& begin, char const*& end){
+	while(begin != end && isBlank(*begin)) ++begin;
+	while(end != begin && isBlank(end[-1])) --end;
+	if(end - begin >= 2 && *begin == '"' && end[-1] == '"'){
+		++begin;
+		--end;
 	}
+	return begin != end && !(end - begin == 1 && *begin == '?');
+}
 
-	SHARK_RUNTIME_CHECK(r && first == last, "Failed to parse file");
-	
-	for(std::size_t i = 0; i != fileContents.size(); ++i){
-		SHARK_RUNTIME_CHECK(
-			fileContents[i].size() == fileContents[0].size(),
-			"Detected different number of columns in a row of the file!"
-		);
+/// \brief Counts the fields of a record without parsing them.
+inline std::size_t countFields(char const* begin, char const* end, CsvSyntax const& syntax){
+	if(syntax.separator)
+		return 1 + std::count(begin, end, syntax.separator);
+	std::size_t numFields = 0;
+	for(char const* pos = begin; pos != end;){
+		++numFields;
+		while(pos != end && !isBlank(*pos)) ++pos;
+		while(pos != end && isBlank(*pos)) ++pos;
 	}
-	return fileContents;
+	return numFields;
 }
 
-//csv input for point-label pairs
-typedef std::pair<int, std::vector<double > > CsvPoint;
-inline std::vector<CsvPoint> import_csv_reader_points(
-	std::string const& contents,
-	LabelPosition position,
-	char separator,
-	char comment = '#'
-) {
-	typedef std::string::const_iterator Iterator;
-	Iterator first = contents.begin();
-	Iterator last = contents.end();
-	std::vector<CsvPoint> fileContents;
-
-	if(std::isspace(separator)){
-		separator = 0;
+/// \brief Splits the contents of a csv file into chunks of whole lines that are parsed in parallel.
+///
+/// The records are parsed in two passes. The first pass counts the records of each chunk, which
+/// gives the size of the dataset and the position of the records of every chunk in it. After the
+/// batches are allocated, the second pass parses the chunks in parallel and stores the values directly
+/// in the batches, using a single row buffer per chunk.
+class CsvChunks{
+public:
+	CsvChunks(char const* begin, char const* end, CsvSyntax const& syntax)
+	: m_syntax(syntax), m_numColumns(0){
+		count(begin, end, [](std::size_t){}, [](std::size_t, char const*, char const*){});
 	}
 
-	using namespace boost::spirit::qi;
-	using boost::spirit::_1;
-	using namespace boost::phoenix;
-
-	double qnan = std::numeric_limits<double>::quiet_NaN();
-
-	bool r = false;
-	if(separator == 0 && position == FIRST_COLUMN){
-		r = phrase_parse(
-			first, last,
-			(
-				lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> * (double_ | ('?' >>  attr(qnan) ))
-			) % eol >> *eol,
-			(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)), fileContents
-		);
+	/// \brief Counts the records and calls visit(c, recordBegin, recordEnd) for every record of the c-th chunk.
+	///
+	/// Before the records are counted, prepare(n) is called with the number of chunks n.
+	/// The calls of visit for different chunks run in parallel.
+	template<class Prepare, class Visitor>
+	CsvChunks(char const* begin, char const* end, CsvSyntax const& syntax, Prepare prepare, Visitor visit)
+	: m_syntax(syntax), m_numColumns(0){
+		count(begin, end, prepare, visit);
 	}
-	else if(separator != 0 && position == FIRST_COLUMN){
-		r = phrase_parse(
-			first, last,
-			(
-				lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> *(separator >> (double_ | (-lit('?') >>  attr(qnan) )))
-			) % eol >> *eol,
-			(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)) , fileContents
-		);
+
+	/// \brief Number of chunks the records are split into.
+	std::size_t numberOfChunks() const{
+		return m_chunkStart.size() - 1;
 	}
-	else if(separator == 0 && position == LAST_COLUMN){
-		do{
-			std::pair<std::vector<double>, int > reversed_point;
-			r = phrase_parse(
-				first, last,
-				*((double_ >> !(eol|eoi) ) | ('?' >>  attr(qnan)))
-				>> lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> (*eol|eoi),
-				(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)) , reversed_point
-			);
-			fileContents.push_back(CsvPoint(reversed_point.second,reversed_point.first));
-		}while(r && first != last);
+
+	/// \brief Number of records in the file.
+	std::size_t numberOfRecords() const{
+		return m_recordStart.back();
 	}
-	else{
-		do{
-			std::pair<std::vector<double>, int > reversed_point;
-			r = phrase_parse(
-				first, last,
-				*((double_ | (-lit('?') >>  attr(qnan))) >> separator)
-				>> lexeme[int_ >> -(lit('.')>>*lit('0'))]
-				>> (*eol|eoi),
-				(space-eol)| (comment >> *(char_ - eol) >> (eol| eoi)) , reversed_point
+
+	/// \brief Number of fields of the first record.
+	std::size_t numberOfColumns() const{
+		return m_numColumns;
+	}
+
+	/// \brief Calls f(c, i, recordBegin, recordEnd) for the i-th record, which is part of the c-th chunk.
+	///
+	/// The calls for different chunks run in parallel. Exceptions are rethrown after all chunks are done.
+	template<class Functor>
+	void forEachRecord(Functor f) const{
+		std::size_t numChunks = numberOfChunks();
+		//exceptions can not leave the thread pool, they are rethrown after all chunks are done
+		std::vector<std::exception_ptr> errors(numChunks);
+		auto parseChunk = [&](std::size_t c){
+			try{
+				std::size_t record = m_recordStart[c];
+				for(char const* line = m_chunkStart[c]; line != m_chunkStart[c + 1];){
+					char const* lineEnd = nextLine(line, m_chunkStart[c + 1]);
+					char const* recordBegin = line;
+					char const* recordEnd = lineEnd;
+					if(recordContent(recordBegin, recordEnd, m_syntax)){
+						f(c, record, recordBegin, recordEnd);
+						++record;
+					}
+					line = lineEnd;
+				}
+			}catch(...){
+				errors[c] = std::current_exception();
+			}
+		};
+		threading::parallelND({numChunks}, {1}, parseChunk, threading::globalThreadPool());
+		for(std::size_t c = 0; c != numChunks; ++c){
+			if(errors[c]) std::rethrow_exception(errors[c]);
+		}
+	}
+
+	/// \brief Parses all records in parallel and calls f(i, values) for the i-th record.
+	///
+	/// Every record must have numberOfColumns() fields. The calls for different chunks run in parallel.
+	template<class Functor>
+	void parse(Functor f) const{
+		std::vector<std::vector<double> > buffers(numberOfChunks(), std::vector<double>(m_numColumns));
+		forEachRecord([&](std::size_t c, std::size_t record, char const* recordBegin, char const* recordEnd){
+			std::vector<double>& values = buffers[c];
+			SHARK_RUNTIME_CHECK(
+				parseRecord(recordBegin, recordEnd, m_syntax, values) == m_numColumns,
+				"Detected different number of columns in a row of the file!"
 			);
-			fileContents.push_back(CsvPoint(reversed_point.second,reversed_point.first));
-		}while(r && first != last);
+			f(record, values);
+		});
 	}
-	SHARK_RUNTIME_CHECK(r && first == last, "Failed to parse file");
+private:
+	template<class Prepare, class Visitor>
+	void count(char const* begin, char const* end, Prepare prepare, Visitor visit){
+		m_chunkStart = splitLines(begin, end);
 
-	for(std::size_t i = 0; i != fileContents.size(); ++i){
-		SHARK_RUNTIME_CHECK(
-			fileContents[i].second.size() == fileContents[0].second.size(),
-			"Detected different number of columns in a row of the file!"
-		);
-		SHARK_RUNTIME_CHECK(fileContents[i].first >= -1, "labels can not be smaller than -1" );
+		//count the records of every chunk
+		std::size_t numChunks = m_chunkStart.size() - 1;
+		prepare(numChunks);
+		m_recordStart.assign(numChunks + 1, 0);
+		std::vector<std::size_t> numColumns(numChunks, 0);
+		auto countChunk = [&](std::size_t c){
+			std::size_t records = 0;
+			for(char const* line = m_chunkStart[c]; line != m_chunkStart[c + 1];){
+				char const* lineEnd = nextLine(line, m_chunkStart[c + 1]);
+				char const* recordBegin = line;
+				char const* recordEnd = lineEnd;
+				if(recordContent(recordBegin, recordEnd, m_syntax)){
+					if(records == 0)
+						numColumns[c] = countFields(recordBegin, recordEnd, m_syntax);
+					visit(c, recordBegin, recordEnd);
+					++records;
+				}
+				line = lineEnd;
+			}
+			m_recordStart[c + 1] = records;
+		};
+		threading::parallelND({numChunks}, {1}, countChunk, threading::globalThreadPool());
+		for(std::size_t c = 0; c != numChunks; ++c){
+			if(m_numColumns == 0)
+				m_numColumns = numColumns[c];
+			m_recordStart[c + 1] += m_recordStart[c];
+		}
 	}
-	return fileContents;
+
+	CsvSyntax m_syntax;
+	std::size_t m_numColumns;
+	std::vector<char const*> m_chunkStart;///< first character of every chunk, plus the end
+	std::vector<std::size_t> m_recordStart;///< index of the first record of every chunk, plus the total
+};
+
+/// \brief Converts a parsed label into a class label.
+inline int classLabel(double value){
+	SHARK_RUNTIME_CHECK(
+		value == std::floor(value) && value >= -1 && value <= double(std::numeric_limits<int>::max()),
+		"labels must be integers and can not be smaller than -1"
+	);
+	return int(value);
 }
 
 
@@ -179,113 +296,500 @@ inline std::vector<CsvPoint> import_csv_reader_points(
 template<class T>
 void readCSVData(
 	Data<blas::vector<T> > &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	char separator,
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::vector<std::vector<double> > rows = importCSVReaderSingleValues(contents, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
+	CsvChunks chunks(contents.begin(), contents.end(), CsvSyntax(separator, comment));
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
 		dataset = Data<blas::vector<T> >();
 		return;
 	}
 
-	//copy rows of the file into the dataset
-	std::size_t dimensions = rows[0].size();
-	dataset = Data<blas::vector<T> >(rows.size(), dimensions, maximumBatchSize);
-	std::size_t currentRow = 0;
-	for(auto&& batch: dataset) {
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batch.size1(); ++i,++currentRow){
-			for(std::size_t j = 0; j != dimensions; ++j){
-				batch(i,j) = rows[currentRow][j];
-			}
+	std::size_t dimensions = chunks.numberOfColumns();
+	dataset = Data<blas::vector<T> >(chunks.numberOfRecords(), dimensions, maximumBatchSize);
+	detail::BatchPartition positions(dataset.getPartitioning());
+	chunks.parse([&](std::size_t record, std::vector<double> const& values){
+		std::size_t b = positions.batch(record);
+		auto& batch = dataset[b];
+		std::size_t i = positions.positionInBatch(record, b);
+		for(std::size_t j = 0; j != dimensions; ++j){
+			batch(i,j) = values[j];
 		}
-	}
+	});
 }
 
 //copy file with input-class pair into dataset
 template<class T>
 void readCSVData(
 	LabeledData<blas::vector<T>, unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	char separator,
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::vector<CsvPoint> rows = import_csv_reader_points(contents, lp, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
+	CsvChunks chunks(contents.begin(), contents.end(), CsvSyntax(separator, comment));
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
 		dataset = LabeledData<blas::vector<T>, unsigned int>();
 		return;
 	}
 
+	//the raw labels are stored until the label format is known
+	std::size_t dimensions = chunks.numberOfColumns() - 1;
+	std::size_t inputStart = (lp == FIRST_COLUMN)? 1 : 0;
+	std::size_t labelColumn = (lp == FIRST_COLUMN)? 0 : dimensions;
+	std::vector<int> rawLabels(chunks.numberOfRecords());
+	dataset = LabeledData<blas::vector<T>, unsigned int>(chunks.numberOfRecords(), {dimensions, 1}, maximumBatchSize);
+	detail::BatchPartition positions(dataset.getPartitioning());
+	chunks.parse([&](std::size_t record, std::vector<double> const& values){
+		std::size_t b = positions.batch(record);
+		auto& batch = dataset.inputs()[b];
+		std::size_t i = positions.positionInBatch(record, b);
+		for(std::size_t j = 0; j != dimensions; ++j){
+			batch(i,j) = values[j + inputStart];
+		}
+		rawLabels[record] = classLabel(values[labelColumn]);
+	});
+
 	//check labels for conformity
 	bool binaryLabels = false;
 	int minPositiveLabel = std::numeric_limits<int>::max();
 	int maxPositiveLabel = -1;
 	{
-		for(std::size_t i = 0; i != rows.size(); ++i){
-			if(rows[i].first == -1)
+		for(std::size_t i = 0; i != rawLabels.size(); ++i){
+			if(rawLabels[i] == -1)
 				binaryLabels = true;
-			maxPositiveLabel = std::max(rows[i].first, maxPositiveLabel);
-			minPositiveLabel = std::min(rows[i].first, minPositiveLabel);
+			maxPositiveLabel = std::max(rawLabels[i], maxPositiveLabel);
+			minPositiveLabel = std::min(rawLabels[i], minPositiveLabel);
 		}
 		SHARK_RUNTIME_CHECK(
 			minPositiveLabel >= 0 || (minPositiveLabel == -1 && maxPositiveLabel == 1),
 			"negative labels are only allowed for classes -1/1"
 		);
 	}
-	//copy rows of the file into the dataset
-	std::size_t dimensions = rows[0].second.size();
-	dataset = LabeledData<blas::vector<T>, unsigned int>(rows.size(), {dimensions, (std::size_t)maxPositiveLabel + 1}, maximumBatchSize);
 	std::size_t currentRow = 0;
-	for(auto&& batch: dataset){
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batch.input.size1(); ++i,++currentRow){
-			for(std::size_t j = 0; j != dimensions; ++j){
-				batch.input(i,j) = rows[currentRow].second[j];
-			}
-			int rawLabel = rows[currentRow].first;
-			batch.label[i] = binaryLabels? 1 + (rawLabel-1)/2 : rawLabel;
+	for(std::size_t b = 0; b != dataset.size(); ++b){
+		auto& labels = dataset.labels()[b];
+		for(std::size_t i = 0; i != labels.size(); ++i, ++currentRow){
+			int rawLabel = rawLabels[currentRow];
+			labels(i) = binaryLabels? 1 + (rawLabel-1)/2 : rawLabel;
 		}
 	}
+	dataset.setShape({dimensions, (std::size_t)maxPositiveLabel + 1});
 }
 
 //copy file with input-vector-label pair into dataset
 template<class T>
 void readCSVData(
 	LabeledData<blas::vector<T>, blas::vector<T> > &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	std::size_t numberOfOutputs,
 	char separator,
 	char comment,
 	std::size_t maximumBatchSize
 ){
-	std::vector<std::vector<double> > rows = importCSVReaderSingleValues(contents, separator,comment);
-	if(rows.empty()){//empty file leads to empty data object.
+	CsvChunks chunks(contents.begin(), contents.end(), CsvSyntax(separator, comment));
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
 		dataset = LabeledData<blas::vector<T>, blas::vector<T> >();
 		return;
 	}
-	//copy rows of the file into the dataset
-	SHARK_RUNTIME_CHECK(rows[0].size() > numberOfOutputs,"Files must have more columns than requested number of outputs");
-	std::size_t numberOfInputs = rows[0].size() - numberOfOutputs;
-	dataset = LabeledData<blas::vector<T>, blas::vector<T> >(rows.size(), {numberOfInputs, numberOfOutputs}, maximumBatchSize);
+	SHARK_RUNTIME_CHECK(chunks.numberOfColumns() > numberOfOutputs,"Files must have more columns than requested number of outputs");
+	std::size_t numberOfInputs = chunks.numberOfColumns() - numberOfOutputs;
+	dataset = LabeledData<blas::vector<T>, blas::vector<T> >(chunks.numberOfRecords(), {numberOfInputs, numberOfOutputs}, maximumBatchSize);
 	std::size_t inputStart = (lp == FIRST_COLUMN)? numberOfOutputs : 0;
 	std::size_t outputStart = (lp == FIRST_COLUMN)? 0: numberOfInputs;
-	std::size_t currentRow = 0;
-	for(auto&& batch: dataset){
-		//copy the rows into the batch
-		for(std::size_t i = 0; i != batch.input.size1(); ++i,++currentRow){
-			for(std::size_t j = 0; j != numberOfInputs; ++j){
-				batch.input(i,j) = rows[currentRow][j+inputStart];
+	detail::BatchPartition positions(dataset.getPartitioning());
+	chunks.parse([&](std::size_t record, std::vector<double> const& values){
+		std::size_t b = positions.batch(record);
+		auto& inputs = dataset.inputs()[b];
+		auto& labels = dataset.labels()[b];
+		std::size_t i = positions.positionInBatch(record, b);
+		for(std::size_t j = 0; j != numberOfInputs; ++j){
+			inputs(i,j) = values[j+inputStart];
+		}
+		for(std::size_t j = 0; j != numberOfOutputs; ++j){
+			labels(i,j) = values[j+outputStart];
+		}
+	});
+}
+
+//schema driven readers
+
+/// \brief Orders the categories of a column: numbers by value first, then all other strings by name.
+inline bool categoryLess(std::string const& a, std::string const& b){
+	double valueA = 0, valueB = 0;
+	bool numberA = parseDouble(a.data(), a.data() + a.size(), valueA) && !std::isnan(valueA);
+	bool numberB = parseDouble(b.data(), b.data() + b.size(), valueB) && !std::isnan(valueB);
+	if(numberA != numberB)
+		return numberA;
+	if(numberA && valueA != valueB)
+		return valueA < valueB;
+	return a < b;
+}
+
+/// \brief Counts the records of a file and collects the categories of the columns of the schema without categories.
+///
+/// The categories are collected while the records are counted, every chunk collects its own set of categories,
+/// which are merged afterwards.
+CsvChunks collectCategories(boost::string_ref contents, CsvSyntax const& syntax, CsvSchema& schema){
+	std::size_t numColumns = schema.numberOfColumns();
+	SHARK_RUNTIME_CHECK(numColumns > 0, "The schema must describe at least one column");
+	std::vector<char> collect(numColumns, false);
+	for(std::size_t j = 0; j != numColumns; ++j){
+		CsvSchema::ColumnType type = schema.columnType(j);
+		collect[j] = (type == CsvSchema::Categorical || type == CsvSchema::ClassLabel) && schema.categories(j).empty();
+	}
+
+	std::vector<std::vector<std::unordered_set<std::string> > > chunkCategories;
+	CsvChunks chunks(contents.begin(), contents.end(), syntax,
+		[&](std::size_t numChunks){
+			chunkCategories.assign(numChunks, std::vector<std::unordered_set<std::string> >(numColumns));
+		},
+		[&](std::size_t c, char const* recordBegin, char const* recordEnd){
+			forEachField(recordBegin, recordEnd, syntax, [&](std::size_t j, char const* fieldBegin, char const* fieldEnd){
+				if(j < numColumns && collect[j] && fieldContent(fieldBegin, fieldEnd))
+					chunkCategories[c][j].emplace(fieldBegin, fieldEnd);
+			});
+		}
+	);
+	if(chunks.numberOfRecords() != 0){
+		SHARK_RUNTIME_CHECK(chunks.numberOfColumns() == numColumns, "The number of columns of the file does not match the schema");
+	}
+
+	for(std::size_t j = 0; j != numColumns; ++j){
+		if(!collect[j]) continue;
+		std::unordered_set<std::string> merged;
+		for(auto const& categories: chunkCategories)
+			merged.insert(categories[j].begin(), categories[j].end());
+		std::vector<std::string> categories(merged.begin(), merged.end());
+		std::sort(categories.begin(), categories.end(), categoryLess);
+		schema.setCategories(j, categories);
+	}
+	return chunks;
+}
+
+/// \brief Encodes the fields of a record as described by a CsvSchema.
+///
+/// Numeric and Target columns are parsed, Categorical columns are one-hot encoded and
+/// ClassLabel columns are replaced by the index of their category.
+class SchemaEncoder{
+public:
+	SchemaEncoder(CsvSchema const& schema, CsvSyntax const& syntax)
+	: m_syntax(syntax)
+	, m_types(schema.numberOfColumns())
+	, m_position(schema.numberOfColumns(), 0)
+	, m_codes(schema.numberOfColumns()){
+		std::size_t input = 0;
+		std::size_t target = 0;
+		for(std::size_t j = 0; j != m_types.size(); ++j){
+			m_types[j] = schema.columnType(j);
+			switch(m_types[j]){
+			case CsvSchema::Numeric:
+				m_position[j] = input++;
+				break;
+			case CsvSchema::Target:
+				m_position[j] = target++;
+				break;
+			case CsvSchema::Categorical:
+			case CsvSchema::ClassLabel:{
+				std::vector<std::string> const& categories = schema.categories(j);
+				for(std::size_t k = 0; k != categories.size(); ++k)
+					m_codes[j].emplace(categories[k], k);
+				SHARK_RUNTIME_CHECK(m_codes[j].size() == categories.size(), "The categories of a column must be unique");
+				m_position[j] = input;
+				if(m_types[j] == CsvSchema::Categorical)
+					input += categories.size();
+				break;
 			}
-			for(std::size_t j = 0; j != numberOfOutputs; ++j){
-				batch.label(i,j) = rows[currentRow][j+outputStart];
+			case CsvSchema::Ignored:
+				break;
 			}
 		}
 	}
+
+	/// \brief Stores the inputs, the class label and the targets of a record.
+	///
+	/// Depending on the schema, label and targets may be null.
+	template<class T>
+	void encode(char const* begin, char const* end, T* inputs, unsigned int* label, T* targets) const{
+		std::size_t numFields = forEachField(begin, end, m_syntax, [&](std::size_t j, char const* fieldBegin, char const* fieldEnd){
+			if(j >= m_types.size()) return;
+			switch(m_types[j]){
+			case CsvSchema::Numeric:
+				inputs[m_position[j]] = T(parseField(fieldBegin, fieldEnd));
+				break;
+			case CsvSchema::Target:{
+				double value = parseField(fieldBegin, fieldEnd);
+				SHARK_RUNTIME_CHECK(!std::isnan(value), "Missing value in a target column");
+				targets[m_position[j]] = T(value);
+				break;
+			}
+			case CsvSchema::Categorical:{
+				//missing and unknown categories are missing values of all dimensions of the column
+				T* oneHot = inputs + m_position[j];
+				std::size_t numCategories = m_codes[j].size();
+				std::size_t code = category(j, fieldBegin, fieldEnd);
+				if(code == numCategories){
+					std::fill(oneHot, oneHot + numCategories, std::numeric_limits<T>::quiet_NaN());
+				}else{
+					std::fill(oneHot, oneHot + numCategories, T(0));
+					oneHot[code] = T(1);
+				}
+				break;
+			}
+			case CsvSchema::ClassLabel:{
+				std::size_t code = category(j, fieldBegin, fieldEnd);
+				SHARK_RUNTIME_CHECK(code != m_codes[j].size(), "Missing or unknown class label: " + std::string(fieldBegin, fieldEnd));
+				*label = static_cast<unsigned int>(code);
+				break;
+			}
+			case CsvSchema::Ignored:
+				break;
+			}
+		});
+		SHARK_RUNTIME_CHECK(numFields == m_types.size(), "Detected different number of columns in a row of the file!");
+	}
+private:
+	/// \brief Returns the index of the category of a field, or the number of categories if it is missing or unknown.
+	std::size_t category(std::size_t j, char const* begin, char const* end) const{
+		if(!fieldContent(begin, end))
+			return m_codes[j].size();
+		auto pos = m_codes[j].find(std::string(begin, end));
+		return pos == m_codes[j].end()? m_codes[j].size() : pos->second;
+	}
+
+	CsvSyntax m_syntax;
+	std::vector<CsvSchema::ColumnType> m_types;
+	std::vector<std::size_t> m_position;///< first input dimension or target index of every column
+	std::vector<std::unordered_map<std::string, std::size_t> > m_codes;///< index of every category
+};
+
+//copy file with mixed content into dataset
+template<class T>
+void readCSVData(
+	Data<blas::vector<T> > &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	SHARK_RUNTIME_CHECK(
+		schema.numberOfColumns(CsvSchema::ClassLabel) == 0 && schema.numberOfColumns(CsvSchema::Target) == 0,
+		"Unlabeled data can not have label columns"
+	);
+	CsvSyntax syntax(separator, comment);
+	CsvChunks chunks = collectCategories(contents, syntax, schema);
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
+		dataset = Data<blas::vector<T> >();
+		return;
+	}
+	std::size_t dimensions = schema.inputDimension();
+	SHARK_RUNTIME_CHECK(dimensions > 0, "The schema does not describe any inputs");
+
+	dataset = Data<blas::vector<T> >(chunks.numberOfRecords(), dimensions, maximumBatchSize);
+	detail::BatchPartition positions(dataset.getPartitioning());
+	SchemaEncoder encoder(schema, syntax);
+	chunks.forEachRecord([&](std::size_t, std::size_t record, char const* recordBegin, char const* recordEnd){
+		std::size_t b = positions.batch(record);
+		std::size_t i = positions.positionInBatch(record, b);
+		encoder.encode<T>(recordBegin, recordEnd, &dataset[b](i, 0), nullptr, nullptr);
+	});
+}
+
+//copy file with mixed content and a class label into dataset
+template<class T>
+void readCSVData(
+	LabeledData<blas::vector<T>, unsigned int> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	SHARK_RUNTIME_CHECK(
+		schema.numberOfColumns(CsvSchema::ClassLabel) == 1 && schema.numberOfColumns(CsvSchema::Target) == 0,
+		"Classification data needs exactly one class label column"
+	);
+	CsvSyntax syntax(separator, comment);
+	CsvChunks chunks = collectCategories(contents, syntax, schema);
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
+		dataset = LabeledData<blas::vector<T>, unsigned int>();
+		return;
+	}
+	std::size_t dimensions = schema.inputDimension();
+	SHARK_RUNTIME_CHECK(dimensions > 0, "The schema does not describe any inputs");
+	std::size_t labelColumn = 0;
+	while(schema.columnType(labelColumn) != CsvSchema::ClassLabel) ++labelColumn;
+	std::size_t numClasses = schema.categories(labelColumn).size();
+
+	dataset = LabeledData<blas::vector<T>, unsigned int>(chunks.numberOfRecords(), {dimensions, numClasses}, maximumBatchSize);
+	detail::BatchPartition positions(dataset.getPartitioning());
+	SchemaEncoder encoder(schema, syntax);
+	chunks.forEachRecord([&](std::size_t, std::size_t record, char const* recordBegin, char const* recordEnd){
+		std::size_t b = positions.batch(record);
+		std::size_t i = positions.positionInBatch(record, b);
+		encoder.encode<T>(recordBegin, recordEnd, &dataset.inputs()[b](i, 0), &dataset.labels()[b](i), nullptr);
+	});
+}
+
+//copy file with mixed content and numeric targets into dataset
+template<class T>
+void readCSVData(
+	LabeledData<blas::vector<T>, blas::vector<T> > &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	std::size_t numberOfOutputs = schema.numberOfColumns(CsvSchema::Target);
+	SHARK_RUNTIME_CHECK(
+		schema.numberOfColumns(CsvSchema::ClassLabel) == 0 && numberOfOutputs > 0,
+		"Regression data needs at least one target column and no class label column"
+	);
+	CsvSyntax syntax(separator, comment);
+	CsvChunks chunks = collectCategories(contents, syntax, schema);
+	if(chunks.numberOfRecords() == 0){//empty file leads to empty data object.
+		dataset = LabeledData<blas::vector<T>, blas::vector<T> >();
+		return;
+	}
+	std::size_t dimensions = schema.inputDimension();
+	SHARK_RUNTIME_CHECK(dimensions > 0, "The schema does not describe any inputs");
+
+	dataset = LabeledData<blas::vector<T>, blas::vector<T> >(chunks.numberOfRecords(), {dimensions, numberOfOutputs}, maximumBatchSize);
+	detail::BatchPartition positions(dataset.getPartitioning());
+	SchemaEncoder encoder(schema, syntax);
+	chunks.forEachRecord([&](std::size_t, std::size_t record, char const* recordBegin, char const* recordEnd){
+		std::size_t b = positions.batch(record);
+		std::size_t i = positions.positionInBatch(record, b);
+		encoder.encode<T>(recordBegin, recordEnd, &dataset.inputs()[b](i, 0), nullptr, &dataset.labels()[b](i, 0));
+	});
+}
+
+//streaming readers
+
+typedef std::shared_ptr<detail::RecordStream> RecordStreamPtr;
+
+/// \brief Number of fields of the first record of the stream.
+std::size_t numberOfColumns(detail::RecordStream const& stream, CsvSyntax const& syntax){
+	char const* begin = stream.firstRecord().data();
+	char const* end = begin + stream.firstRecord().size();
+	recordContent(begin, end, syntax);
+	return countFields(begin, end, syntax);
+}
+
+/// \brief Parses a block of records read from a RecordStream and calls f(i, values) for the i-th record.
+template<class Functor>
+void parseRecords(std::string const& records, CsvSyntax const& syntax, std::size_t numColumns, Functor f){
+	std::vector<double> values(numColumns);
+	char const* end = records.data() + records.size();
+	std::size_t record = 0;
+	for(char const* line = records.data(); line != end;){
+		char const* lineEnd = nextLine(line, end);
+		char const* recordBegin = line;
+		char const* recordEnd = lineEnd;
+		if(recordContent(recordBegin, recordEnd, syntax)){
+			SHARK_RUNTIME_CHECK(
+				parseRecord(recordBegin, recordEnd, syntax, values) == numColumns,
+				"Detected different number of columns in a row of the file!"
+			);
+			f(record, values);
+			++record;
+		}
+		line = lineEnd;
+	}
+}
+
+void streamCSVData(
+	Generator<RealVector>& generator,
+	RecordStreamPtr const& stream,
+	CsvSyntax const& syntax,
+	std::size_t maximumBatchSize,
+	std::size_t cacheSize
+){
+	std::size_t dimensions = numberOfColumns(*stream, syntax);
+	auto nextBatch = [=]{
+		std::string records;
+		std::size_t size = stream->read(maximumBatchSize, records);
+		RealMatrix batch(size, dimensions);
+		parseRecords(records, syntax, dimensions, [&](std::size_t i, std::vector<double> const& values){
+			for(std::size_t j = 0; j != dimensions; ++j){
+				batch(i,j) = values[j];
+			}
+		});
+		return batch;
+	};
+	generator = Generator<RealVector>(nextBatch, dimensions, cacheSize);
+}
+
+void streamCSVData(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	RecordStreamPtr const& stream,
+	CsvSyntax const& syntax,
+	LabelPosition lp,
+	std::size_t numberOfClasses,
+	std::size_t maximumBatchSize,
+	std::size_t cacheSize
+){
+	typedef Batch<InputLabelPair<RealVector, unsigned int> >::type BatchType;
+	std::size_t numColumns = numberOfColumns(*stream, syntax);
+	SHARK_RUNTIME_CHECK(numColumns > 1, "Files must have more than one column");
+	std::size_t dimensions = numColumns - 1;
+	std::size_t inputStart = (lp == FIRST_COLUMN)? 1 : 0;
+	std::size_t labelColumn = (lp == FIRST_COLUMN)? 0 : dimensions;
+	auto nextBatch = [=]{
+		std::string records;
+		std::size_t size = stream->read(maximumBatchSize, records);
+		BatchType batch{RealMatrix(size, dimensions), UIntVector(size)};
+		parseRecords(records, syntax, numColumns, [&](std::size_t i, std::vector<double> const& values){
+			for(std::size_t j = 0; j != dimensions; ++j){
+				batch.input(i,j) = values[j + inputStart];
+			}
+			int label = classLabel(values[labelColumn]);
+			//binary labels -1/1 are mapped to 0/1
+			unsigned int unsignedLabel = label == -1 ? 0 : (unsigned int)label;
+			SHARK_RUNTIME_CHECK(unsignedLabel < numberOfClasses, "labels must be smaller than the number of classes");
+			batch.label(i) = unsignedLabel;
+		});
+		return batch;
+	};
+	generator = LabeledDataGenerator<RealVector, unsigned int>(nextBatch, {dimensions, numberOfClasses}, cacheSize);
+}
+
+void streamCSVData(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	RecordStreamPtr const& stream,
+	CsvSyntax const& syntax,
+	LabelPosition lp,
+	std::size_t numberOfOutputs,
+	std::size_t maximumBatchSize,
+	std::size_t cacheSize
+){
+	typedef Batch<InputLabelPair<RealVector, RealVector> >::type BatchType;
+	std::size_t numColumns = numberOfColumns(*stream, syntax);
+	SHARK_RUNTIME_CHECK(numColumns > numberOfOutputs,"Files must have more columns than requested number of outputs");
+	std::size_t numberOfInputs = numColumns - numberOfOutputs;
+	std::size_t inputStart = (lp == FIRST_COLUMN)? numberOfOutputs : 0;
+	std::size_t outputStart = (lp == FIRST_COLUMN)? 0: numberOfInputs;
+	auto nextBatch = [=]{
+		std::string records;
+		std::size_t size = stream->read(maximumBatchSize, records);
+		BatchType batch{RealMatrix(size, numberOfInputs), RealMatrix(size, numberOfOutputs)};
+		parseRecords(records, syntax, numColumns, [&](std::size_t i, std::vector<double> const& values){
+			for(std::size_t j = 0; j != numberOfInputs; ++j){
+				batch.input(i,j) = values[j+inputStart];
+			}
+			for(std::size_t j = 0; j != numberOfOutputs; ++j){
+				batch.label(i,j) = values[j+outputStart];
+			}
+		});
+		return batch;
+	};
+	generator = LabeledDataGenerator<RealVector, RealVector>(nextBatch, {numberOfInputs, numberOfOutputs}, cacheSize);
 }
 
 }//end unnamed namespace
@@ -294,14 +798,14 @@ void readCSVData(
 
 void shark::csvStringToData(
 	Data<unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	char separator,
 	char comment,
 	std::size_t maximumBatchSize
 ){
 	//read file contents
-	std::string::const_iterator first = contents.begin();
-	std::string::const_iterator last = contents.end();
+	char const* first = contents.begin();
+	char const* last = contents.end();
 
 	using namespace boost::spirit::qi;
 	std::vector<int>  rows;
@@ -350,7 +854,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
     Data<RealVector> &dataset,
-    std::string const& contents,
+    boost::string_ref contents,
     char separator,
     char comment,
     std::size_t maximumBatchSize
@@ -360,7 +864,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
     Data<FloatVector> &dataset,
-    std::string const& contents,
+    boost::string_ref contents,
     char separator,
     char comment,
     std::size_t maximumBatchSize
@@ -370,7 +874,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
 	LabeledData<RealVector, unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	char separator,
 	char comment,
@@ -381,7 +885,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
 	LabeledData<FloatVector, unsigned int> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	char separator,
 	char comment,
@@ -392,7 +896,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
 	LabeledData<RealVector, RealVector> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	std::size_t numberOfOutputs,
 	char separator,
@@ -404,7 +908,7 @@ void shark::csvStringToData(
 
 void shark::csvStringToData(
 	LabeledData<FloatVector, FloatVector> &dataset,
-	std::string const& contents,
+	boost::string_ref contents,
 	LabelPosition lp,
 	std::size_t numberOfOutputs,
 	char separator,
@@ -414,7 +918,160 @@ void shark::csvStringToData(
 	readCSVData(dataset, contents, lp, numberOfOutputs, separator, comment, maximumBatchSize);
 }
 
+void shark::csvStringToData(
+	Data<RealVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
+void shark::csvStringToData(
+	Data<FloatVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
+void shark::csvStringToData(
+	LabeledData<RealVector, unsigned int> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
+void shark::csvStringToData(
+	LabeledData<FloatVector, unsigned int> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
+void shark::csvStringToData(
+	LabeledData<RealVector, RealVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
+void shark::csvStringToData(
+	LabeledData<FloatVector, FloatVector> &dataset,
+	boost::string_ref contents,
+	CsvSchema& schema,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize
+){
+	readCSVData(dataset, contents, schema, separator, comment, maximumBatchSize);
+}
+
 
 ///////////////IMPORT WRAPPERS
 
 
+///////////////STREAMING
+
+void shark::streamCSV(
+	Generator<RealVector>& generator,
+	std::string const& fn,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(fn, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), maximumBatchSize, cacheSize);
+}
+
+void shark::streamCSV(
+	Generator<RealVector>& generator,
+	std::istream& input,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(input, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), maximumBatchSize, cacheSize);
+}
+
+void shark::streamCSV(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::string const& fn,
+	LabelPosition lp,
+	std::size_t numberOfClasses,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(fn, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), lp, numberOfClasses, maximumBatchSize, cacheSize);
+}
+
+void shark::streamCSV(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::istream& input,
+	LabelPosition lp,
+	std::size_t numberOfClasses,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(input, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), lp, numberOfClasses, maximumBatchSize, cacheSize);
+}
+
+void shark::streamCSV(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::string const& fn,
+	LabelPosition lp,
+	std::size_t numberOfOutputs,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(fn, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), lp, numberOfOutputs, maximumBatchSize, cacheSize);
+}
+
+void shark::streamCSV(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::istream& input,
+	LabelPosition lp,
+	std::size_t numberOfOutputs,
+	char separator,
+	char comment,
+	std::size_t maximumBatchSize,
+	std::size_t titleLines,
+	std::size_t cacheSize
+){
+	RecordStreamPtr stream(new detail::RecordStream(input, comment, titleLines));
+	streamCSVData(generator, stream, CsvSyntax(separator, comment), lp, numberOfOutputs, maximumBatchSize, cacheSize);
+}
@@ -0,0 +1,166 @@
+//===========================================================================
+/*!
+ *
+ *
+ * \brief       Loads image datasets stored in zip archives
+ *
+ *
+ *
+ *
+ * \author      -
+ * \date        -
+ *
+ *
+ * \par Copyright 1995-2017 Shark Development Team
+ *
+ * <BR><HR>
+ * This file is part of Shark.
+ * <http://shark-ml.org/>
+ *
+ * Shark is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Shark is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Shark.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+//===========================================================================
+#define SHARK_COMPILE_DLL
+#include <shark/Data/ImageArchive.h>
+#include <shark/Core/Images/ReadImage.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <shark/Core/Timer.h>
+#include <shark/Core/ZipSupport.h>
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <map>
+
+using namespace shark;
+
+namespace {
+
+bool isImageFile(std::string const& name){
+	std::size_t dot = name.rfind('.');
+	if(dot == std::string::npos)
+		return false;
+	std::string extension = name.substr(dot + 1);
+	for(char& c: extension)
+		c = std::tolower(static_cast<unsigned char>(c));
+	return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "pgm";
+}
+
+/// \brief Returns the indices of the images in the archive, ordered by their names.
+std::vector<std::size_t> imageFiles(ZipReader const& reader){
+	std::vector<std::size_t> files;
+	for(std::size_t i = 0; i != reader.numFiles(); ++i){
+		if(isImageFile(reader.fileName(i)))
+			files.push_back(i);
+	}
+	SHARK_RUNTIME_CHECK(!files.empty(), "The archive does not contain any images");
+	std::sort(files.begin(), files.end(), [&](std::size_t i, std::size_t j){
+		return reader.fileName(i) < reader.fileName(j);
+	});
+	return files;
+}
+
+/// \brief Returns the shape of the first image, all other images must have the same shape.
+Shape imageShape(ZipReader const& reader, std::vector<std::size_t> const& files){
+	std::vector<unsigned char> contents = reader.readFile(files.front());
+	SHARK_RUNTIME_CHECK(!contents.empty(), "Empty image file: " + reader.fileName(files.front()));
+	return image::readImage<double>(contents).second;
+}
+
+/// \brief Reads and decodes the images into the preallocated batches and returns the size of the decompressed files.
+///
+/// Every batch is filled by one task of the threadpool, the archive only serializes reading the compressed files.
+std::size_t readImages(ZipReader const& reader, std::vector<std::size_t> const& files, Data<RealVector>& images){
+	Shape const& shape = images.shape();
+	detail::BatchPartition partition(images.getPartitioning());
+	std::vector<std::size_t> bytes(images.size(), 0);
+	std::vector<std::exception_ptr> errors(images.size());
+	auto readBatch = [&](std::size_t b){
+		try{
+			RealMatrix& batch = images[b];
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				std::size_t file = files[partition.batchStart(b) + i];
+				std::vector<unsigned char> contents = reader.readFile(file);
+				bytes[b] += contents.size();
+				SHARK_RUNTIME_CHECK(!contents.empty(), "Empty image file: " + reader.fileName(file));
+				auto decoded = image::readImage<double>(contents);
+				SHARK_RUNTIME_CHECK(decoded.second == shape, "All images are required to have the same size: " + reader.fileName(file));
+				noalias(row(batch, i)) = decoded.first;
+			}
+		}catch(...){
+			errors[b] = std::current_exception();
+		}
+	};
+	threading::parallelND({images.size()}, {1}, readBatch, threading::globalThreadPool());
+	for(auto const& error: errors){
+		if(error)
+			std::rethrow_exception(error);
+	}
+	std::size_t totalBytes = 0;
+	for(std::size_t size: bytes)
+		totalBytes += size;
+	return totalBytes;
+}
+}
+
+ArchiveImportStatistics shark::importImageArchive(
+	Data<RealVector>& images,
+	std::string const& archive,
+	std::size_t maximumBatchSize
+){
+	Timer timer;
+	ZipReader reader(archive);
+	std::vector<std::size_t> files = imageFiles(reader);
+	images = Data<RealVector>(files.size(), imageShape(reader, files), maximumBatchSize);
+	std::size_t bytes = readImages(reader, files, images);
+	return ArchiveImportStatistics{files.size(), bytes, timer.stop()};
+}
+
+ArchiveImportStatistics shark::importImageArchive(
+	LabeledData<RealVector, unsigned int>& data,
+	std::vector<std::string>& classNames,
+	std::string const& archive,
+	std::size_t maximumBatchSize
+){
+	Timer timer;
+	ZipReader reader(archive);
+	std::vector<std::size_t> files = imageFiles(reader);
+
+	//the class of a file is the name of its top-level directory
+	std::vector<std::string> fileClasses(files.size());
+	std::map<std::string, unsigned int> classes;
+	for(std::size_t i = 0; i != files.size(); ++i){
+		std::string const& name = reader.fileName(files[i]);
+		std::size_t separator = name.find('/');
+		SHARK_RUNTIME_CHECK(separator != std::string::npos, "Image is not stored in a class directory: " + name);
+		fileClasses[i] = name.substr(0, separator);
+		classes.emplace(fileClasses[i], 0);
+	}
+	classNames.clear();
+	for(auto& c: classes){
+		c.second = static_cast<unsigned int>(classNames.size());
+		classNames.push_back(c.first);
+	}
+
+	data = LabeledData<RealVector, unsigned int>(
+		files.size(), {imageShape(reader, files), Shape({classNames.size()})}, maximumBatchSize
+	);
+	std::size_t element = 0;
+	for(auto& batch: data.labels()){
+		for(std::size_t i = 0; i != batch.size(); ++i, ++element)
+			batch(i) = classes[fileClasses[element]];
+	}
+	std::size_t bytes = readImages(reader, files, data.inputs());
+	return ArchiveImportStatistics{files.size(), bytes, timer.stop()};
+}
@@ -33,200 +33,506 @@
 //===========================================================================
 #define SHARK_COMPILE_DLL
 #include <limits>
-#include <boost/spirit/include/qi.hpp>
-#include <boost/fusion/adapted/std_pair.hpp>
 #include <shark/Data/SparseData.h>
+#include <shark/Data/Impl/RecordStream.h>
+#include <shark/Data/Impl/TextParsing.h>
+#include <shark/Core/MappedFile.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <boost/utility/string_ref.hpp>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <sstream>
 
 using namespace shark;
 
 namespace {
 
+using detail::isBlank;
+using detail::nextLine;
+using detail::parseDouble;
+using detail::splitLines;
+
 typedef std::pair<double, std::vector<std::pair<std::size_t, double> > > LibSVMPoint;
-inline std::vector<LibSVMPoint> 
-importSparseDataReader(std::istream& stream) {
-	std::vector<LibSVMPoint> fileContents;
-	while(stream) {
-		std::string line;
-		std::getline(stream, line);
-		if (line.empty()) continue;
-
-		using namespace boost::spirit::qi;
-		std::string::const_iterator first = line.begin();
-		std::string::const_iterator last = line.end();
-
-		LibSVMPoint newPoint;
-		bool r = phrase_parse(
-			first, last, 
-			double_ >> *(uint_ >> ':' >> double_),
-			space, newPoint
-		);
-		SHARK_RUNTIME_CHECK(r && first == last, "Failed to parse record: " + line);
 
-		fileContents.push_back(newPoint);
-	}
-	return fileContents;
+/// \brief Restricts the line [begin, end) to its content without surrounding whitespace.
+///
+/// Returns false if the line is empty.
+inline bool recordContent(char const*& begin, char const*& end){
+	while(end != begin && (end[-1] == '\n' || end[-1] == '\r')) --end;
+	while(begin != end && isBlank(*begin)) ++begin;
+	while(end != begin && isBlank(end[-1])) --end;
+	return begin != end;
 }
 
-template<class T>
-void copySparsePoints(Data<blas::vector<T> >& dataset, std::vector<LibSVMPoint> const& points, bool hasZero){
-	std::size_t delta = (hasZero ? 0 : 1);
-	std::size_t i = 0;
-	for(auto element: elements(dataset)){
-		element.clear();
-
-		auto const& inputs = points[i].second;
-		for(std::size_t j = 0; j != inputs.size(); ++j)
-			element(inputs[j].first - delta) = static_cast<T>(inputs[j].second);
-		++i;
+/// \brief Parses the feature index in front of the ':' starting at pos and moves pos behind the ':'.
+inline bool parseIndex(char const*& pos, char const* end, std::size_t& index){
+	char const* start = pos;
+	index = 0;
+	for(; pos != end && *pos >= '0' && *pos <= '9'; ++pos)
+		index = 10 * index + (*pos - '0');
+	if(pos == start || pos == end || *pos != ':')
+		return false;
+	++pos;
+	return true;
+}
+
+/// \brief Parses the label in front of the features of a record of a libsvm file.
+///
+/// Returns the position behind the label.
+inline char const* parseSparseLabel(char const* begin, char const* end, double& label){
+	char const* pos = begin;
+	char const* tokenEnd = pos;
+	while(tokenEnd != end && !isBlank(*tokenEnd)) ++tokenEnd;
+	SHARK_RUNTIME_CHECK(parseDouble(pos, tokenEnd, label), "Failed to parse record: " + std::string(begin, end));
+	return tokenEnd;
+}
+
+/// \brief Parses a record "label index:value index:value ..." of a libsvm file.
+///
+/// Calls feature(k, index, value) for the k-th feature of the record and returns the number of features.
+template<class Functor>
+std::size_t parseSparseRecord(char const* begin, char const* end, double& label, Functor feature){
+	char const* pos = begin;
+	char const* tokenEnd = parseSparseLabel(begin, end, label);
+	std::size_t k = 0;
+	for(pos = tokenEnd; pos != end; ++k){
+		while(pos != end && isBlank(*pos)) ++pos;
+		if(pos == end) break;
+		std::size_t index;
+		SHARK_RUNTIME_CHECK(parseIndex(pos, end, index), "Failed to parse record: " + std::string(begin, end));
+		tokenEnd = pos;
+		while(tokenEnd != end && !isBlank(*tokenEnd)) ++tokenEnd;
+		double value;
+		SHARK_RUNTIME_CHECK(parseDouble(pos, tokenEnd, value), "Failed to parse record: " + std::string(begin, end));
+		feature(k, index, value);
+		pos = tokenEnd;
 	}
+	return k;
 }
 
-//sparse vectors need some pre-allocation for fast insertion
-template<class T>
-void copySparsePoints(Data<blas::compressed_vector<T> >& dataset, std::vector<LibSVMPoint> const& points, bool hasZero){
-	std::size_t delta = (hasZero ? 0 : 1);
-	
-	std::size_t start = 0;//first element of the batch in points
-	for(auto& batch: dataset){
-		//allocate nonzeros for every batch and every row in the batch
-		std::size_t nnz = 0;
-		for(std::size_t i = 0; i != batch.size1(); ++i){
-			nnz += points[start+i].second.size();
+/// \brief Splits the contents of a libsvm file into chunks of whole lines that are parsed in parallel.
+///
+/// The first pass only reads the feature indices of every record. It yields the number of records
+/// and the number of nonzeros of each record, which are needed to allocate the batches, and the
+/// range of the indices. The second pass parses labels and values and stores them directly at
+/// their final position in the batches.
+class SparseChunks{
+public:
+	SparseChunks(char const* begin, char const* end)
+	: m_chunkStart(splitLines(begin, end))
+	, m_minIndex(std::numeric_limits<std::size_t>::max())
+	, m_maxIndex(0)
+	, m_sorted(true){
+		std::size_t numChunks = m_chunkStart.size() - 1;
+		std::vector<std::vector<std::size_t> > nonzeros(numChunks);
+		std::vector<std::size_t> minIndex(numChunks, std::numeric_limits<std::size_t>::max());
+		std::vector<std::size_t> maxIndex(numChunks, 0);
+		std::vector<char> sorted(numChunks, true);
+		auto scanChunk = [&](std::size_t c){
+			for(char const* line = m_chunkStart[c]; line != m_chunkStart[c + 1];){
+				char const* lineEnd = nextLine(line, m_chunkStart[c + 1]);
+				char const* recordBegin = line;
+				char const* recordEnd = lineEnd;
+				line = lineEnd;
+				if(!recordContent(recordBegin, recordEnd)) continue;
+				//skip the label, then read the index of every feature
+				char const* pos = recordBegin;
+				while(pos != recordEnd && !isBlank(*pos)) ++pos;
+				std::size_t nnz = 0;
+				std::size_t lastIndex = 0;
+				while(pos != recordEnd){
+					while(pos != recordEnd && isBlank(*pos)) ++pos;
+					if(pos == recordEnd) break;
+					std::size_t index;
+					SHARK_RUNTIME_CHECK(parseIndex(pos, recordEnd, index), "Failed to parse record: " + std::string(recordBegin, recordEnd));
+					while(pos != recordEnd && !isBlank(*pos)) ++pos;
+					if(nnz != 0 && index <= lastIndex)
+						sorted[c] = false;
+					minIndex[c] = std::min(minIndex[c], index);
+					maxIndex[c] = std::max(maxIndex[c], index);
+					lastIndex = index;
+					++nnz;
+				}
+				nonzeros[c].push_back(nnz);
+			}
+		};
+		parallelForChunks(scanChunk);
+
+		m_recordStart.assign(numChunks + 1, 0);
+		for(std::size_t c = 0; c != numChunks; ++c){
+			m_recordStart[c + 1] = m_recordStart[c] + nonzeros[c].size();
+			m_nonzeros.insert(m_nonzeros.end(), nonzeros[c].begin(), nonzeros[c].end());
+			m_minIndex = std::min(m_minIndex, minIndex[c]);
+			m_maxIndex = std::max(m_maxIndex, maxIndex[c]);
+			m_sorted = m_sorted && sorted[c];
 		}
-		batch.reserve(nnz);
-		
-		//copy data into the batch
-		for(std::size_t i = 0; i != batch.size1(); ++i){
-			//allocate nonzeros for the row
-			batch.major_reserve(i,points[start+i].second.size());
-			//copy elements
-			auto const& inputs = points[start+i].second;
-			auto pos = batch.major_end(i);
-			for(std::size_t j = 0; j != inputs.size(); ++j){
-				pos = batch.set_element(pos,inputs[j].first - delta,static_cast<T>(inputs[j].second));
+	}
+
+	/// \brief Number of records in the file.
+	std::size_t numberOfRecords() const{
+		return m_nonzeros.size();
+	}
+	/// \brief Number of features of the i-th record.
+	std::size_t nonzeros(std::size_t i) const{
+		return m_nonzeros[i];
+	}
+	/// \brief Smallest feature index in the file.
+	std::size_t minIndex() const{
+		return m_minIndex;
+	}
+	/// \brief Largest feature index in the file, 0 if there are no features.
+	std::size_t maxIndex() const{
+		return m_maxIndex;
+	}
+	/// \brief True if the feature indices of every record are strictly increasing.
+	bool sorted() const{
+		return m_sorted;
+	}
+
+	/// \brief Parses all records in parallel.
+	///
+	/// Calls label(i, value) for the i-th record and feature(i, k, index, value) for its k-th feature.
+	template<class LabelFunctor, class FeatureFunctor>
+	void parse(LabelFunctor label, FeatureFunctor feature) const{
+		auto parseChunk = [&](std::size_t c){
+			std::size_t record = m_recordStart[c];
+			for(char const* line = m_chunkStart[c]; line != m_chunkStart[c + 1];){
+				char const* lineEnd = nextLine(line, m_chunkStart[c + 1]);
+				char const* recordBegin = line;
+				char const* recordEnd = lineEnd;
+				line = lineEnd;
+				if(!recordContent(recordBegin, recordEnd)) continue;
+				double value;
+				parseSparseRecord(recordBegin, recordEnd, value, [&](std::size_t k, std::size_t index, double featureValue){
+					feature(record, k, index, featureValue);
+				});
+				label(record, value);
+				++record;
+			}
+		};
+		parallelForChunks(parseChunk);
+	}
+
+private:
+	/// \brief Calls f(c) for all chunks in parallel and rethrows the first exception afterwards.
+	template<class Functor>
+	void parallelForChunks(Functor f) const{
+		std::size_t numChunks = m_chunkStart.size() - 1;
+		if(numChunks == 0) return;
+		std::vector<std::exception_ptr> errors(numChunks);
+		threading::parallelND({numChunks}, {1}, [&](std::size_t c){
+			try{
+				f(c);
+			}catch(...){
+				errors[c] = std::current_exception();
 			}
+		}, threading::globalThreadPool());
+		for(std::size_t c = 0; c != numChunks; ++c){
+			if(errors[c]) std::rethrow_exception(errors[c]);
 		}
-		start += batch.size1();
 	}
-}
-	
-template<class T>//We assume T to be vectorial
-shark::LabeledData<T, unsigned int> libsvm_importer_classification(
-	std::istream& stream,
+
+	std::vector<char const*> m_chunkStart;///< first character of every chunk, plus the end
+	std::vector<std::size_t> m_recordStart;///< index of the first record of every chunk, plus the total
+	std::vector<std::size_t> m_nonzeros;///< number of features of every record
+	std::size_t m_minIndex;
+	std::size_t m_maxIndex;
+	bool m_sorted;
+};
+
+/// \brief Writes the parsed features directly into dense batches.
+template<class InputType>
+class FeatureWriter{
+public:
+	FeatureWriter(Data<InputType>& inputs, SparseChunks const&, std::size_t indexShift)
+	: m_inputs(inputs), m_positions(inputs.getPartitioning()), m_indexShift(indexShift){
+		for(auto& batch: m_inputs)
+			batch.clear();
+	}
+	void operator()(std::size_t record, std::size_t, std::size_t index, double value){
+		std::size_t b = m_positions.batch(record);
+		m_inputs[b](m_positions.positionInBatch(record, b), index - m_indexShift) = static_cast<typename InputType::value_type>(value);
+	}
+private:
+	Data<InputType>& m_inputs;
+	detail::BatchPartition m_positions;
+	std::size_t m_indexShift;
+};
+
+/// \brief Writes the parsed features directly into the compressed row storage of sparse batches.
+///
+/// The rows of every batch are allocated in advance with the number of nonzeros found by the first pass.
+template<class T>
+class FeatureWriter<blas::compressed_vector<T> >{
+public:
+	FeatureWriter(Data<blas::compressed_vector<T> >& inputs, SparseChunks const& chunks, std::size_t indexShift)
+	: m_positions(inputs.getPartitioning()), m_indexShift(indexShift){
+		SHARK_RUNTIME_CHECK(chunks.sorted(), "Feature indices of a record must be strictly increasing");
+		for(std::size_t b = 0; b != inputs.size(); ++b){
+			auto& batch = inputs[b];
+			std::size_t first = m_positions.batchStart(b);
+			std::size_t nnz = 0;
+			for(std::size_t i = 0; i != batch.size1(); ++i)
+				nnz += chunks.nonzeros(first + i);
+			batch.reserve(nnz);
+			auto storage = batch.raw_storage();
+			std::size_t pos = 0;
+			for(std::size_t i = 0; i != batch.size1(); ++i){
+				storage.major_indices_begin[i] = pos;
+				pos += chunks.nonzeros(first + i);
+				storage.major_indices_end[i] = pos;
+			}
+			storage.major_indices_begin[batch.size1()] = pos;
+			m_storage.push_back(storage);
+		}
+	}
+	void operator()(std::size_t record, std::size_t k, std::size_t index, double value){
+		std::size_t b = m_positions.batch(record);
+		auto const& storage = m_storage[b];
+		std::size_t pos = storage.major_indices_begin[m_positions.positionInBatch(record, b)] + k;
+		storage.indices[pos] = index - m_indexShift;
+		storage.values[pos] = static_cast<T>(value);
+	}
+private:
+	std::vector<typename blas::compressed_matrix<T>::storage_type> m_storage;
+	detail::BatchPartition m_positions;
+	std::size_t m_indexShift;
+};
+
+/// \brief Parses the file, allocates the dataset and fills the inputs. Returns the raw labels.
+template<class InputType, class LabelShape, class DatasetType>
+std::vector<double> readSparseInputs(
+	DatasetType& data,
+	SparseChunks const& chunks,
 	std::size_t dimensions,
+	LabelShape labelShape,
 	std::size_t batchSize
 ){
-	//read contents of stream
-	std::vector<LibSVMPoint> contents = importSparseDataReader(stream);
-	std::size_t numPoints = contents.size();
-	
-	//find data dimension by getting the maximum index
-	std::size_t maxIndex = 0;
-	for(std::size_t i = 0; i != numPoints; ++i){
-		auto const& inputs = contents[i].second;
-		if(!inputs.empty())
-			maxIndex = std::max(maxIndex, inputs.back().first);
-	}
-	maxIndex = std::max<std::size_t>(maxIndex,dimensions);
+	//indices start at 1, unless index 0 is used
+	std::size_t indexShift = chunks.minIndex() == 0 ? 0 : 1;
+	std::size_t maxIndex = chunks.maxIndex();
 	SHARK_RUNTIME_CHECK(dimensions == 0 || maxIndex <= dimensions, "Number of dimensions supplied is smaller than actual index data" );
+	std::size_t vectorDim = std::max(maxIndex, dimensions) + (1 - indexShift);
+
+	data = DatasetType(chunks.numberOfRecords(), {vectorDim, labelShape}, batchSize);
+	std::vector<double> labels(chunks.numberOfRecords());
+	FeatureWriter<InputType> writer(data.inputs(), chunks, indexShift);
+	chunks.parse(
+		[&](std::size_t record, double value){labels[record] = value;},
+		writer
+	);
+	return labels;
+}
 
-	//check labels for conformity
-	bool binaryLabels = false;
-	int minPositiveLabel = std::numeric_limits<int>::max();
-	int maxPositiveLabel = -1;
-	{
-		for(std::size_t i = 0; i != numPoints; ++i){
-			int label = static_cast<int>(contents[i].first);
-			SHARK_RUNTIME_CHECK(label == contents[i].first, "non-integer labels are only allows for regression" );
-			SHARK_RUNTIME_CHECK(label >= -1, "labels can not be smaller than -1" );
-			if(label == -1)
-				binaryLabels = true;
-			else if(label < minPositiveLabel)
-				minPositiveLabel = label;
-			else if(label > maxPositiveLabel)
-				maxPositiveLabel = label;
-		}
+/// \brief Maps the integer labels of a libsvm file to the classes 0,...,n-1.
+///
+/// The labels -1/1 of binary problems are mapped to 0/1, otherwise the smallest label becomes 0.
+/// All labels must be added before the mapping is used.
+class ClassLabelMapping{
+public:
+	ClassLabelMapping()
+	: m_binaryLabels(false)
+	, m_minLabel(std::numeric_limits<int>::max())
+	, m_maxLabel(-1){}
+
+	/// \brief Checks the label of a record for conformity and adds it to the range of labels.
+	void add(double value){
+		int label = static_cast<int>(value);
+		SHARK_RUNTIME_CHECK(label == value, "non-integer labels are only allows for regression" );
+		SHARK_RUNTIME_CHECK(label >= -1, "labels can not be smaller than -1" );
+		m_binaryLabels = m_binaryLabels || label == -1;
+		m_minLabel = std::min(m_minLabel, label);
+		m_maxLabel = std::max(m_maxLabel, label);
+	}
+
+	/// \brief Returns the number of classes, 0 if no label was added.
+	///
+	/// Throws an exception if the labels are negative but not -1/1.
+	std::size_t numberOfClasses() const{
+		if(m_maxLabel < m_minLabel)
+			return 0;
 		SHARK_RUNTIME_CHECK(
-			minPositiveLabel >= 0 || (minPositiveLabel == -1 && maxPositiveLabel == 1),
+			!m_binaryLabels || m_maxLabel == 1,
 			"negative labels are only allowed for classes -1/1"
 		);
+		return m_binaryLabels ? 2 : std::size_t(m_maxLabel - m_minLabel + 1);
 	}
 
-	// check for feature index zero (non-standard, but it happens)
-	bool hasZero = false;
-	for (std::size_t i=0; i<numPoints; i++)
-	{
-		std::vector<std::pair<std::size_t, double> > const& input = contents[i].second;
-		if (input.empty()) continue;
-		if (input[0].first == 0)
-		{
-			hasZero = true;
-			break;
-		}
+	/// \brief Returns the class of a label that was added before.
+	unsigned int operator()(double value) const{
+		int label = static_cast<int>(value);
+		return static_cast<unsigned int>(m_binaryLabels? (label + 1) / 2 : label - m_minLabel);
+	}
+private:
+	bool m_binaryLabels;
+	int m_minLabel;
+	int m_maxLabel;
+};
+
+template<class T>//We assume T to be vectorial
+shark::LabeledData<T, unsigned int> libsvm_importer_classification(
+	boost::string_ref contents,
+	std::size_t dimensions,
+	std::size_t batchSize
+){
+	SparseChunks chunks(contents.begin(), contents.end());
+	shark::LabeledData<T, unsigned int> data;
+	std::vector<double> labels = readSparseInputs<T>(data, chunks, dimensions, 0, batchSize);
+
+	//check labels for conformity
+	ClassLabelMapping mapping;
+	for(double value: labels){
+		mapping.add(value);
 	}
 
-	//copy contents into a new dataset
-	std::size_t vectorDim = maxIndex + (hasZero ? 1 : 0);
-	shark::LabeledData<T, unsigned int> data(numPoints, {vectorDim, (std::size_t)maxPositiveLabel + 1}, batchSize);
-	std::size_t batchStart = 0;
+	std::size_t numClasses = mapping.numberOfClasses();
+
+	std::size_t record = 0;
 	for(auto& batch: data.labels()){
-		for(std::size_t j = 0; j != batch.size(); ++j){
-			int label = static_cast<int>(contents[batchStart+j].first);
-			unsigned int unsignedLabel = static_cast<unsigned int>(binaryLabels? 1 + (label-1)/2 : label-minPositiveLabel);
-			batch(j) = unsignedLabel;
+		for(std::size_t j = 0; j != batch.size(); ++j, ++record){
+			batch(j) = mapping(labels[record]);
 		}
-		batchStart += batch.size();
 	}
-	copySparsePoints(data.inputs(),contents, hasZero);
+	data.setShape({data.shape().input, numClasses});
 	return data;
 }
 
 template<class T>//We assume T to be vectorial
 shark::LabeledData<T, blas::vector<typename T::value_type> > libsvm_importer_regression(
-	std::istream& stream,
+	boost::string_ref contents,
 	std::size_t dimensions,
 	std::size_t batchSize
 ){
-	//read contents of stream
-	std::vector<LibSVMPoint> contents = importSparseDataReader(stream);
-	std::size_t numPoints = contents.size();
-	
-	//find data dimension by getting the maximum index
-	std::size_t maxIndex = 0;
-	for(std::size_t i = 0; i != numPoints; ++i){
-		auto const& inputs = contents[i].second;
-		if(!inputs.empty())
-			maxIndex = std::max(maxIndex, inputs.back().first);
+	SparseChunks chunks(contents.begin(), contents.end());
+	shark::LabeledData<T, blas::vector<typename T::value_type> > data;
+	std::vector<double> labels = readSparseInputs<T>(data, chunks, dimensions, 1, batchSize);
+	std::size_t record = 0;
+	for(auto& batch: data.labels()){
+		for(std::size_t j = 0; j != batch.size1(); ++j, ++record){
+			batch(j,0) = labels[record];
+		}
 	}
-	maxIndex = std::max<std::size_t>(maxIndex,dimensions);
-	SHARK_RUNTIME_CHECK(dimensions == 0 || maxIndex <= dimensions, "Number of dimensions supplied is smaller than actual index data" );
+	return data;
+}
 
-	// check for feature index zero (non-standard, but it happens)
-	bool hasZero = false;
-	for (std::size_t i=0; i<numPoints; i++)
-	{
-		auto const& input = contents[i].second;
-		if (input.empty()) continue;
-		if (input[0].first == 0)
-		{
-			hasZero = true;
-			break;
-		}
+/// \brief Reads the remaining contents of the stream.
+std::string readStream(std::istream& stream){
+	std::ostringstream contents;
+	contents << stream.rdbuf();
+	return contents.str();
+}
+
+//streaming readers
+
+typedef std::shared_ptr<detail::RecordStream> RecordStreamPtr;
+
+/// \brief Parses the records of a block read from a RecordStream.
+///
+/// Feature indices must be in 1,...,highestIndex and are shifted to start at 0.
+inline void parseSparseRecords(std::string const& records, std::size_t highestIndex, std::vector<LibSVMPoint>& points){
+	char const* pos = records.c_str();
+	char const* recordsEnd = pos + records.size();
+	while(pos != recordsEnd){
+		char const* end = nextLine(pos, recordsEnd);
+		char const* recordBegin = pos;
+		char const* recordEnd = end;
+		pos = end;
+		if(!recordContent(recordBegin, recordEnd)) continue;
+		LibSVMPoint point;
+		parseSparseRecord(recordBegin, recordEnd, point.first, [&](std::size_t, std::size_t index, double value){
+			SHARK_RUNTIME_CHECK(index >= 1 && index <= highestIndex, "Feature index outside of 1,...,highestIndex");
+			point.second.push_back(std::make_pair(index - 1, value));
+		});
+		points.push_back(std::move(point));
 	}
+}
 
-	//copy contents into a new dataset
-	std::size_t vectorDim = maxIndex + (hasZero ? 1 : 0);
-	shark::LabeledData<T, blas::vector<typename T::value_type> > data(numPoints, {vectorDim, 1}, batchSize);
-	std::size_t batchStart = 0;
-	for(auto& batch: data.labels()){
-		//copy labels
-		for(std::size_t j = 0; j != batch.size1(); ++j){
-			batch(j,0) = contents[batchStart + j].first;
-		}
-		batchStart += batch.size1();
+inline void setSparseInputs(RealMatrix& inputs, std::vector<LibSVMPoint> const& points, std::size_t dimensions){
+	inputs = RealMatrix(points.size(), dimensions, 0.0);
+	for(std::size_t i = 0; i != points.size(); ++i){
+		for(auto const& feature: points[i].second)
+			inputs(i, feature.first) = feature.second;
 	}
-	copySparsePoints(data.inputs(),contents, hasZero);
-	return data;
+}
+
+inline void setSparseInputs(blas::compressed_matrix<double>& inputs, std::vector<LibSVMPoint> const& points, std::size_t dimensions){
+	std::size_t nnz = 0;
+	for(auto const& point: points)
+		nnz += point.second.size();
+	inputs = blas::compressed_matrix<double>(points.size(), dimensions, nnz);
+	for(std::size_t i = 0; i != points.size(); ++i){
+		auto const& features = points[i].second;
+		inputs.major_reserve(i, features.size());
+		auto pos = inputs.major_end(i);
+		for(auto const& feature: features)
+			pos = inputs.set_element(pos, feature.first, feature.second);
+	}
+}
+
+template<class InputType>
+void streamSparseClassification(
+	LabeledDataGenerator<InputType, unsigned int>& generator,
+	RecordStreamPtr const& stream,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	typedef typename Batch<InputLabelPair<InputType, unsigned int> >::type BatchType;
+	SHARK_RUNTIME_CHECK(highestIndex > 0, "The dimensionality of the inputs must be given");
+	//the labels are mapped like by importSparseData, which requires all labels of the file
+	ClassLabelMapping mapping;
+	stream->forEachRecord([&](std::string const& record){
+		char const* begin = record.data();
+		char const* end = begin + record.size();
+		recordContent(begin, end);
+		double label;
+		parseSparseLabel(begin, end, label);
+		mapping.add(label);
+	});
+	SHARK_RUNTIME_CHECK(mapping.numberOfClasses() <= numberOfClasses, "labels must be smaller than the number of classes");
+	auto nextBatch = [=]{
+		std::string records;
+		stream->read(batchSize, records);
+		std::vector<LibSVMPoint> points;
+		parseSparseRecords(records, highestIndex, points);
+		BatchType batch;
+		setSparseInputs(batch.input, points, highestIndex);
+		batch.label.resize(points.size());
+		for(std::size_t i = 0; i != points.size(); ++i){
+			batch.label(i) = mapping(points[i].first);
+		}
+		return batch;
+	};
+	generator = LabeledDataGenerator<InputType, unsigned int>(nextBatch, {highestIndex, numberOfClasses}, cacheSize);
+}
+
+template<class InputType>
+void streamSparseRegression(
+	LabeledDataGenerator<InputType, RealVector>& generator,
+	RecordStreamPtr const& stream,
+	std::size_t highestIndex,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	typedef typename Batch<InputLabelPair<InputType, RealVector> >::type BatchType;
+	SHARK_RUNTIME_CHECK(highestIndex > 0, "The dimensionality of the inputs must be given");
+	auto nextBatch = [=]{
+		std::string records;
+		stream->read(batchSize, records);
+		std::vector<LibSVMPoint> points;
+		parseSparseRecords(records, highestIndex, points);
+		BatchType batch;
+		setSparseInputs(batch.input, points, highestIndex);
+		batch.label.resize(points.size(), 1);
+		for(std::size_t i = 0; i != points.size(); ++i){
+			batch.label(i, 0) = points[i].first;
+		}
+		return batch;
+	};
+	generator = LabeledDataGenerator<InputType, RealVector>(nextBatch, {highestIndex, 1}, cacheSize);
 }
 
 }
@@ -239,7 +545,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_classification<RealVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_classification<RealVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -248,7 +554,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_regression<RealVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_regression<RealVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -257,7 +563,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_classification<CompressedRealVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_classification<CompressedRealVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -266,7 +572,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_regression<CompressedRealVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_regression<CompressedRealVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -275,9 +581,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_classification<RealVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_classification<RealVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -286,9 +591,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_regression<RealVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_regression<RealVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -297,9 +601,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_classification<CompressedRealVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_classification<CompressedRealVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -308,9 +611,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_regression<CompressedRealVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_regression<CompressedRealVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 //impl for float
@@ -320,7 +622,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_classification<FloatVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_classification<FloatVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -329,7 +631,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_regression<FloatVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_regression<FloatVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -338,7 +640,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_classification<CompressedFloatVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_classification<CompressedFloatVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -347,7 +649,7 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	dataset =  libsvm_importer_regression<CompressedFloatVector>(stream, highestIndex, batchSize);
+	dataset =  libsvm_importer_regression<CompressedFloatVector>(readStream(stream), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -356,9 +658,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_classification<FloatVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_classification<FloatVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -367,9 +668,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_regression<FloatVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_regression<FloatVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -378,9 +678,8 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_classification<CompressedFloatVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_classification<CompressedFloatVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
 }
 
 void shark::importSparseData(
@@ -389,7 +688,98 @@ void shark::importSparseData(
 	std::size_t highestIndex,
 	std::size_t batchSize
 ){
-	std::ifstream ifs(fn.c_str());
-	SHARK_RUNTIME_CHECK(ifs, "failed to open file for input");
-	dataset =  libsvm_importer_regression<CompressedFloatVector>(ifs, highestIndex, batchSize);
+	MappedFile file(fn);
+	dataset =  libsvm_importer_regression<CompressedFloatVector>(boost::string_ref(file.begin(), file.size()), highestIndex, batchSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(fn, 0));
+	streamSparseClassification(generator, records, highestIndex, numberOfClasses, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<RealVector, unsigned int>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(stream, 0));
+	streamSparseClassification(generator, records, highestIndex, numberOfClasses, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, unsigned int>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(fn, 0));
+	streamSparseClassification(generator, records, highestIndex, numberOfClasses, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, unsigned int>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t numberOfClasses,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(stream, 0));
+	streamSparseClassification(generator, records, highestIndex, numberOfClasses, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(fn, 0));
+	streamSparseRegression(generator, records, highestIndex, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<RealVector, RealVector>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(stream, 0));
+	streamSparseRegression(generator, records, highestIndex, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, RealVector>& generator,
+	std::string const& fn,
+	std::size_t highestIndex,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(fn, 0));
+	streamSparseRegression(generator, records, highestIndex, batchSize, cacheSize);
+}
+
+void shark::streamSparseData(
+	LabeledDataGenerator<CompressedRealVector, RealVector>& generator,
+	std::istream& stream,
+	std::size_t highestIndex,
+	std::size_t batchSize,
+	std::size_t cacheSize
+){
+	RecordStreamPtr records(new detail::RecordStream(stream, 0));
+	streamSparseRegression(generator, records, highestIndex, batchSize, cacheSize);
 }
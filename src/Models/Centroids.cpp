@@ -34,6 +34,8 @@
 #define SHARK_COMPILE_DLL
 #include <shark/Models/Clustering/Centroids.h>
 #include <shark/Data/DataView.h>
+#include <shark/Core/Threading/Algorithms.h>
+#include <limits>
 
 using namespace shark;
 
@@ -173,5 +175,45 @@ void Centroids::initFromData(const ClassificationDataset &data, std::size_t noCl
 }
 
 void Centroids::initFromData(Data<RealVector> const& dataset, std::size_t noClusters) {
-	setCentroids(toDataset(randomSubset(elements(dataset),noClusters)));
+	auto data = elements(dataset);
+	std::size_t n = data.size();
+	SIZE_CHECK(noClusters <= n);
+
+	//offsets of the batches for indexing the distances
+	std::vector<std::size_t> batchStart(dataset.size() + 1, 0);
+	for(std::size_t b = 0; b != dataset.size(); ++b)
+		batchStart[b + 1] = batchStart[b] + dataset[b].size1();
+
+	//k-means++: the first center is drawn uniformly, every further center is drawn
+	//with probability proportional to the squared distance to the closest center chosen so far
+	std::vector<RealVector> centers;
+	centers.reserve(noClusters);
+	RealVector minDistance(n, std::numeric_limits<double>::max());
+	std::size_t chosen = random::discrete(random::globalRng(), std::size_t(0), n - 1);
+	while(centers.size() != noClusters){
+		centers.push_back(data[chosen]);
+		RealVector const& center = centers.back();
+		auto updateDistances = [&](std::size_t b){
+			RealVector dist = distanceSqr(dataset[b], center);
+			for(std::size_t i = 0; i != dist.size(); ++i)
+				minDistance(batchStart[b] + i) = std::min(minDistance(batchStart[b] + i), dist(i));
+		};
+		threading::parallelND({dataset.size()}, {1}, updateDistances, threading::globalThreadPool());
+		if(centers.size() == noClusters) break;
+
+		double total = sum(minDistance);
+		if(total <= 0.0){
+			//all points coincide with a center, fall back to uniform sampling
+			chosen = random::discrete(random::globalRng(), std::size_t(0), n - 1);
+			continue;
+		}
+		double threshold = random::uni(random::globalRng(), 0.0, total);
+		chosen = n;
+		for(std::size_t i = 0; i != n && threshold >= 0.0; ++i){
+			if(minDistance(i) <= 0.0) continue;
+			chosen = i;
+			threshold -= minDistance(i);
+		}
+	}
+	setCentroids(createDataFromRange(centers));
 }